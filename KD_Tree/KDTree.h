@@ -0,0 +1,1545 @@
+#ifndef KDTREE_H
+#define KDTREE_H
+
+#include "KNNCandidates.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct Point {
+    double x, y, z;
+    int index;
+
+    // Calculate distance to another point
+    double distance(const Point& other) const {
+        return std::sqrt(distanceSquared(other));
+    }
+
+    // Squared distance, for comparisons that do not need the sqrt
+    double distanceSquared(const Point& other) const {
+        return (x - other.x) * (x - other.x) +
+            (y - other.y) * (y - other.y) +
+            (z - other.z) * (z - other.z);
+    }
+
+    double operator[](int axis) const {
+        return axis == 0 ? x : (axis == 1 ? y : z);
+    }
+};
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define KDTREE_SSE
+#include <immintrin.h>
+#if defined(__AVX__)
+#define KDTREE_AVX
+#endif
+#endif
+
+/**
+ * KD-tree over 3D points stored in flat arrays instead of heap nodes.
+ *
+ * Nodes are laid out in pre-order: an internal node splits its range at the median along the
+ * axis of widest extent, its left child is the next node and its right child is stored as an
+ * index. Ranges of at most leafSize points become leaf buckets; their coordinates are kept as
+ * separate x, y and z arrays (structure of arrays), so a query scores a whole bucket with one
+ * vectorized squared-distance pass instead of descending to single points. Smaller buckets
+ * prune more, larger ones spend less time walking nodes; `kdtree --bench` times the trade-off.
+ *
+ * Construction runs on several threads: large subtrees are built as separate tasks into
+ * their own node arrays and spliced into place, and the bounds, split and partition of the
+ * top levels are computed over chunks in parallel. Exact median selection at the top levels
+ * stays serial, so SplitRule::Binned, which splits at a histogram bin boundary near the
+ * median instead, is the one meant to scale with the core count; `kdtree --bench` prints
+ * the build speedup per thread count.
+ *
+ * Every node also keeps the bounding box of its points, and queries prune on box distance,
+ * so the tree stays correct when points move without re-partitioning: move() grows the boxes
+ * on one point's path and refit() recomputes them all. insert() appends to a short tail of
+ * slots that every query scans, remove() turns a slot into a NaN tombstone that no distance
+ * test accepts, and the tree rebuilds itself when either grows too large. Point::index must
+ * be unique to use these, and queries must not run concurrently with them.
+ */
+class KDTree {
+    friend class BruteForceKNN; // Share the candidate buffers and the batch threading
+    friend class UniformGrid;
+    friend class KNNGraph;
+    friend class TriangleBVH;
+    template <int Dim, typename Scalar>
+    friend class KDTreeND;
+
+    // Traversal stack entry: a node and the squared distance from the target to its box
+    struct Entry {
+        std::int32_t node;
+        double bound;
+    };
+    // Every split leaves at least a quarter of the range on each side, so depth stays
+    // below log(n) / log(4/3) + 1 (75 for 2^31 points)
+    static constexpr int MAX_DEPTH = 128;
+
+public:
+    static constexpr int DEFAULT_LEAF_SIZE = 16;
+    static constexpr int MAX_LEAF_SIZE = 64;
+    static constexpr int MAX_K = 32; // Largest k of the allocation-free query
+
+    using Neighbor = knn::Neighbor<double>;
+
+    // Neighbour lists of many queries in compressed sparse row form: query i's neighbours are
+    // neighbors[offsets[i]] up to neighbors[offsets[i + 1]], nearest first.
+    struct RadiusResult {
+        std::vector<std::size_t> offsets; // Query count + 1 entries
+        std::vector<Neighbor> neighbors;
+    };
+
+    // Bounds the work of an approximate query. With epsilon > 0 a subtree is skipped once no
+    // point in it can be more than (1 + epsilon) times closer than the current k-th best, so
+    // every returned distance is within that factor of the true one; maxLeaves > 0 stops the
+    // search after that many leaves, which bounds the time but not the error.
+    struct SearchBudget {
+        double epsilon = 0;
+        int maxLeaves = 0; // 0: no limit
+    };
+
+    struct ApproximateResult {
+        int count;  // Neighbours written
+        bool exact; // Nothing was skipped that an exact query would have visited
+    };
+
+    // Scratch space of the allocation-free findKNearest: the sorted candidate buffer and the
+    // traversal stack. Keep one per thread and reuse it for every query.
+    class QueryContext {
+        friend class KDTree;
+        Neighbor best_[MAX_K]; // Nearest first; index holds the slot until the query returns
+        Entry stack_[MAX_DEPTH];
+    };
+
+    enum class SplitRule {
+        Median, // Exact median of the widest axis (std::nth_element)
+        Binned  // Boundary of a 64-bin histogram closest to the median; falls back to Median
+                // when no boundary leaves a quarter of the points on each side
+    };
+
+    struct BuildOptions {
+        int leafSize = DEFAULT_LEAF_SIZE; // Clamped to [1, MAX_LEAF_SIZE]
+        SplitRule split = SplitRule::Median;
+        unsigned threads = 0;             // 0: std::thread::hardware_concurrency()
+    };
+
+    // Ranges smaller than this are built on the thread that reaches them
+    static constexpr std::size_t PARALLEL_BUILD_MIN = 1 << 14;
+
+    // Inserted points beyond which the tail is folded into the tree by a rebuild
+    static constexpr std::size_t MAX_PENDING = 1024;
+
+    // leafSize is clamped to [1, MAX_LEAF_SIZE]
+    explicit KDTree(const std::vector<Point>& points, int leafSize = DEFAULT_LEAF_SIZE)
+        : KDTree(points, BuildOptions{ leafSize }) {
+    }
+
+    KDTree(const std::vector<Point>& points, const BuildOptions& options)
+        : leafSize_(std::min(std::max(options.leafSize, 1), MAX_LEAF_SIZE)), splitRule_(options.split) {
+        unsigned hw = std::thread::hardware_concurrency();
+        threads_ = options.threads ? options.threads : (hw ? hw : 1);
+        build(points);
+    }
+
+    // Order in which a batch runs its queries; results always come back in input order
+    enum class QueryOrder {
+        Input,  // As given
+        Morton  // Along a Z-order curve through the queries' bounding box, so consecutive
+                // queries descend the same subtrees while they are still in cache. Pays for
+                // its sort when the input order is spatially incoherent, as in scanned meshes.
+    };
+
+    // Queries per thread below which findKNearestBatch stays on the calling thread
+    static constexpr std::size_t BATCH_CHUNK = 256;
+
+    // Joins the threads that batch queries share; the next batch starts them again. A plugin
+    // calls this before it is unloaded, since threads cannot be joined once the library's
+    // static destructors run. No batch may be running.
+    static void stopThreadPool() { ThreadPool::instance().stop(); }
+
+    // Indices (Point::index) of the k nearest points, nearest first
+    std::vector<int> findKNearest(const Point& target, int k) const {
+        std::vector<int> indices;
+        if (k <= MAX_K) {
+            QueryContext context;
+            Neighbor found[MAX_K];
+            int count = findKNearest(target, k, context, found);
+            for (int i = 0; i < count; ++i) {
+                indices.push_back(found[i].index);
+            }
+            return indices;
+        }
+
+        std::vector<Candidate> heap;
+        searchHeap(target, static_cast<std::size_t>(k), heap);
+        for (const Candidate& c : heap) {
+            indices.push_back(data().indices[c.second]);
+        }
+        return indices;
+    }
+
+    // Writes the k nearest points (k clamped to [0, MAX_K]) to out, nearest first, with their
+    // squared distances, and returns how many were written. Candidates are kept in a sorted
+    // insertion buffer in context, so the query neither allocates nor takes a square root.
+    int findKNearest(const Point& target, int k, QueryContext& context, Neighbor* out) const {
+        SortedCandidates best{ context.best_, std::min(std::max(k, 0), MAX_K), 0, std::numeric_limits<double>::infinity() };
+        if (best.k > 0) {
+            search(target, context.stack_, best);
+        }
+        const int* indices = data().indices;
+        for (int i = 0; i < best.count; ++i) {
+            out[i] = { indices[best.items[i].index], best.items[i].distanceSquared };
+        }
+        return best.count;
+    }
+
+    // findKNearest within a SearchBudget, for previews that can trade accuracy for time. The
+    // result says whether the neighbours are the exact ones, which they still are whenever
+    // the budget did not cut anything the exact search would have looked at.
+    ApproximateResult findKNearest(const Point& target, int k, const SearchBudget& budget, QueryContext& context, Neighbor* out) const {
+        SortedCandidates best{ context.best_, std::min(std::max(k, 0), MAX_K), 0, std::numeric_limits<double>::infinity() };
+        BudgetPruning pruning(budget);
+        if (best.k > 0) {
+            search(target, context.stack_, best, pruning);
+        }
+        const int* indices = data().indices;
+        for (int i = 0; i < best.count; ++i) {
+            out[i] = { indices[best.items[i].index], best.items[i].distanceSquared };
+        }
+        return { best.count, pruning.exact };
+    }
+
+    // k nearest points of each of the n queries, split across threads. Row i of the n x k
+    // outputs holds query i's neighbours nearest first: outIndices gets Point::index and
+    // outDistances (optional, may be null) the distance. Rows of a tree with fewer than k
+    // points are padded with -1 and infinity. Nothing is allocated per query.
+    void findKNearestBatch(const Point* queries, std::size_t n, int k, int* outIndices, double* outDistances,
+        QueryOrder order = QueryOrder::Input) const {
+        batchKNearest(queries, n, k, outIndices, outDistances, nullptr, order);
+    }
+
+    // findKNearestBatch within a SearchBudget per query; returns how many of the n rows may
+    // not be exact
+    std::size_t findKNearestBatch(const Point* queries, std::size_t n, int k, const SearchBudget& budget, int* outIndices,
+        double* outDistances, QueryOrder order = QueryOrder::Input) const {
+        return batchKNearest(queries, n, k, outIndices, outDistances, &budget, order);
+    }
+
+    // Points within radius of target (distance <= radius), nearest first. With maxCount > 0
+    // only the maxCount nearest of them are kept, and a cap of at most MAX_K also tightens
+    // the pruning as the buffer fills. out is cleared first and its capacity reused; returns
+    // the number of neighbours found.
+    std::size_t findWithinRadius(const Point& target, double radius, std::vector<Neighbor>& out, int maxCount = 0) const {
+        Entry stack[MAX_DEPTH];
+        return radiusSearch(target, radius, maxCount, stack, out);
+    }
+
+    // Number of points within radius of target, without storing them
+    std::size_t countWithinRadius(const Point& target, double radius) const {
+        CountCandidates counter{ 0, radiusLimit(radius) };
+        if (radius >= 0) {
+            Entry stack[MAX_DEPTH];
+            search(target, stack, counter);
+        }
+        return counter.count;
+    }
+
+    // findWithinRadius for each of the n queries, split across threads, gathered into out
+    void findWithinRadiusBatch(const Point* queries, std::size_t n, double radius, RadiusResult& out, int maxCount = 0,
+        QueryOrder order = QueryOrder::Input) const {
+        std::vector<std::uint32_t> sorted;
+        const std::uint32_t* runOrder = queryOrder(queries, n, order, sorted);
+        radiusRows(n, runOrder, out, [&](std::size_t i, std::vector<Neighbor>& found) {
+            Entry stack[MAX_DEPTH];
+            return radiusSearch(queries[i], radius, maxCount, stack, found);
+        });
+    }
+
+    // Adds a point to the tail scanned by every query; the tree is rebuilt to take the tail
+    // in once it holds more than MAX_PENDING points or more points than the tree itself.
+    // Returns false, leaving the tree unchanged, if a point with this Point::index is already
+    // there; move() relocates that one.
+    bool insert(const Point& p) {
+        detach();
+        ensureSlotMap();
+        if (!slotOf_.emplace(p.index, indices_.size()).second) {
+            return false;
+        }
+        xs_.push_back(p.x);
+        ys_.push_back(p.y);
+        zs_.push_back(p.z);
+        indices_.push_back(p.index);
+        const std::size_t pending = indices_.size() - treeSlots_;
+        if (pending > std::max<std::size_t>(MAX_LEAF_SIZE, std::min(MAX_PENDING, treeSlots_ - dead_))) {
+            rebalance();
+        }
+        return true;
+    }
+
+    // Removes the point with this Point::index; returns false if there is none. A tree slot
+    // only becomes a tombstone, and the tree is rebuilt once a quarter of its slots are dead.
+    bool remove(int index) {
+        detach();
+        ensureSlotMap();
+        auto it = slotOf_.find(index);
+        if (it == slotOf_.end()) {
+            return false;
+        }
+        const std::size_t slot = it->second;
+        slotOf_.erase(it);
+        if (slot >= treeSlots_) {
+            // Inserted tail: move the last point into the hole
+            const std::size_t last = indices_.size() - 1;
+            if (slot != last) {
+                xs_[slot] = xs_[last];
+                ys_[slot] = ys_[last];
+                zs_[slot] = zs_[last];
+                indices_[slot] = indices_[last];
+                slotOf_[indices_[slot]] = slot;
+            }
+            xs_.pop_back();
+            ys_.pop_back();
+            zs_.pop_back();
+            indices_.pop_back();
+            return true;
+        }
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        xs_[slot] = ys_[slot] = zs_[slot] = nan;
+        if (4 * ++dead_ > treeSlots_) {
+            rebalance();
+        }
+        return true;
+    }
+
+    // Moves the point with this Point::index without re-partitioning, growing the boxes on
+    // its path to cover the new position; returns false if there is no such point. Boxes only
+    // grow here, so call refit() after many moves to tighten them again.
+    bool move(int index, double x, double y, double z) {
+        detach();
+        ensureSlotMap();
+        auto it = slotOf_.find(index);
+        if (it == slotOf_.end()) {
+            return false;
+        }
+        const std::size_t slot = it->second;
+        xs_[slot] = x;
+        ys_[slot] = y;
+        zs_[slot] = z;
+        if (slot < treeSlots_) {
+            growPath(slot, x, y, z);
+        }
+        return true;
+    }
+
+    // Recomputes every box, bottom-up, from the current positions; the partition is kept
+    void refit() {
+        detach();
+        // Pre-order puts children after their parent, so a reverse sweep sees them first
+        for (std::size_t i = nodes_.size(); i-- > 0;) {
+            Node& node = nodes_[i];
+            Bounds bounds = Bounds::empty();
+            if (node.count > 0) {
+                for (std::size_t slot = node.right; slot < static_cast<std::size_t>(node.right) + node.count; ++slot) {
+                    bounds.include(xs_[slot], ys_[slot], zs_[slot]);
+                }
+            }
+            else {
+                bounds = nodes_[i + 1].bounds.bounds();
+                bounds.include(nodes_[node.right].bounds.bounds());
+            }
+            node.bounds = Box::from(bounds);
+        }
+    }
+
+    // Moves every listed point (matched by Point::index) and refits once; returns how many
+    // of them were found
+    std::size_t refit(const std::vector<Point>& moved) {
+        detach();
+        ensureSlotMap();
+        std::size_t found = 0;
+        for (const Point& p : moved) {
+            auto it = slotOf_.find(p.index);
+            if (it != slotOf_.end()) {
+                xs_[it->second] = p.x;
+                ys_[it->second] = p.y;
+                zs_[it->second] = p.z;
+                ++found;
+            }
+        }
+        refit();
+        return found;
+    }
+
+    // Rebuilds from the live points, taking in the inserted tail and dropping tombstones
+    void rebalance() {
+        detach();
+        std::vector<Point> live;
+        live.reserve(size());
+        for (std::size_t slot = 0; slot < indices_.size(); ++slot) {
+            if (!isDead(slot)) {
+                live.push_back({ xs_[slot], ys_[slot], zs_[slot], indices_[slot] });
+            }
+        }
+        build(live);
+    }
+
+    static constexpr std::uint32_t FILE_VERSION = 1;
+
+    // Writes the tree as a checksummed header followed by its node, coordinate and index
+    // arrays, each aligned to 64 bytes, in this machine's byte order and struct layout, so that
+    // fromImage() can query the bytes where they lie. Inserted and removed points are folded in
+    // first, on a copy. Returns false if the stream fails.
+    bool save(std::ostream& out) const {
+        if (data().slotCount != treeSlots_ || dead_ > 0) {
+            KDTree folded(*this);
+            folded.rebalance();
+            return folded.save(out);
+        }
+        const Data d = data();
+        FileHeader header = {};
+        std::memcpy(header.magic, fileMagic(), sizeof(header.magic));
+        header.version = FILE_VERSION;
+        header.byteOrder = BYTE_ORDER_MARK;
+        header.nodeSize = sizeof(Node);
+        header.leafSize = static_cast<std::uint32_t>(leafSize_);
+        header.splitRule = static_cast<std::uint32_t>(splitRule_);
+        header.nodeCount = d.nodeCount;
+        header.slotCount = d.slotCount;
+
+        struct Section {
+            const void* bytes;
+            std::uint64_t size;
+            std::uint64_t* offset;
+        };
+        const Section sections[] = {
+            { d.nodes, d.nodeCount * sizeof(Node), &header.nodesOffset },
+            { d.xs, d.slotCount * sizeof(double), &header.xsOffset },
+            { d.ys, d.slotCount * sizeof(double), &header.ysOffset },
+            { d.zs, d.slotCount * sizeof(double), &header.zsOffset },
+            { d.indices, d.slotCount * sizeof(int), &header.indicesOffset },
+        };
+        std::uint64_t at = sizeof(FileHeader);
+        std::uint64_t payload = FNV_OFFSET;
+        for (const Section& section : sections) {
+            at = (at + FILE_ALIGNMENT - 1) / FILE_ALIGNMENT * FILE_ALIGNMENT;
+            *section.offset = at;
+            at += section.size;
+            payload = fnv1a(section.bytes, section.size, payload);
+        }
+        header.fileSize = at;
+        header.payloadChecksum = payload;
+        header.headerChecksum = fnv1a(&header, offsetof(FileHeader, headerChecksum), FNV_OFFSET);
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        std::uint64_t written = sizeof(header);
+        const char zeros[FILE_ALIGNMENT] = {};
+        for (const Section& section : sections) {
+            out.write(zeros, static_cast<std::streamsize>(*section.offset - written));
+            out.write(static_cast<const char*>(section.bytes), static_cast<std::streamsize>(section.size));
+            written = *section.offset + section.size;
+        }
+        return static_cast<bool>(out);
+    }
+
+    // Tree that answers queries straight from a saved image, without copying or parsing it;
+    // owner keeps the bytes alive (KDTreeFile.h maps a file for this; pass null if they outlive
+    // the tree anyway). The header and the node links are always validated, so queries stay
+    // in bounds; the coordinates and indices are trusted unless verifyPayload checksums every
+    // array too, at the cost of touching every page. Editing the tree
+    // copies the image into memory first. Returns null, with the reason in error, if the image
+    // is damaged or was written by another version or platform.
+    static std::unique_ptr<KDTree> fromImage(std::shared_ptr<const void> owner, const void* bytes, std::size_t size,
+        std::string* error = nullptr, bool verifyPayload = false) {
+        auto fail = [error](const char* reason) {
+            if (error) {
+                *error = reason;
+            }
+            return std::unique_ptr<KDTree>();
+        };
+        if (size < sizeof(FileHeader) || reinterpret_cast<std::uintptr_t>(bytes) % alignof(double) != 0) {
+            return fail("image is too small or misaligned");
+        }
+        const char* base = static_cast<const char*>(bytes);
+        const FileHeader& header = *reinterpret_cast<const FileHeader*>(base);
+        if (std::memcmp(header.magic, fileMagic(), sizeof(header.magic)) != 0) {
+            return fail("not a KD-tree image");
+        }
+        if (header.headerChecksum != fnv1a(&header, offsetof(FileHeader, headerChecksum), FNV_OFFSET)) {
+            return fail("header checksum mismatch");
+        }
+        if (header.version != FILE_VERSION) {
+            return fail("unsupported KD-tree image version");
+        }
+        if (header.byteOrder != BYTE_ORDER_MARK || header.nodeSize != sizeof(Node)) {
+            return fail("image was written on an incompatible platform");
+        }
+        const std::uint64_t sectionEnds[] = {
+            header.nodesOffset + header.nodeCount * sizeof(Node),
+            header.xsOffset + header.slotCount * sizeof(double),
+            header.ysOffset + header.slotCount * sizeof(double),
+            header.zsOffset + header.slotCount * sizeof(double),
+            header.indicesOffset + header.slotCount * sizeof(int),
+        };
+        const std::uint64_t offsets[] = { header.nodesOffset, header.xsOffset, header.ysOffset, header.zsOffset, header.indicesOffset };
+        bool inside = header.fileSize <= size && header.slotCount <= static_cast<std::uint64_t>(std::numeric_limits<std::int32_t>::max()) &&
+            header.leafSize >= 1 && header.leafSize <= MAX_LEAF_SIZE;
+        for (int i = 0; i < 5; ++i) {
+            inside = inside && offsets[i] % FILE_ALIGNMENT == 0 && offsets[i] >= sizeof(FileHeader) &&
+                sectionEnds[i] >= offsets[i] && sectionEnds[i] <= header.fileSize;
+        }
+        if (!inside) {
+            return fail("image sections are out of bounds");
+        }
+
+        std::unique_ptr<KDTree> tree(new KDTree());
+        tree->leafSize_ = static_cast<int>(header.leafSize);
+        tree->splitRule_ = header.splitRule == static_cast<std::uint32_t>(SplitRule::Binned) ? SplitRule::Binned : SplitRule::Median;
+        tree->treeSlots_ = static_cast<std::size_t>(header.slotCount);
+        tree->mapped_ = {
+            reinterpret_cast<const Node*>(base + header.nodesOffset), static_cast<std::size_t>(header.nodeCount),
+            reinterpret_cast<const double*>(base + header.xsOffset),
+            reinterpret_cast<const double*>(base + header.ysOffset),
+            reinterpret_cast<const double*>(base + header.zsOffset),
+            reinterpret_cast<const int*>(base + header.indicesOffset), static_cast<std::size_t>(header.slotCount)
+        };
+        if (!validNodes(tree->mapped_, header.leafSize)) {
+            return fail("image nodes are out of bounds");
+        }
+        if (verifyPayload) {
+            const Data& d = tree->mapped_;
+            std::uint64_t payload = FNV_OFFSET;
+            payload = fnv1a(d.nodes, d.nodeCount * sizeof(Node), payload);
+            payload = fnv1a(d.xs, d.slotCount * sizeof(double), payload);
+            payload = fnv1a(d.ys, d.slotCount * sizeof(double), payload);
+            payload = fnv1a(d.zs, d.slotCount * sizeof(double), payload);
+            payload = fnv1a(d.indices, d.slotCount * sizeof(int), payload);
+            if (payload != header.payloadChecksum) {
+                return fail("payload checksum mismatch");
+            }
+        }
+        tree->image_ = owner ? std::move(owner) : std::shared_ptr<const void>(bytes, [](const void*) {});
+        return tree;
+    }
+
+    // True while queries read a mapped image rather than arrays owned by the tree
+    bool isMapped() const { return image_ != nullptr; }
+
+    std::size_t size() const { return data().slotCount - dead_; }
+    bool empty() const { return size() == 0; }
+    int leafSize() const { return leafSize_; }
+
+    // Positions 0..n-1 of the points sorted along a Z-order (Morton) curve: coordinates are
+    // quantized to 10 bits per axis over the points' bounding box, interleaved into 30-bit
+    // codes and sorted by a three-pass radix sort, so ties keep their input order.
+    static void mortonOrder(const Point* points, std::size_t n, std::vector<std::uint32_t>& order) {
+        double lo[3] = { 0, 0, 0 }, scale[3] = { 0, 0, 0 };
+        if (n > 0) {
+            double hi[3];
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::numeric_limits<double>::infinity();
+                hi[a] = -lo[a];
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                for (int a = 0; a < 3; ++a) {
+                    lo[a] = std::min(lo[a], points[i][a]);
+                    hi[a] = std::max(hi[a], points[i][a]);
+                }
+            }
+            for (int a = 0; a < 3; ++a) {
+                scale[a] = hi[a] > lo[a] ? 1024.0 / (hi[a] - lo[a]) : 0.0;
+            }
+        }
+        // Spreads the low 10 bits of v to every third bit
+        auto spread = [](std::uint64_t v) {
+            v = (v | (v << 16)) & 0x030000FFull;
+            v = (v | (v << 8)) & 0x0300F00Full;
+            v = (v | (v << 4)) & 0x030C30C3ull;
+            v = (v | (v << 2)) & 0x09249249ull;
+            return v;
+        };
+        // Code in the high half, position in the low half
+        std::vector<std::uint64_t> keys(n), scratch(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            std::uint64_t code = 0;
+            for (int a = 0; a < 3; ++a) {
+                double cell = (points[i][a] - lo[a]) * scale[a];
+                cell = cell >= 0 ? std::min(cell, 1023.0) : 0.0; // Also sends NaN to cell 0
+                code |= spread(static_cast<std::uint64_t>(cell)) << a;
+            }
+            keys[i] = code << 32 | i;
+        }
+        for (int shift = 32; shift < 62; shift += 10) {
+            std::size_t start[1025] = {};
+            for (std::uint64_t key : keys) {
+                ++start[((key >> shift) & 1023) + 1];
+            }
+            for (int b = 0; b < 1024; ++b) {
+                start[b + 1] += start[b];
+            }
+            for (std::uint64_t key : keys) {
+                scratch[start[(key >> shift) & 1023]++] = key;
+            }
+            keys.swap(scratch);
+        }
+        order.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            order[i] = static_cast<std::uint32_t>(keys[i]);
+        }
+    }
+
+    // Run order of a batch: null for input order, else the Morton order, kept in sorted.
+    // Batches too large for 32-bit positions run in input order.
+    static const std::uint32_t* queryOrder(const Point* queries, std::size_t n, QueryOrder order, std::vector<std::uint32_t>& sorted) {
+        if (order != QueryOrder::Morton || n < 2 || n > std::numeric_limits<std::uint32_t>::max()) {
+            return nullptr;
+        }
+        mortonOrder(queries, n, sorted);
+        return sorted.data();
+    }
+
+    // Squared distances from (qx, qy, qz) to the n points at xs, ys, zs, written to out
+    static void squaredDistances(const double* xs, const double* ys, const double* zs, std::size_t n,
+        double qx, double qy, double qz, double* out) {
+        std::size_t i = 0;
+#if defined(KDTREE_AVX)
+        const __m256d px = _mm256_set1_pd(qx), py = _mm256_set1_pd(qy), pz = _mm256_set1_pd(qz);
+        for (; i + 4 <= n; i += 4) {
+            __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), px);
+            __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), py);
+            __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(zs + i), pz);
+            __m256d d2 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)), _mm256_mul_pd(dz, dz));
+            _mm256_storeu_pd(out + i, d2);
+        }
+#endif
+#if defined(KDTREE_SSE)
+        const __m128d sx = _mm_set1_pd(qx), sy = _mm_set1_pd(qy), sz = _mm_set1_pd(qz);
+        for (; i + 2 <= n; i += 2) {
+            __m128d dx = _mm_sub_pd(_mm_loadu_pd(xs + i), sx);
+            __m128d dy = _mm_sub_pd(_mm_loadu_pd(ys + i), sy);
+            __m128d dz = _mm_sub_pd(_mm_loadu_pd(zs + i), sz);
+            __m128d d2 = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+            _mm_storeu_pd(out + i, d2);
+        }
+#endif
+        for (; i < n; ++i) {
+            double dx = xs[i] - qx, dy = ys[i] - qy, dz = zs[i] - qz;
+            out[i] = dx * dx + dy * dy + dz * dz;
+        }
+    }
+
+private:
+    struct Bounds {
+        double minV[3];
+        double maxV[3];
+
+        // Inverted box that any include() replaces; its distance from every point is infinite
+        static Bounds empty() {
+            const double inf = std::numeric_limits<double>::infinity();
+            return { { inf, inf, inf }, { -inf, -inf, -inf } };
+        }
+
+        // NaN coordinates (tombstones) leave the box unchanged
+        void include(double x, double y, double z) {
+            const double p[3] = { x, y, z };
+            for (int a = 0; a < 3; ++a) {
+                minV[a] = std::min(minV[a], p[a]);
+                maxV[a] = std::max(maxV[a], p[a]);
+            }
+        }
+
+        void include(const Bounds& other) {
+            for (int a = 0; a < 3; ++a) {
+                minV[a] = std::min(minV[a], other.minV[a]);
+                maxV[a] = std::max(maxV[a], other.maxV[a]);
+            }
+        }
+
+        int widestAxis() const {
+            double extent[3] = { maxV[0] - minV[0], maxV[1] - minV[1], maxV[2] - minV[2] };
+            return extent[0] >= extent[1] ? (extent[0] >= extent[2] ? 0 : 2) : (extent[1] >= extent[2] ? 1 : 2);
+        }
+    };
+
+    // Bounds stored in single precision, rounded outwards so the box still contains every point
+    struct Box {
+        float minV[3];
+        float maxV[3];
+
+        static Box from(const Bounds& b) {
+            Box box;
+            for (int a = 0; a < 3; ++a) {
+                box.minV[a] = static_cast<float>(b.minV[a]);
+                box.maxV[a] = static_cast<float>(b.maxV[a]);
+                if (box.minV[a] > b.minV[a]) {
+                    box.minV[a] = std::nextafter(box.minV[a], -std::numeric_limits<float>::infinity());
+                }
+                if (box.maxV[a] < b.maxV[a]) {
+                    box.maxV[a] = std::nextafter(box.maxV[a], std::numeric_limits<float>::infinity());
+                }
+            }
+            return box;
+        }
+
+        Bounds bounds() const {
+            return { { minV[0], minV[1], minV[2] }, { maxV[0], maxV[1], maxV[2] } };
+        }
+
+        double distanceSquared(const double q[3]) const {
+            double d2 = 0.0;
+            for (int a = 0; a < 3; ++a) {
+                double d = std::max(std::max(minV[a] - q[a], q[a] - maxV[a]), 0.0);
+                d2 += d * d;
+            }
+            return d2;
+        }
+    };
+
+    struct Node {
+        Box bounds;           // Box around the subtree's points
+        std::int32_t right;   // Internal: right child (the left child is the next node); leaf: first slot
+        std::uint16_t count;  // Leaf: points in the bucket; 0 for internal nodes
+    };
+
+    static const char* fileMagic() { return "KDTREE3D"; } // First 8 bytes of an image
+    static constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr std::uint64_t FILE_ALIGNMENT = 64;
+    static constexpr std::uint64_t FNV_OFFSET = 14695981039346656037ull;
+
+    // Start of a saved image; every field is naturally aligned, so the layout has no padding
+    struct FileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;       // BYTE_ORDER_MARK as the writer stored it
+        std::uint32_t nodeSize;        // sizeof(Node) of the writer
+        std::uint32_t leafSize;
+        std::uint32_t splitRule;
+        std::uint32_t reserved;
+        std::uint64_t nodeCount;
+        std::uint64_t slotCount;
+        std::uint64_t nodesOffset;     // Byte offsets of the arrays from the start of the image
+        std::uint64_t xsOffset;
+        std::uint64_t ysOffset;
+        std::uint64_t zsOffset;
+        std::uint64_t indicesOffset;
+        std::uint64_t fileSize;
+        std::uint64_t payloadChecksum; // FNV-1a over the five arrays, in order
+        std::uint64_t headerChecksum;  // FNV-1a over every header byte before this field
+    };
+
+    static std::uint64_t fnv1a(const void* bytes, std::size_t size, std::uint64_t hash) {
+        const unsigned char* p = static_cast<const unsigned char*>(bytes);
+        for (std::size_t i = 0; i < size; ++i) {
+            hash = (hash ^ p[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    // Empty shell for fromImage()
+    KDTree() : leafSize_(DEFAULT_LEAF_SIZE), splitRule_(SplitRule::Median), threads_(std::max(std::thread::hardware_concurrency(), 1u)) {
+    }
+
+    int leafSize_;
+    SplitRule splitRule_;
+    unsigned threads_;
+    std::vector<Node> nodes_;
+    std::vector<double> xs_, ys_, zs_; // Coordinates, one slot per point: the tree's buckets, then the inserted tail
+    std::vector<int> indices_;         // Point::index of each slot
+    std::size_t treeSlots_ = 0;        // Slots covered by the tree; the rest are the inserted tail
+    std::size_t dead_ = 0;             // Tombstoned tree slots
+    std::unordered_map<int, std::size_t> slotOf_; // Point::index to slot, built on the first edit
+    bool slotMapBuilt_ = false;
+
+    // What queries read: the arrays above, or the sections of a mapped file image
+    struct Data {
+        const Node* nodes;
+        std::size_t nodeCount;
+        const double* xs;
+        const double* ys;
+        const double* zs;
+        const int* indices;
+        std::size_t slotCount;
+    };
+    std::shared_ptr<const void> image_; // Keeps a mapped image alive; null when the arrays own the data
+    Data mapped_ = {};
+
+    Data data() const {
+        if (image_) {
+            return mapped_;
+        }
+        return { nodes_.data(), nodes_.size(), xs_.data(), ys_.data(), zs_.data(), indices_.data(), indices_.size() };
+    }
+
+    // Whether the nodes form a tree the queries can walk: in preorder, each internal node's
+    // left child follows it and its right child starts inside its range, no deeper than the
+    // query stacks reach, and the leaves, at most leafSize points each, cover the slots in
+    // order. O(nodeCount), and reads no coordinates.
+    static bool validNodes(const Data& d, std::uint32_t leafSize) {
+        if (d.nodeCount == 0) {
+            return d.slotCount == 0;
+        }
+        struct Range {
+            std::size_t node, end;
+            int depth;
+        };
+        std::vector<Range> stack{ { 0, d.nodeCount, 0 } };
+        std::size_t nextSlot = 0;
+        while (!stack.empty()) {
+            const Range r = stack.back();
+            stack.pop_back();
+            const Node& node = d.nodes[r.node];
+            if (node.count > 0) {
+                if (r.end != r.node + 1 || node.count > leafSize || node.right < 0 ||
+                    static_cast<std::size_t>(node.right) != nextSlot || d.slotCount - nextSlot < node.count) {
+                    return false;
+                }
+                nextSlot += node.count;
+                continue;
+            }
+            if (r.depth + 2 > MAX_DEPTH || node.right <= 0 || static_cast<std::size_t>(node.right) <= r.node + 1 ||
+                static_cast<std::size_t>(node.right) >= r.end) {
+                return false;
+            }
+            // Left pushed last so the leaves are met in slot order
+            stack.push_back({ static_cast<std::size_t>(node.right), r.end, r.depth + 1 });
+            stack.push_back({ r.node + 1, static_cast<std::size_t>(node.right), r.depth + 1 });
+        }
+        return nextSlot == d.slotCount;
+    }
+
+    // Copies a mapped image into the arrays so the tree can be edited
+    void detach() {
+        if (!image_) {
+            return;
+        }
+        const Data d = mapped_;
+        nodes_.assign(d.nodes, d.nodes + d.nodeCount);
+        xs_.assign(d.xs, d.xs + d.slotCount);
+        ys_.assign(d.ys, d.ys + d.slotCount);
+        zs_.assign(d.zs, d.zs + d.slotCount);
+        indices_.assign(d.indices, d.indices + d.slotCount);
+        image_.reset();
+        mapped_ = {};
+    }
+
+    bool isDead(std::size_t slot) const { return xs_[slot] != xs_[slot]; }
+
+    void ensureSlotMap() {
+        if (slotMapBuilt_) {
+            return;
+        }
+        slotOf_.clear();
+        slotOf_.reserve(size());
+        for (std::size_t slot = 0; slot < indices_.size(); ++slot) {
+            if (!isDead(slot)) {
+                slotOf_[indices_[slot]] = slot;
+            }
+        }
+        slotMapBuilt_ = true;
+    }
+
+    // Grows the boxes from the root down to the leaf holding slot
+    void growPath(std::size_t slot, double x, double y, double z) {
+        std::int32_t node = 0;
+        while (true) {
+            Bounds grown = nodes_[node].bounds.bounds();
+            grown.include(x, y, z);
+            nodes_[node].bounds = Box::from(grown);
+            if (nodes_[node].count > 0) {
+                return;
+            }
+            // The right subtree's slots start at its leftmost leaf
+            std::int32_t leftmost = nodes_[node].right;
+            while (nodes_[leftmost].count == 0) {
+                ++leftmost;
+            }
+            node = slot < static_cast<std::size_t>(nodes_[leftmost].right) ? node + 1 : nodes_[node].right;
+        }
+    }
+
+    static constexpr int BINS = 64;
+
+    // Points being partitioned, plus a same-sized buffer for the parallel partition
+    struct BuildState {
+        Point* pts;
+        Point* tmp;
+    };
+
+    void build(const std::vector<Point>& points) {
+        const unsigned threads = threads_;
+        const std::size_t n = points.size();
+        treeSlots_ = n;
+        dead_ = 0;
+        slotOf_.clear();
+        slotMapBuilt_ = false;
+        xs_.resize(n);
+        ys_.resize(n);
+        zs_.resize(n);
+        indices_.resize(n);
+        nodes_.clear();
+        nodes_.reserve(8 * n / leafSize_ + 1); // Buckets are at least a quarter full
+        std::vector<Point> scratch(points); // Partitioned in place while building
+        std::vector<Point> tmp(threads > 1 && n >= PARALLEL_BUILD_MIN ? n : 0);
+        if (n > 0) {
+            buildRange(nodes_, { scratch.data(), tmp.data() }, 0, n, threads);
+        }
+    }
+
+    // Runs fn(chunk, begin, end) over `chunks` contiguous pieces of [0, count), one per thread
+    template <typename Fn>
+    static void forEachChunk(std::size_t count, unsigned chunks, Fn&& fn) {
+        std::size_t size = (count + chunks - 1) / chunks;
+        std::vector<std::thread> threads;
+        for (unsigned c = 1; c < chunks; ++c) {
+            std::size_t begin = std::min(count, c * size);
+            threads.emplace_back([&fn, c, begin, size, count]() { fn(c, begin, std::min(count, begin + size)); });
+        }
+        fn(0u, std::size_t(0), std::min(count, size));
+        for (std::thread& t : threads) {
+            t.join();
+        }
+    }
+
+    static Bounds rangeBounds(const Point* pts, std::size_t lo, std::size_t hi, unsigned workers) {
+        std::vector<Bounds> partial(workers, Bounds{ { pts[lo].x, pts[lo].y, pts[lo].z }, { pts[lo].x, pts[lo].y, pts[lo].z } });
+        forEachChunk(hi - lo, workers, [&](unsigned c, std::size_t begin, std::size_t end) {
+            Bounds& b = partial[c];
+            for (std::size_t i = lo + begin; i < lo + end; ++i) {
+                for (int a = 0; a < 3; ++a) {
+                    b.minV[a] = std::min(b.minV[a], pts[i][a]);
+                    b.maxV[a] = std::max(b.maxV[a], pts[i][a]);
+                }
+            }
+        });
+        Bounds b = partial[0];
+        for (const Bounds& p : partial) {
+            for (int a = 0; a < 3; ++a) {
+                b.minV[a] = std::min(b.minV[a], p.minV[a]);
+                b.maxV[a] = std::max(b.maxV[a], p.maxV[a]);
+            }
+        }
+        return b;
+    }
+
+    // Histogram split of pts[lo, hi) along axis. On success partitions the range so points
+    // <= split come first and returns the first point of the right side; returns lo when no
+    // bin boundary leaves a quarter of the points on each side.
+    static std::size_t binnedSplit(const BuildState& state, std::size_t lo, std::size_t hi, unsigned workers,
+        int axis, const Bounds& bounds, double& split) {
+        const double minV = bounds.minV[axis];
+        const double extent = bounds.maxV[axis] - minV;
+        if (!(extent > 0)) {
+            return lo;
+        }
+        const double scale = BINS / extent;
+        struct Histogram {
+            std::size_t count[BINS] = {};
+            double maxV[BINS];
+        };
+        std::vector<Histogram> partial(workers);
+        forEachChunk(hi - lo, workers, [&](unsigned c, std::size_t begin, std::size_t end) {
+            Histogram& h = partial[c];
+            std::fill(h.maxV, h.maxV + BINS, minV);
+            for (std::size_t i = lo + begin; i < lo + end; ++i) {
+                double v = state.pts[i][axis];
+                int bin = std::min(BINS - 1, static_cast<int>((v - minV) * scale));
+                ++h.count[bin];
+                h.maxV[bin] = std::max(h.maxV[bin], v);
+            }
+        });
+
+        // Bins are monotonic in the coordinate, so every point of bins <= b is <= the largest
+        // coordinate seen in them and every point of later bins is larger
+        const std::size_t m = hi - lo;
+        std::size_t leftCount = 0, bestLeft = 0;
+        double leftMax = minV;
+        for (int b = 0; b < BINS - 1; ++b) {
+            for (const Histogram& h : partial) {
+                leftCount += h.count[b];
+                leftMax = std::max(leftMax, h.maxV[b]);
+            }
+            bool balanced = 4 * leftCount >= m && 4 * (m - leftCount) >= m;
+            std::size_t distance = leftCount > m / 2 ? leftCount - m / 2 : m / 2 - leftCount;
+            std::size_t bestDistance = bestLeft > m / 2 ? bestLeft - m / 2 : m / 2 - bestLeft;
+            if (balanced && (bestLeft == 0 || distance < bestDistance)) {
+                bestLeft = leftCount;
+                split = leftMax;
+            }
+        }
+        if (bestLeft == 0) {
+            return lo;
+        }
+
+        auto isLeft = [axis, split](const Point& p) { return p[axis] <= split; };
+        if (workers <= 1 || state.tmp == nullptr) {
+            std::partition(state.pts + lo, state.pts + hi, isLeft);
+            return lo + bestLeft;
+        }
+        // Each chunk partitions itself in place, then the left and right parts of all chunks
+        // are gathered through tmp
+        std::vector<std::size_t> chunkLeft(workers), chunkBegin(workers), chunkEnd(workers);
+        forEachChunk(m, workers, [&](unsigned c, std::size_t begin, std::size_t end) {
+            chunkBegin[c] = lo + begin;
+            chunkEnd[c] = lo + end;
+            chunkLeft[c] = static_cast<std::size_t>(
+                std::partition(state.pts + lo + begin, state.pts + lo + end, isLeft) - (state.pts + lo + begin));
+        });
+        std::vector<std::size_t> leftAt(workers), rightAt(workers);
+        std::size_t nextLeft = lo, nextRight = lo + bestLeft;
+        for (unsigned c = 0; c < workers; ++c) {
+            leftAt[c] = nextLeft;
+            rightAt[c] = nextRight;
+            nextLeft += chunkLeft[c];
+            nextRight += chunkEnd[c] - chunkBegin[c] - chunkLeft[c];
+        }
+        forEachChunk(workers, workers, [&](unsigned c, std::size_t, std::size_t) {
+            const Point* first = state.pts + chunkBegin[c];
+            std::copy(first, first + chunkLeft[c], state.tmp + leftAt[c]);
+            std::copy(first + chunkLeft[c], first + (chunkEnd[c] - chunkBegin[c]), state.tmp + rightAt[c]);
+        });
+        forEachChunk(m, workers, [&](unsigned, std::size_t begin, std::size_t end) {
+            std::copy(state.tmp + lo + begin, state.tmp + lo + end, state.pts + lo + begin);
+        });
+        return lo + bestLeft;
+    }
+
+    // Chooses the split of pts[lo, hi), partitions the range around it and returns the first
+    // point of the right side; bounds receives the box of the whole range.
+    std::size_t splitRange(const BuildState& state, std::size_t lo, std::size_t hi, unsigned workers,
+        Bounds& bounds) const {
+        bounds = rangeBounds(state.pts, lo, hi, workers);
+        const int axis = bounds.widestAxis();
+        double split;
+        if (splitRule_ == SplitRule::Binned) {
+            std::size_t mid = binnedSplit(state, lo, hi, workers, axis, bounds, split);
+            if (mid != lo) {
+                return mid;
+            }
+        }
+        std::size_t mid = lo + (hi - lo) / 2;
+        std::nth_element(state.pts + lo, state.pts + mid, state.pts + hi,
+            [axis](const Point& p, const Point& q) { return p[axis] < q[axis]; });
+        return mid;
+    }
+
+    // Appends the subtree over pts[lo, hi) to nodes in pre-order; slots follow the partitioned
+    // order of pts, so every bucket is a contiguous run of the SoA arrays. Ranges of at least
+    // PARALLEL_BUILD_MIN points split their workers between the two children: the right one
+    // is built on a new thread into its own array, whose node indices are rebased on splicing.
+    void buildRange(std::vector<Node>& nodes, const BuildState& state, std::size_t lo, std::size_t hi, unsigned workers) {
+        const std::size_t at = nodes.size();
+        nodes.push_back({});
+
+        if (hi - lo <= static_cast<std::size_t>(leafSize_)) {
+            Bounds bounds = Bounds::empty();
+            for (std::size_t i = lo; i < hi; ++i) {
+                xs_[i] = state.pts[i].x;
+                ys_[i] = state.pts[i].y;
+                zs_[i] = state.pts[i].z;
+                indices_[i] = state.pts[i].index;
+                bounds.include(xs_[i], ys_[i], zs_[i]);
+            }
+            nodes[at].bounds = Box::from(bounds);
+            nodes[at].right = static_cast<std::int32_t>(lo);
+            nodes[at].count = static_cast<std::uint16_t>(hi - lo);
+            return;
+        }
+
+        const bool parallel = workers > 1 && hi - lo >= PARALLEL_BUILD_MIN;
+        Bounds bounds;
+        std::size_t mid = splitRange(state, lo, hi, parallel ? workers : 1, bounds);
+        nodes[at].bounds = Box::from(bounds);
+        nodes[at].count = 0;
+
+        if (!parallel) {
+            buildRange(nodes, state, lo, mid, 1);
+            nodes[at].right = static_cast<std::int32_t>(nodes.size());
+            buildRange(nodes, state, mid, hi, 1);
+            return;
+        }
+
+        unsigned leftWorkers = static_cast<unsigned>((workers * (mid - lo) + (hi - lo) / 2) / (hi - lo));
+        leftWorkers = std::min(std::max(leftWorkers, 1u), workers - 1);
+        std::vector<Node> rightNodes;
+        std::thread right([&]() { buildRange(rightNodes, state, mid, hi, workers - leftWorkers); });
+        buildRange(nodes, state, lo, mid, leftWorkers);
+        right.join();
+
+        const std::int32_t offset = static_cast<std::int32_t>(nodes.size());
+        nodes[at].right = offset;
+        for (Node node : rightNodes) {
+            if (node.count == 0) {
+                node.right += offset; // Leaves keep their slot
+            }
+            nodes.push_back(node);
+        }
+    }
+
+    using Candidate = knn::Candidate<double>; // Squared distance, slot
+
+    // Threads that parallelFor hands its chunks to, started on first use and kept, so a batch
+    // of queries costs a wake-up rather than creating and joining threads. The caller works
+    // through its own chunks too, so nested and concurrent calls always make progress.
+    class ThreadPool {
+    public:
+        static ThreadPool& instance() {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        // Runs call(context, c) for every c in [0, chunks) and returns when all have finished
+        void run(std::size_t chunks, void (*call)(void*, std::size_t), void* context) {
+            Job job{ call, context, chunks, 0, chunks };
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (workers_.empty()) {
+                start();
+            }
+            jobs_.push_back(&job);
+            wake_.notify_all();
+            work(lock, job);
+            done_.wait(lock, [&job]() { return job.pending == 0; });
+        }
+
+        void stop() {
+            std::vector<std::thread> workers;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+                workers.swap(workers_);
+            }
+            wake_.notify_all();
+            for (std::thread& t : workers) {
+                t.join();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = false;
+        }
+
+    private:
+        struct Job {
+            void (*call)(void*, std::size_t);
+            void* context;
+            std::size_t chunks;
+            std::size_t next;    // First unclaimed chunk
+            std::size_t pending; // Chunks not finished yet
+        };
+
+        std::mutex mutex_;
+        std::condition_variable wake_; // A job was queued, or the workers are stopping
+        std::condition_variable done_; // A job finished its last chunk
+        std::vector<Job*> jobs_;       // Jobs with unclaimed chunks, oldest first
+        std::vector<std::thread> workers_;
+        bool stopping_ = false;
+
+        ThreadPool() = default;
+        ~ThreadPool() { stop(); }
+
+        // One worker per hardware thread besides the caller's; called with the lock held
+        void start() {
+            const unsigned hw = std::thread::hardware_concurrency();
+            for (unsigned t = 1; t < hw; ++t) {
+                workers_.emplace_back([this]() { loop(); });
+            }
+        }
+
+        // Runs chunks of job until none is left to claim. Called, and returns, with the lock
+        // held; the job leaves the queue with its last claim, and the caller cannot return
+        // before the thread finishing its last chunk lets go of the lock.
+        void work(std::unique_lock<std::mutex>& lock, Job& job) {
+            while (job.next < job.chunks) {
+                const std::size_t c = job.next++;
+                if (job.next == job.chunks) {
+                    jobs_.erase(std::find(jobs_.begin(), jobs_.end(), &job));
+                }
+                lock.unlock();
+                job.call(job.context, c);
+                lock.lock();
+                if (--job.pending == 0) {
+                    done_.notify_all();
+                }
+            }
+        }
+
+        void loop() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (true) {
+                wake_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+                if (stopping_) {
+                    return;
+                }
+                work(lock, *jobs_.front());
+            }
+        }
+    };
+
+    // Splits [0, count) into contiguous chunks and runs fn(begin, end) on each, one chunk
+    // per hardware thread, on the shared ThreadPool; below 2 * minChunk the call runs inline.
+    template <typename Fn>
+    static void parallelFor(std::size_t count, std::size_t minChunk, Fn&& fn) {
+        unsigned int hw = std::thread::hardware_concurrency();
+        std::size_t workers = std::min<std::size_t>(hw ? hw : 1, count / std::max<std::size_t>(minChunk, 1));
+        if (workers <= 1) {
+            fn(std::size_t(0), count);
+            return;
+        }
+
+        struct Chunks {
+            Fn& fn;
+            std::size_t count, size;
+        } chunks{ fn, count, (count + workers - 1) / workers };
+        const std::size_t n = (count + chunks.size - 1) / chunks.size;
+        ThreadPool::instance().run(n, [](void* context, std::size_t c) {
+            Chunks& chunks = *static_cast<Chunks*>(context);
+            const std::size_t begin = c * chunks.size;
+            chunks.fn(begin, std::min(chunks.count, begin + chunks.size));
+        }, &chunks);
+    }
+
+    // The batch and radius plumbing below is shared with UniformGrid, BruteForceKNN and
+    // KDTreeND, which differ from this tree only in how a single query is searched.
+
+    // Row of a kNN batch output that a query fills nearest first
+    template <typename Scalar>
+    struct BatchRow {
+        int* indices;
+        Scalar* distances; // Optional; gets the distance, not its square
+
+        void set(std::size_t j, int index, Scalar d2) const {
+            indices[j] = index;
+            if (distances) {
+                distances[j] = std::sqrt(d2);
+            }
+        }
+
+        // Neighbours that already carry Point::index
+        template <typename NeighborT>
+        std::size_t take(const NeighborT* found, int count) const {
+            for (int j = 0; j < count; ++j) {
+                set(static_cast<std::size_t>(j), found[j].index, found[j].distanceSquared);
+            }
+            return static_cast<std::size_t>(count);
+        }
+
+        // Sorted heap of slots, mapped to Point::index through slotIndices
+        template <typename CandidateT>
+        std::size_t take(const std::vector<CandidateT>& heap, const int* slotIndices) const {
+            for (std::size_t j = 0; j < heap.size(); ++j) {
+                set(j, slotIndices[heap[j].second], heap[j].first);
+            }
+            return heap.size();
+        }
+    };
+
+    // Fills the n x k rows of a kNN batch, queries split across threads and run in runOrder
+    // (null: input order). Each chunk calls makeSearcher() once, so per-thread scratch lives
+    // in the searcher, and searcher(i, row) fills query i's row and returns the neighbours
+    // it wrote; the rest of the row is padded with -1 and infinity.
+    template <typename Scalar, typename MakeSearcher>
+    static void kNearestRows(std::size_t n, int k, const std::uint32_t* runOrder, int* outIndices, Scalar* outDistances,
+        MakeSearcher&& makeSearcher) {
+        if (k <= 0) {
+            return;
+        }
+        const std::size_t kk = static_cast<std::size_t>(k);
+        parallelFor(n, BATCH_CHUNK, [&](std::size_t begin, std::size_t end) {
+            auto searcher = makeSearcher();
+            for (std::size_t r = begin; r < end; ++r) {
+                const std::size_t i = runOrder ? runOrder[r] : r;
+                const BatchRow<Scalar> row{ outIndices + i * kk, outDistances ? outDistances + i * kk : nullptr };
+                for (std::size_t j = searcher(i, row); j < kk; ++j) {
+                    row.set(j, -1, std::numeric_limits<Scalar>::infinity());
+                }
+            }
+        });
+    }
+
+    // Squared-distance limit that accepts exactly the points with distance <= radius
+    template <typename Scalar>
+    static Scalar radiusLimit(Scalar radius) {
+        return std::nextafter(radius * radius, std::numeric_limits<Scalar>::infinity());
+    }
+
+    // Radius query on top of search(candidates): out gets the points with distance <= radius,
+    // nearest first, the maxCount nearest of them if maxCount > 0, with slots mapped to
+    // Point::index through slotIndices. Up to MAX_K of them go through the Sorted buffer, whose
+    // bound also tightens the search; otherwise All collects every point and they are sorted.
+    template <typename Sorted, typename All, typename NeighborT, typename Scalar, typename Search>
+    static std::size_t radiusNeighbors(Scalar radius, int maxCount, const int* slotIndices, std::vector<NeighborT>& out,
+        Search&& search) {
+        out.clear();
+        if (!(radius >= 0)) {
+            return 0;
+        }
+        if (maxCount > 0 && maxCount <= MAX_K) {
+            out.resize(static_cast<std::size_t>(maxCount));
+            Sorted best{ out.data(), maxCount, 0, radiusLimit(radius) };
+            search(best);
+            out.resize(static_cast<std::size_t>(best.count));
+        }
+        else {
+            All all{ out, radiusLimit(radius) };
+            search(all);
+            auto nearer = [](const NeighborT& a, const NeighborT& b) { return a.distanceSquared < b.distanceSquared; };
+            if (maxCount > 0 && out.size() > static_cast<std::size_t>(maxCount)) {
+                std::partial_sort(out.begin(), out.begin() + maxCount, out.end(), nearer);
+                out.resize(static_cast<std::size_t>(maxCount));
+            }
+            else {
+                std::sort(out.begin(), out.end(), nearer);
+            }
+        }
+        for (NeighborT& neighbor : out) {
+            neighbor.index = slotIndices[neighbor.index];
+        }
+        return out.size();
+    }
+
+    // Gathers a radius batch into out, queries split across threads and run in runOrder (null:
+    // input order); search(i, found) fills found with query i's neighbours and returns their
+    // count. Each chunk collects its queries' neighbours contiguously, in run order; the chunks
+    // are scattered into place once every count, and so every offset, is known.
+    template <typename Search>
+    static void radiusRows(std::size_t n, const std::uint32_t* runOrder, RadiusResult& out, Search&& search) {
+        struct Chunk {
+            std::size_t begin, end;
+            std::vector<Neighbor> neighbors;
+        };
+        std::vector<Chunk> chunks;
+        std::mutex chunksMutex;
+        out.offsets.assign(n + 1, 0);
+
+        parallelFor(n, BATCH_CHUNK, [&](std::size_t begin, std::size_t end) {
+            Chunk chunk{ begin, end, {} };
+            std::vector<Neighbor> found;
+            for (std::size_t r = begin; r < end; ++r) {
+                const std::size_t i = runOrder ? runOrder[r] : r;
+                out.offsets[i + 1] = search(i, found);
+                chunk.neighbors.insert(chunk.neighbors.end(), found.begin(), found.end());
+            }
+            std::lock_guard<std::mutex> lock(chunksMutex);
+            chunks.push_back(std::move(chunk));
+        });
+
+        for (std::size_t i = 0; i < n; ++i) {
+            out.offsets[i + 1] += out.offsets[i];
+        }
+        out.neighbors.resize(out.offsets[n]);
+        parallelFor(chunks.size(), 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t c = begin; c < end; ++c) {
+                const Chunk& chunk = chunks[c];
+                if (!runOrder) {
+                    std::copy(chunk.neighbors.begin(), chunk.neighbors.end(),
+                        out.neighbors.begin() + static_cast<std::ptrdiff_t>(out.offsets[chunk.begin]));
+                    continue;
+                }
+                auto from = chunk.neighbors.begin();
+                for (std::size_t r = chunk.begin; r < chunk.end; ++r) {
+                    const std::size_t i = runOrder[r];
+                    const std::ptrdiff_t count = static_cast<std::ptrdiff_t>(out.offsets[i + 1] - out.offsets[i]);
+                    std::copy(from, from + count, out.neighbors.begin() + static_cast<std::ptrdiff_t>(out.offsets[i]));
+                    from += count;
+                }
+            }
+        });
+    }
+
+    // Pruning of an exact query: a subtree is skipped only if it cannot beat the k-th best
+    struct ExactPruning {
+        double limit(double bound) const { return bound; }
+        void skipped(double, double) {}
+        bool visitLeaf() { return true; }
+    };
+
+    // Pruning of a SearchBudget query, which remembers whether it skipped anything that the
+    // exact query would have visited
+    struct BudgetPruning {
+        double scale;   // 1 / (1 + epsilon)^2, applied to the squared bound
+        int leavesLeft; // Negative: no limit
+        bool exact = true;
+
+        explicit BudgetPruning(const SearchBudget& budget)
+            : scale(1.0 / ((1.0 + std::max(budget.epsilon, 0.0)) * (1.0 + std::max(budget.epsilon, 0.0)))),
+              leavesLeft(budget.maxLeaves > 0 ? budget.maxLeaves : -1) {
+        }
+
+        double limit(double bound) const { return bound * scale; }
+
+        // A box at squared distance d2 was skipped against the unscaled bound
+        void skipped(double d2, double bound) {
+            if (d2 < bound) {
+                exact = false;
+            }
+        }
+
+        bool visitLeaf() {
+            if (leavesLeft == 0) {
+                exact = false;
+                return false;
+            }
+            if (leavesLeft > 0) {
+                --leavesLeft;
+            }
+            return true;
+        }
+    };
+
+    // Exact without a budget; returns the number of rows that may not be exact. Queries run
+    // in the given order and write their rows in place.
+    std::size_t batchKNearest(const Point* queries, std::size_t n, int k, int* outIndices, double* outDistances,
+        const SearchBudget* budget, QueryOrder order) const {
+        if (k <= 0) {
+            return 0;
+        }
+        std::vector<std::uint32_t> sorted;
+        const std::uint32_t* runOrder = queryOrder(queries, n, order, sorted);
+        std::atomic<std::size_t> inexact(0);
+        kNearestRows(n, k, runOrder, outIndices, outDistances, [&]() {
+            return [&, context = QueryContext(), found = std::array<Neighbor, MAX_K>(),
+                       heap = std::vector<Candidate>()](std::size_t i, const BatchRow<double>& row) mutable {
+                if (k <= MAX_K) {
+                    ApproximateResult result = { 0, true };
+                    if (budget) {
+                        result = findKNearest(queries[i], k, *budget, context, found.data());
+                    }
+                    else {
+                        result.count = findKNearest(queries[i], k, context, found.data());
+                    }
+                    if (!result.exact) {
+                        inexact.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    return row.take(found.data(), result.count);
+                }
+                const std::size_t kk = static_cast<std::size_t>(k);
+                if (budget) {
+                    BudgetPruning pruning(*budget);
+                    searchHeap(queries[i], kk, heap, pruning);
+                    if (!pruning.exact) {
+                        inexact.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                else {
+                    searchHeap(queries[i], kk, heap);
+                }
+                return row.take(heap, data().indices);
+            };
+        });
+        return inexact;
+    }
+
+    using SortedCandidates = knn::SortedCandidates<double>;
+    using HeapCandidates = knn::HeapCandidates<double>;
+    using AllCandidates = knn::AllCandidates<double>;
+    using CountCandidates = knn::CountCandidates<double>;
+
+    std::size_t radiusSearch(const Point& target, double radius, int maxCount, Entry* stack, std::vector<Neighbor>& out) const {
+        return radiusNeighbors<SortedCandidates, AllCandidates>(radius, maxCount, data().indices, out,
+            [&](auto& candidates) { search(target, stack, candidates); });
+    }
+
+    // heap is cleared first and left sorted nearest first
+    void searchHeap(const Point& target, std::size_t k, std::vector<Candidate>& heap) const {
+        ExactPruning pruning;
+        searchHeap(target, k, heap, pruning);
+    }
+
+    template <typename Pruning>
+    void searchHeap(const Point& target, std::size_t k, std::vector<Candidate>& heap, Pruning& pruning) const {
+        heap.clear();
+        if (k == 0) {
+            return;
+        }
+        Entry stack[MAX_DEPTH];
+        HeapCandidates best{ heap, k };
+        search(target, stack, best, pruning);
+        std::sort_heap(heap.begin(), heap.end());
+    }
+
+    // Scores count slots from first and offers every point that beats the current bound
+    template <typename Candidates>
+    static void scanSlots(const Data& d, std::size_t first, std::size_t count, const double q[3], double* d2, Candidates& best) {
+        squaredDistances(d.xs + first, d.ys + first, d.zs + first, count, q[0], q[1], q[2], d2);
+        for (std::size_t i = 0; i < count; ++i) {
+            if (d2[i] < best.bound()) {
+                best.insert(d2[i], static_cast<int>(first + i));
+            }
+        }
+    }
+
+    // Scans the inserted tail, then walks the tree depth-first; each stack entry carries the
+    // squared distance from the target to the node's box, so whole subtrees are skipped once
+    // best holds k points closer than that (scaled down by an approximate query's pruning).
+    template <typename Candidates>
+    void search(const Point& target, Entry* stack, Candidates& best) const {
+        ExactPruning pruning;
+        search(target, stack, best, pruning);
+    }
+
+    template <typename Candidates, typename Pruning>
+    void search(const Point& target, Entry* stack, Candidates& best, Pruning& pruning) const {
+        const double q[3] = { target.x, target.y, target.z };
+        double d2[MAX_LEAF_SIZE];
+        const Data d = data();
+        for (std::size_t first = treeSlots_; first < d.slotCount; first += MAX_LEAF_SIZE) {
+            scanSlots(d, first, std::min<std::size_t>(d.slotCount - first, MAX_LEAF_SIZE), q, d2, best);
+        }
+        if (d.nodeCount == 0) {
+            return;
+        }
+        const Node* nodes = d.nodes;
+
+        int top = 0;
+        stack[top++] = { 0, nodes[0].bounds.distanceSquared(q) };
+        while (top > 0) {
+            Entry e = stack[--top];
+            if (e.bound >= pruning.limit(best.bound())) {
+                pruning.skipped(e.bound, best.bound());
+                continue;
+            }
+            const Node& node = nodes[e.node];
+            if (node.count > 0) {
+                if (!pruning.visitLeaf()) {
+                    return;
+                }
+                scanSlots(d, static_cast<std::size_t>(node.right), node.count, q, d2, best);
+                continue;
+            }
+
+            Entry near = { e.node + 1, nodes[e.node + 1].bounds.distanceSquared(q) };
+            Entry far = { node.right, nodes[node.right].bounds.distanceSquared(q) };
+            if (far.bound < near.bound) {
+                std::swap(near, far);
+            }
+            // Farther child first so the nearer one is popped, and tightens the bound, first
+            const double limit = pruning.limit(best.bound());
+            if (far.bound < limit) {
+                stack[top++] = far;
+            }
+            else {
+                pruning.skipped(far.bound, best.bound());
+            }
+            if (near.bound < limit) {
+                stack[top++] = near;
+            }
+            else {
+                pruning.skipped(near.bound, best.bound());
+            }
+        }
+    }
+};
+
+#endif // KDTREE_H
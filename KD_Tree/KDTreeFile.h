@@ -0,0 +1,110 @@
+#ifndef KDTREE_FILE_H
+#define KDTREE_FILE_H
+
+#include "KDTree.h"
+
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Read-only mapping of a whole file. Pages are read on first touch, so opening a large file
+ * costs nothing until its contents are used. data() is null if the file could not be mapped.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return;
+        }
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                data_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                size_ = data_ ? static_cast<std::size_t>(size.QuadPart) : 0;
+                CloseHandle(mapping); // The view keeps the mapping alive
+            }
+        }
+        CloseHandle(file);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED) {
+                data_ = mapped;
+                size_ = static_cast<std::size_t>(info.st_size);
+            }
+        }
+        ::close(fd); // The mapping keeps the file alive
+#endif
+    }
+
+    ~MappedFile() {
+        if (!data_) {
+            return;
+        }
+#if defined(_WIN32)
+        UnmapViewOfFile(data_);
+#else
+        ::munmap(data_, size_);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+// Writes tree to path in the mappable format of KDTree::save; returns false on I/O failure
+inline bool saveKDTree(const KDTree& tree, const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    return out && tree.save(out) && out.flush();
+}
+
+// Maps a file written by saveKDTree and queries it in place: loading validates the header and
+// nothing else, so the arrays are paged in by the queries that touch them. Returns null, with
+// the reason in error, if the file is missing or fails validation.
+inline std::unique_ptr<KDTree> loadKDTree(const std::string& path, std::string* error = nullptr, bool verifyPayload = false) {
+    auto file = std::make_shared<MappedFile>(path);
+    if (!file->data()) {
+        if (error) {
+            *error = "cannot map " + path;
+        }
+        return nullptr;
+    }
+    const void* bytes = file->data();
+    std::size_t size = file->size();
+    return KDTree::fromImage(std::move(file), bytes, size, error, verifyPayload);
+}
+
+#endif // KDTREE_FILE_H
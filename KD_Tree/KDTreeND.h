@@ -0,0 +1,328 @@
+#ifndef KDTREE_ND_H
+#define KDTREE_ND_H
+
+#include "KDTree.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Point of a Dim-dimensional space: a quaternion (Dim 4), a stack of joint rotations, ...
+template <int Dim, typename Scalar = double>
+struct PointND {
+    Scalar coords[Dim];
+    int index;
+
+    Scalar operator[](int axis) const { return coords[axis]; }
+
+    Scalar distanceSquared(const PointND& other) const {
+        Scalar d2 = 0;
+        for (int a = 0; a < Dim; ++a) {
+            d2 += (coords[a] - other.coords[a]) * (coords[a] - other.coords[a]);
+        }
+        return d2;
+    }
+
+    Scalar distance(const PointND& other) const {
+        return std::sqrt(distanceSquared(other));
+    }
+};
+
+/**
+ * KD-tree over points of a fixed dimension and scalar type, for neighbour search in pose
+ * space: rotations as quaternions, multi-joint poses as 6 to 12 stacked coordinates. It keeps
+ * the layout of KDTree, with pre-order nodes that carry the box of their points and leaf
+ * buckets stored as one coordinate array per axis. Dim and Scalar are template parameters, so
+ * every point-to-point and point-to-box distance is a sum unrolled at compile time, and the
+ * bucket kernel is a loop over slots that the compiler vectorizes. Scalar float halves the
+ * memory of large sets; distances are then computed in float too.
+ *
+ * Splits are at the median of the widest axis and the build runs on one thread. Pose sets
+ * hold thousands of samples, not millions of vertices. Mesh binding stays on KDTree, whose
+ * 3D kernel, single-precision boxes, file images and editing this tree does not have.
+ *
+ * Distances are Euclidean. q and -q are the same rotation, so store quaternions on one
+ * hemisphere (w >= 0) and query with both q and -q when the target may lie on either.
+ */
+template <int Dim, typename Scalar = double>
+class KDTreeND {
+    static_assert(Dim >= 1 && Dim <= 64, "KDTreeND supports 1 to 64 dimensions");
+    static_assert(std::is_floating_point<Scalar>::value, "KDTreeND needs a floating-point scalar");
+    static_assert(KDTree::MAX_LEAF_SIZE % 4 == 0, "bucket kernel scores blocks of 4 slots");
+
+    // Traversal stack entry: a node and the squared distance from the target to its box
+    struct Entry {
+        std::int32_t node;
+        Scalar bound;
+    };
+    // Median splits halve every range, so depth stays below log2(n) + 1
+    static constexpr int MAX_DEPTH = 64;
+
+public:
+    using Point = PointND<Dim, Scalar>;
+
+    static constexpr int DIMENSION = Dim;
+    static constexpr int DEFAULT_LEAF_SIZE = KDTree::DEFAULT_LEAF_SIZE;
+    static constexpr int MAX_LEAF_SIZE = KDTree::MAX_LEAF_SIZE;
+    static constexpr int MAX_K = KDTree::MAX_K;
+
+    using Neighbor = knn::Neighbor<Scalar>;
+
+    // Scratch space of the allocation-free findKNearest; keep one per thread and reuse it
+    class QueryContext {
+        friend class KDTreeND;
+        Neighbor best_[MAX_K]; // Nearest first; index holds the slot until the query returns
+        Entry stack_[MAX_DEPTH];
+    };
+
+    // leafSize is clamped to [1, MAX_LEAF_SIZE]
+    explicit KDTreeND(const std::vector<Point>& points, int leafSize = DEFAULT_LEAF_SIZE)
+        : leafSize_(std::min(std::max(leafSize, 1), MAX_LEAF_SIZE)) {
+        build(points);
+    }
+
+    // Indices (Point::index) of the k nearest points, nearest first
+    std::vector<int> findKNearest(const Point& target, int k) const {
+        std::vector<int> indices;
+        if (k <= MAX_K) {
+            QueryContext context;
+            Neighbor found[MAX_K];
+            int count = findKNearest(target, k, context, found);
+            for (int i = 0; i < count; ++i) {
+                indices.push_back(found[i].index);
+            }
+            return indices;
+        }
+
+        std::vector<Candidate> heap;
+        searchHeap(target, static_cast<std::size_t>(k), heap);
+        for (const Candidate& c : heap) {
+            indices.push_back(indices_[c.second]);
+        }
+        return indices;
+    }
+
+    // Writes the k nearest points (k clamped to [0, MAX_K]) to out, nearest first, with their
+    // squared distances, and returns how many were written; nothing is allocated
+    int findKNearest(const Point& target, int k, QueryContext& context, Neighbor* out) const {
+        SortedCandidates best{ context.best_, std::min(std::max(k, 0), MAX_K), 0, std::numeric_limits<Scalar>::infinity() };
+        if (best.k > 0) {
+            search(target, context.stack_, best);
+        }
+        for (int i = 0; i < best.count; ++i) {
+            out[i] = { indices_[best.items[i].index], best.items[i].distanceSquared };
+        }
+        return best.count;
+    }
+
+    // k nearest points of each of the n queries, split across threads, as n x k rows like
+    // KDTree::findKNearestBatch: outIndices gets Point::index and outDistances (optional) the
+    // distance, and rows of a tree with fewer than k points are padded with -1 and infinity
+    void findKNearestBatch(const Point* queries, std::size_t n, int k, int* outIndices, Scalar* outDistances) const {
+        KDTree::kNearestRows(n, k, nullptr, outIndices, outDistances, [&]() {
+            return [&, context = QueryContext(), found = std::array<Neighbor, MAX_K>(),
+                       heap = std::vector<Candidate>()](std::size_t i, const KDTree::BatchRow<Scalar>& row) mutable {
+                if (k <= MAX_K) {
+                    return row.take(found.data(), findKNearest(queries[i], k, context, found.data()));
+                }
+                searchHeap(queries[i], static_cast<std::size_t>(k), heap);
+                return row.take(heap, indices_.data());
+            };
+        });
+    }
+
+    // Points within radius of target (distance <= radius), nearest first; with maxCount > 0
+    // only the maxCount nearest are kept. out is cleared first; returns the number found.
+    std::size_t findWithinRadius(const Point& target, Scalar radius, std::vector<Neighbor>& out, int maxCount = 0) const {
+        Entry stack[MAX_DEPTH];
+        return KDTree::radiusNeighbors<SortedCandidates, AllCandidates>(radius, maxCount, indices_.data(), out,
+            [&](auto& candidates) { search(target, stack, candidates); });
+    }
+
+    // Number of points within radius of target, without storing them
+    std::size_t countWithinRadius(const Point& target, Scalar radius) const {
+        CountCandidates counter{ 0, KDTree::radiusLimit(radius) };
+        if (radius >= 0) {
+            Entry stack[MAX_DEPTH];
+            search(target, stack, counter);
+        }
+        return counter.count;
+    }
+
+    std::size_t size() const { return indices_.size(); }
+    bool empty() const { return indices_.empty(); }
+    int leafSize() const { return leafSize_; }
+
+private:
+    using Axes = std::make_index_sequence<Dim>;
+    using Candidate = knn::Candidate<Scalar>; // Squared distance, slot
+
+    struct Node {
+        Scalar minV[Dim];    // Box around the subtree's points
+        Scalar maxV[Dim];
+        std::int32_t right;  // Internal: right child (the left child is the next node); leaf: first slot
+        std::uint16_t count; // Leaf: points in the bucket; 0 for internal nodes
+    };
+
+    std::vector<Node> nodes_;
+    // Slots scored together by the bucket kernel; MAX_LEAF_SIZE is a multiple of it
+    static constexpr std::size_t LANES = 4;
+
+    std::vector<Scalar> coords_; // Axis-major: coordinate a of slot i is coords_[a * stride_ + i]
+    std::vector<int> indices_;   // Point::index of each slot
+    std::size_t stride_ = 0;     // size() plus LANES of padding, so a block never reads past its axis
+    int leafSize_;
+
+    static Scalar square(Scalar v) { return v * v; }
+
+    template <std::size_t... A>
+    static Scalar boxDistanceSquared(const Node& node, const Scalar* q, std::index_sequence<A...>) {
+        return (Scalar(0) + ... + square(std::max(std::max(node.minV[A] - q[A], q[A] - node.maxV[A]), Scalar(0))));
+    }
+
+    template <std::size_t... A>
+    static Scalar slotDistanceSquared(const Scalar* c, std::size_t stride, const Scalar* q, std::index_sequence<A...>) {
+        return (Scalar(0) + ... + square(c[A * stride] - q[A]));
+    }
+
+    // Squared distances from q to LANES consecutive slots at c. Every sum is unrolled and all
+    // of them are computed before any is stored, so the block is straight-line code that the
+    // compiler packs into vector arithmetic, lane j holding slot j.
+    template <std::size_t... J>
+    static void blockDistances(const Scalar* c, std::size_t stride, const Scalar* q, Scalar* out, std::index_sequence<J...>) {
+        const Scalar d2[] = { slotDistanceSquared(c + J, stride, q, Axes())... };
+        ((out[J] = d2[J]), ...);
+    }
+
+    // Squared distances from q to count slots from first, written to out, which has room for
+    // count rounded up to LANES
+    void slotDistances(std::size_t first, std::size_t count, const Scalar* q, Scalar* out) const {
+        const Scalar* c = coords_.data() + first;
+        for (std::size_t i = 0; i < count; i += LANES) {
+            blockDistances(c + i, stride_, q, out + i, std::make_index_sequence<LANES>());
+        }
+    }
+
+    void build(const std::vector<Point>& points) {
+        const std::size_t n = points.size();
+        stride_ = n + LANES;
+        coords_.assign(stride_ * Dim, Scalar(0));
+        indices_.resize(n);
+        nodes_.clear();
+        nodes_.reserve(4 * n / leafSize_ + 1); // Median splits leave buckets at least half full
+        std::vector<Point> scratch(points); // Partitioned in place while building
+        if (n > 0) {
+            buildRange(scratch.data(), 0, n);
+        }
+    }
+
+    // Appends the subtree over pts[lo, hi) in pre-order; slots follow the partitioned order
+    void buildRange(Point* pts, std::size_t lo, std::size_t hi) {
+        const std::size_t at = nodes_.size();
+        nodes_.push_back({});
+        Node& node = nodes_[at];
+        std::fill(node.minV, node.minV + Dim, std::numeric_limits<Scalar>::infinity());
+        std::fill(node.maxV, node.maxV + Dim, -std::numeric_limits<Scalar>::infinity());
+        for (std::size_t i = lo; i < hi; ++i) {
+            for (int a = 0; a < Dim; ++a) {
+                node.minV[a] = std::min(node.minV[a], pts[i].coords[a]);
+                node.maxV[a] = std::max(node.maxV[a], pts[i].coords[a]);
+            }
+        }
+
+        if (hi - lo <= static_cast<std::size_t>(leafSize_)) {
+            for (std::size_t i = lo; i < hi; ++i) {
+                for (int a = 0; a < Dim; ++a) {
+                    coords_[a * stride_ + i] = pts[i].coords[a];
+                }
+                indices_[i] = pts[i].index;
+            }
+            node.right = static_cast<std::int32_t>(lo);
+            node.count = static_cast<std::uint16_t>(hi - lo);
+            return;
+        }
+
+        int axis = 0;
+        for (int a = 1; a < Dim; ++a) {
+            if (node.maxV[a] - node.minV[a] > node.maxV[axis] - node.minV[axis]) {
+                axis = a;
+            }
+        }
+        node.count = 0;
+        const std::size_t mid = lo + (hi - lo) / 2;
+        std::nth_element(pts + lo, pts + mid, pts + hi,
+            [axis](const Point& p, const Point& q) { return p.coords[axis] < q.coords[axis]; });
+        buildRange(pts, lo, mid);
+        nodes_[at].right = static_cast<std::int32_t>(nodes_.size()); // node may have moved
+        buildRange(pts, mid, hi);
+    }
+
+    using SortedCandidates = knn::SortedCandidates<Scalar>;
+    using HeapCandidates = knn::HeapCandidates<Scalar>;
+    using AllCandidates = knn::AllCandidates<Scalar>;
+    using CountCandidates = knn::CountCandidates<Scalar>;
+
+    // heap is cleared first and left sorted nearest first
+    void searchHeap(const Point& target, std::size_t k, std::vector<Candidate>& heap) const {
+        heap.clear();
+        if (k == 0) {
+            return;
+        }
+        Entry stack[MAX_DEPTH];
+        HeapCandidates best{ heap, k };
+        search(target, stack, best);
+        std::sort_heap(heap.begin(), heap.end());
+    }
+
+    // Depth-first walk that skips every subtree whose box is no closer than best's bound
+    template <typename Candidates>
+    void search(const Point& target, Entry* stack, Candidates& best) const {
+        if (nodes_.empty()) {
+            return;
+        }
+        const Scalar* q = target.coords;
+        const Node* nodes = nodes_.data();
+        Scalar d2[MAX_LEAF_SIZE];
+
+        int top = 0;
+        stack[top++] = { 0, boxDistanceSquared(nodes[0], q, Axes()) };
+        while (top > 0) {
+            Entry e = stack[--top];
+            if (e.bound >= best.bound()) {
+                continue;
+            }
+            const Node& node = nodes[e.node];
+            if (node.count > 0) {
+                const std::size_t first = static_cast<std::size_t>(node.right);
+                slotDistances(first, node.count, q, d2);
+                for (std::size_t i = 0; i < node.count; ++i) {
+                    if (d2[i] < best.bound()) {
+                        best.insert(d2[i], static_cast<int>(first + i));
+                    }
+                }
+                continue;
+            }
+
+            Entry near = { e.node + 1, boxDistanceSquared(nodes[e.node + 1], q, Axes()) };
+            Entry far = { node.right, boxDistanceSquared(nodes[node.right], q, Axes()) };
+            if (far.bound < near.bound) {
+                std::swap(near, far);
+            }
+            // Farther child first so the nearer one is popped, and tightens the bound, first
+            if (far.bound < best.bound()) {
+                stack[top++] = far;
+            }
+            if (near.bound < best.bound()) {
+                stack[top++] = near;
+            }
+        }
+    }
+};
+
+#endif // KDTREE_ND_H
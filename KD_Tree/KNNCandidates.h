@@ -0,0 +1,90 @@
+#ifndef KNN_CANDIDATES_H
+#define KNN_CANDIDATES_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * Candidate containers that a tree walk or a scan offers points to, shared by KDTree (double)
+ * and KDTreeND (double or float). Each one exposes bound(), the squared distance a point must
+ * beat to be offered, and insert(d2, slot), which callers only make with d2 < bound(); the
+ * searches tighten their pruning to bound() as it shrinks.
+ */
+namespace knn {
+
+template <typename Scalar>
+struct Neighbor {
+    int index;              // Point::index; the slot while a query runs
+    Scalar distanceSquared;
+};
+
+template <typename Scalar>
+using Candidate = std::pair<Scalar, int>; // Squared distance, slot
+
+// Fixed-capacity buffer of the best k candidates closer than limit, kept sorted by insertion
+template <typename Scalar>
+struct SortedCandidates {
+    Neighbor<Scalar>* items;
+    int k;
+    int count;
+    Scalar limit; // Squared distance a candidate must beat
+
+    Scalar bound() const {
+        return count == k ? items[k - 1].distanceSquared : limit;
+    }
+
+    // Caller guarantees d2 < bound()
+    void insert(Scalar d2, int slot) {
+        int i = count < k ? count++ : k - 1;
+        for (; i > 0 && items[i - 1].distanceSquared > d2; --i) {
+            items[i] = items[i - 1];
+        }
+        items[i] = { slot, d2 };
+    }
+};
+
+// Max-heap of candidates on squared distance, for k beyond the sorted buffer's capacity
+template <typename Scalar>
+struct HeapCandidates {
+    std::vector<Candidate<Scalar>>& heap;
+    std::size_t k;
+
+    Scalar bound() const {
+        return heap.size() == k ? heap.front().first : std::numeric_limits<Scalar>::infinity();
+    }
+
+    void insert(Scalar d2, int slot) {
+        if (heap.size() == k) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.pop_back();
+        }
+        heap.emplace_back(d2, slot);
+        std::push_heap(heap.begin(), heap.end());
+    }
+};
+
+// Every candidate closer than limit, in search order
+template <typename Scalar>
+struct AllCandidates {
+    std::vector<Neighbor<Scalar>>& items;
+    Scalar limit;
+
+    Scalar bound() const { return limit; }
+    void insert(Scalar d2, int slot) { items.push_back({ slot, d2 }); }
+};
+
+template <typename Scalar>
+struct CountCandidates {
+    std::size_t count;
+    Scalar limit;
+
+    Scalar bound() const { return limit; }
+    void insert(Scalar, int) { ++count; }
+};
+
+} // namespace knn
+
+#endif // KNN_CANDIDATES_H
@@ -0,0 +1,260 @@
+#ifndef KNN_GRAPH_H
+#define KNN_GRAPH_H
+
+#include "KDTree.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <vector>
+
+/**
+ * The k nearest neighbours of every vertex among the vertices themselves, as a graph in
+ * compressed sparse row form: vertex v's neighbours are neighbors()[offsets()[v]] up to
+ * neighbors()[offsets()[v + 1]], nearest first, identified by their position in the vertex
+ * array. A vertex is never its own neighbour, but coincident vertices (UV seams, split
+ * normals) are neighbours at distance 0.
+ *
+ * The vertices go into a KDTree and every tree slot is queried from the point it holds, in
+ * slot order. Consecutive queries then come from the same leaf and walk the same nodes, and
+ * the query's own slot is dropped inside the top-k buffer, so it never takes a neighbour's
+ * place. Threads claim chunks of slots from a shared counter until none are left, so threads
+ * that drew dense regions do not hold up the others.
+ *
+ * With symmetric set, v also lists every u that has v among its k nearest, so rows may hold
+ * more than k neighbours. Smoothing and diffusion weights then treat both ends alike.
+ */
+class KNNGraph {
+public:
+    // Slots a thread claims at a time
+    static constexpr std::size_t CHUNK = 2048;
+
+    KNNGraph() : offsets_(1, 0) {
+    }
+
+    // k is clamped to [0, vertices - 1]; threads 0 uses std::thread::hardware_concurrency()
+    KNNGraph(const std::vector<Point>& vertices, int k, bool symmetric = false, unsigned threads = 0) {
+        unsigned hw = std::thread::hardware_concurrency();
+        threads_ = threads ? threads : (hw ? hw : 1);
+        std::vector<int> order;
+        build(vertices, k, order);
+        if (symmetric) {
+            symmetrize(order);
+        }
+    }
+
+    std::size_t size() const { return offsets_.size() - 1; }
+    std::size_t edgeCount() const { return neighbors_.size(); }
+    std::size_t degree(std::size_t v) const { return offsets_[v + 1] - offsets_[v]; }
+
+    // Vertex count + 1 row starts
+    const std::vector<std::size_t>& offsets() const { return offsets_; }
+    // Neighbour positions in the vertex array, row by row
+    const std::vector<int>& neighbors() const { return neighbors_; }
+    // Distance of each entry of neighbors()
+    const std::vector<double>& distances() const { return distances_; }
+
+    const int* neighborsOf(std::size_t v) const { return neighbors_.data() + offsets_[v]; }
+    const double* distancesOf(std::size_t v) const { return distances_.data() + offsets_[v]; }
+
+private:
+    std::vector<std::size_t> offsets_;
+    std::vector<int> neighbors_;
+    std::vector<double> distances_;
+    unsigned threads_ = 1;
+
+    // Candidate buffer that passes every insert through except that of one slot
+    template <typename Candidates>
+    struct Excluding {
+        Candidates& inner;
+        int excluded;
+
+        double bound() const { return inner.bound(); }
+
+        void insert(double d2, int slot) {
+            if (slot != excluded) {
+                inner.insert(d2, slot);
+            }
+        }
+    };
+
+    // Runs fn(begin, end) on chunks of [0, count) that `threads` threads claim in turn from a
+    // shared counter, so the work spreads by cost rather than by count
+    template <typename Fn>
+    static void claimChunks(std::size_t count, std::size_t chunk, unsigned threads, Fn&& fn) {
+        std::atomic<std::size_t> next(0);
+        auto work = [&]() {
+            for (std::size_t begin = next.fetch_add(chunk); begin < count; begin = next.fetch_add(chunk)) {
+                fn(begin, std::min(count, begin + chunk));
+            }
+        };
+        const std::size_t useful = (count + chunk - 1) / chunk;
+        std::vector<std::thread> pool;
+        for (std::size_t t = 1; t < std::min<std::size_t>(threads, useful); ++t) {
+            pool.emplace_back(work);
+        }
+        work();
+        for (std::thread& t : pool) {
+            t.join();
+        }
+    }
+
+    // Fills the rows, and order with the vertices in tree slot order
+    void build(const std::vector<Point>& vertices, int k, std::vector<int>& order) {
+        const std::size_t n = vertices.size();
+        const std::size_t kk = n > 0 ? std::min<std::size_t>(static_cast<std::size_t>(std::max(k, 0)), n - 1) : 0;
+        offsets_.assign(n + 1, 0);
+        neighbors_.clear();
+        distances_.clear();
+        if (kk == 0) {
+            return;
+        }
+
+        // Indexed by position, so the tree reports neighbours as positions in the vertex array
+        std::vector<Point> points(vertices);
+        for (std::size_t i = 0; i < n; ++i) {
+            points[i].index = static_cast<int>(i);
+        }
+        KDTree::BuildOptions options;
+        options.threads = threads_;
+        const KDTree tree(points, options);
+        const KDTree::Data d = tree.data();
+        order.assign(d.indices, d.indices + n);
+
+        // Rows are written in place at v * kk; rows left short (NaN coordinates) are compacted
+        neighbors_.resize(n * kk);
+        distances_.resize(n * kk);
+        std::vector<std::uint32_t> counts(n);
+        claimChunks(n, CHUNK, threads_, [&](std::size_t begin, std::size_t end) {
+            KDTree::Entry stack[KDTree::MAX_DEPTH];
+            KDTree::Neighbor found[KDTree::MAX_K];
+            std::vector<KDTree::Candidate> heap;
+            for (std::size_t slot = begin; slot < end; ++slot) {
+                const std::size_t v = static_cast<std::size_t>(d.indices[slot]);
+                const Point target = { d.xs[slot], d.ys[slot], d.zs[slot], -1 };
+                int* rowIndices = &neighbors_[v * kk];
+                double* rowDistances = &distances_[v * kk];
+                std::size_t count = 0;
+                if (kk <= static_cast<std::size_t>(KDTree::MAX_K)) {
+                    KDTree::SortedCandidates best{ found, static_cast<int>(kk), 0, std::numeric_limits<double>::infinity() };
+                    Excluding<KDTree::SortedCandidates> excluding{ best, static_cast<int>(slot) };
+                    tree.search(target, stack, excluding);
+                    for (int j = 0; j < best.count; ++j, ++count) {
+                        rowIndices[count] = d.indices[best.items[j].index];
+                        rowDistances[count] = std::sqrt(best.items[j].distanceSquared);
+                    }
+                }
+                else {
+                    heap.clear();
+                    KDTree::HeapCandidates best{ heap, kk };
+                    Excluding<KDTree::HeapCandidates> excluding{ best, static_cast<int>(slot) };
+                    tree.search(target, stack, excluding);
+                    std::sort_heap(heap.begin(), heap.end());
+                    for (const KDTree::Candidate& c : heap) {
+                        rowIndices[count] = d.indices[c.second];
+                        rowDistances[count++] = std::sqrt(c.first);
+                    }
+                }
+                counts[v] = static_cast<std::uint32_t>(count);
+            }
+        });
+
+        bool full = true;
+        for (std::size_t v = 0; v < n; ++v) {
+            offsets_[v + 1] = offsets_[v] + counts[v];
+            full = full && counts[v] == kk;
+        }
+        if (!full) {
+            for (std::size_t v = 0; v < n; ++v) {
+                std::copy_n(&neighbors_[v * kk], counts[v], &neighbors_[offsets_[v]]);
+                std::copy_n(&distances_[v * kk], counts[v], &distances_[offsets_[v]]);
+            }
+            neighbors_.resize(offsets_[n]);
+            distances_.resize(offsets_[n]);
+        }
+    }
+
+    bool hasEdge(std::size_t from, int to) const {
+        return std::find(neighbors_.begin() + static_cast<std::ptrdiff_t>(offsets_[from]),
+            neighbors_.begin() + static_cast<std::ptrdiff_t>(offsets_[from + 1]), to) !=
+            neighbors_.begin() + static_cast<std::ptrdiff_t>(offsets_[from + 1]);
+    }
+
+    // Adds the reverse of every one-way edge: one-way edges are marked and counted per target
+    // row, the rows are widened, the reverses appended through per-row cursors and every row
+    // re-sorted by distance (then position, so the result does not depend on the thread timing).
+    // Rows are visited in slot order, where consecutive vertices share most of their neighbours.
+    void symmetrize(const std::vector<int>& order) {
+        if (order.empty()) {
+            return; // No edges
+        }
+        const std::size_t n = size();
+        std::vector<std::atomic<std::uint32_t>> extra(n);
+        std::vector<char> oneWay(edgeCount());
+        claimChunks(n, CHUNK, threads_, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t slot = begin; slot < end; ++slot) {
+                const std::size_t u = static_cast<std::size_t>(order[slot]);
+                for (std::size_t e = offsets_[u]; e < offsets_[u + 1]; ++e) {
+                    const std::size_t v = static_cast<std::size_t>(neighbors_[e]);
+                    if (!hasEdge(v, static_cast<int>(u))) {
+                        oneWay[e] = 1;
+                        extra[v].fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+        });
+
+        std::vector<std::size_t> offsets(n + 1, 0);
+        for (std::size_t v = 0; v < n; ++v) {
+            offsets[v + 1] = offsets[v] + degree(v) + extra[v].load(std::memory_order_relaxed);
+        }
+        std::vector<int> neighbors(offsets[n]);
+        std::vector<double> distances(offsets[n]);
+        std::vector<std::atomic<std::size_t>> cursor(n);
+        for (std::size_t v = 0; v < n; ++v) {
+            std::copy_n(neighborsOf(v), degree(v), &neighbors[offsets[v]]);
+            std::copy_n(distancesOf(v), degree(v), &distances[offsets[v]]);
+            cursor[v].store(offsets[v] + degree(v), std::memory_order_relaxed);
+        }
+        claimChunks(n, CHUNK, threads_, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t slot = begin; slot < end; ++slot) {
+                const std::size_t u = static_cast<std::size_t>(order[slot]);
+                for (std::size_t e = offsets_[u]; e < offsets_[u + 1]; ++e) {
+                    if (oneWay[e]) {
+                        const std::size_t v = static_cast<std::size_t>(neighbors_[e]);
+                        const std::size_t at = cursor[v].fetch_add(1, std::memory_order_relaxed);
+                        neighbors[at] = static_cast<int>(u);
+                        distances[at] = distances_[e];
+                    }
+                }
+            }
+        });
+
+        claimChunks(n, CHUNK, threads_, [&](std::size_t begin, std::size_t end) {
+            std::vector<std::pair<double, int>> row;
+            for (std::size_t v = begin; v < end; ++v) {
+                if (offsets[v + 1] - offsets[v] == degree(v)) {
+                    continue; // Nothing appended, still sorted
+                }
+                row.clear();
+                for (std::size_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                    row.emplace_back(distances[e], neighbors[e]);
+                }
+                std::sort(row.begin(), row.end());
+                for (std::size_t j = 0; j < row.size(); ++j) {
+                    distances[offsets[v] + j] = row[j].first;
+                    neighbors[offsets[v] + j] = row[j].second;
+                }
+            }
+        });
+        offsets_.swap(offsets);
+        neighbors_.swap(neighbors);
+        distances_.swap(distances);
+    }
+};
+
+#endif // KNN_GRAPH_H
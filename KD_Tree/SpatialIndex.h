@@ -0,0 +1,140 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include "BruteForceKNN.h"
+#include "KDTree.h"
+#include "UniformGrid.h"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * Point index that is a UniformGrid or a KDTree, whichever suits the points: the grid when
+ * there are many points spread evenly enough to fill most of its cells (dense lattice cages,
+ * regular wrap drivers), the tree otherwise. Mid-sized sets stay in the tree, whose few leaves
+ * cost less to scan than the grid's rings of cells. A BruteForceKNN can be asked for by kind;
+ * it is never chosen, since its queries are slower than the tree's at every size. Forwards
+ * the query interface the three share.
+ */
+class SpatialIndex {
+public:
+    using Neighbor = KDTree::Neighbor;
+    using RadiusResult = KDTree::RadiusResult;
+    using QueryOrder = KDTree::QueryOrder;
+    using SearchBudget = KDTree::SearchBudget;
+
+    enum class Kind {
+        Auto, // Chosen by choose()
+        Tree,
+        Grid,
+        BruteForce // Only when asked for: builds fastest, queries slower than the tree
+    };
+
+    // Points and UniformGrid::occupancy() from which the grid is chosen
+    static constexpr std::size_t GRID_MIN_POINTS = 1 << 14;
+    static constexpr double GRID_MIN_OCCUPANCY = 0.5;
+
+    explicit SpatialIndex(const std::vector<Point>& points, Kind kind = Kind::Auto)
+        : requested_(kind), kind_(kind == Kind::Auto ? choose(points) : kind) {
+        build(points);
+    }
+
+    // Index kind for these points, from their count and the share of grid cells they would
+    // occupy
+    static Kind choose(const std::vector<Point>& points) {
+        if (points.size() < GRID_MIN_POINTS) {
+            return Kind::Tree;
+        }
+        return UniformGrid::occupancy(points) >= GRID_MIN_OCCUPANCY ? Kind::Grid : Kind::Tree;
+    }
+
+    Kind kind() const { return kind_; }
+
+    std::vector<int> findKNearest(const Point& target, int k) const {
+        return visit([&](const auto& index) { return index.findKNearest(target, k); });
+    }
+
+    void findKNearestBatch(const Point* queries, std::size_t n, int k, int* outIndices, double* outDistances,
+        QueryOrder order = QueryOrder::Input) const {
+        visit([&](const auto& index) { index.findKNearestBatch(queries, n, k, outIndices, outDistances, order); });
+    }
+
+    // As KDTree's budgeted batch; the grid and the scan are exact whatever the budget, and
+    // return 0
+    std::size_t findKNearestBatch(const Point* queries, std::size_t n, int k, const SearchBudget& budget, int* outIndices,
+        double* outDistances, QueryOrder order = QueryOrder::Input) const {
+        if (tree_) {
+            return tree_->findKNearestBatch(queries, n, k, budget, outIndices, outDistances, order);
+        }
+        findKNearestBatch(queries, n, k, outIndices, outDistances, order);
+        return 0;
+    }
+
+    std::size_t findWithinRadius(const Point& target, double radius, std::vector<Neighbor>& out, int maxCount = 0) const {
+        return visit([&](const auto& index) { return index.findWithinRadius(target, radius, out, maxCount); });
+    }
+
+    std::size_t countWithinRadius(const Point& target, double radius) const {
+        return visit([&](const auto& index) { return index.countWithinRadius(target, radius); });
+    }
+
+    void findWithinRadiusBatch(const Point* queries, std::size_t n, double radius, RadiusResult& out, int maxCount = 0,
+        QueryOrder order = QueryOrder::Input) const {
+        visit([&](const auto& index) { index.findWithinRadiusBatch(queries, n, radius, out, maxCount, order); });
+    }
+
+    // Takes new positions for the indexed points, which must be the same points (the same
+    // Point::index values) the index holds: the tree refits its boxes, the others rebuild. An
+    // automatically chosen kind is chosen again, and the index rebuilt if that changes it.
+    void refit(const std::vector<Point>& points) {
+        const Kind kind = requested_ == Kind::Auto ? choose(points) : requested_;
+        if (tree_ && kind == kind_) {
+            tree_->refit(points);
+        }
+        else {
+            kind_ = kind;
+            build(points);
+        }
+    }
+
+    std::size_t size() const { return visit([](const auto& index) { return index.size(); }); }
+    bool empty() const { return size() == 0; }
+
+private:
+    Kind requested_;
+    Kind kind_;
+    std::unique_ptr<KDTree> tree_;
+    std::unique_ptr<UniformGrid> grid_;
+    std::unique_ptr<BruteForceKNN> brute_;
+
+    void build(const std::vector<Point>& points) {
+        tree_.reset();
+        grid_.reset();
+        brute_.reset();
+        if (kind_ == Kind::Grid) {
+            grid_ = std::make_unique<UniformGrid>(points);
+        }
+        else if (kind_ == Kind::BruteForce) {
+            brute_ = std::make_unique<BruteForceKNN>(points);
+        }
+        else {
+            tree_ = std::make_unique<KDTree>(points);
+        }
+    }
+
+    // Calls fn with whichever index was built
+    template <typename Fn>
+    auto visit(Fn&& fn) const -> decltype(fn(std::declval<const KDTree&>())) {
+        if (grid_) {
+            return fn(*grid_);
+        }
+        if (brute_) {
+            return fn(*brute_);
+        }
+        return fn(*tree_);
+    }
+};
+
+#endif // SPATIAL_INDEX_H
@@ -0,0 +1,512 @@
+#ifndef TRIANGLE_BVH_H
+#define TRIANGLE_BVH_H
+
+#include "KDTree.h" // Point and the KDTREE_SSE / KDTREE_AVX kernel selection
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * Bounding volume hierarchy over a triangle mesh, for closest-point-on-surface queries.
+ *
+ * Built top-down with a binned surface area heuristic, and stored like KDTree: flat nodes in
+ * pre-order, left child next, right child by index. Leaf triangles are packed four to a
+ * packet in structure-of-arrays form with the edge vectors and their dot products
+ * precomputed, so a leaf of up to eight triangles is one or two passes of a branch-free SIMD
+ * kernel that scores four closest points at once (AVX, or two SSE2 halves). The SAH counts
+ * leaf cost in packets, not triangles, so leaves are only split when that saves a pass.
+ *
+ * The query walks the nodes nearest box first and prunes on box distance, like KDTree. Each
+ * hit reports the triangle, barycentric weights of its three corners and the distance.
+ */
+class TriangleBVH {
+    static constexpr int LANES = 4;                   // Triangles per packet
+    static constexpr int MAX_DEPTH = 128;
+    static constexpr int SAH_DEPTH = 64;              // Deeper ranges split at the median
+    static constexpr int SAH_BINS = 16;
+
+public:
+    static constexpr int DEFAULT_LEAF_SIZE = 8;
+    static constexpr int MAX_LEAF_SIZE = 8;           // Two packets
+
+    // Queries per thread below which closestPoints stays on the calling thread
+    static constexpr std::size_t BATCH_CHUNK = 256;
+
+    struct SurfacePoint {
+        int triangle = -1;        // Position in the triangle list; -1 if nothing was in range
+        double u = 0, v = 0, w = 0; // Weights of the triangle's corners: position = u a + v b + w c
+        double distance = std::numeric_limits<double>::infinity();
+    };
+
+    // triangles holds three indices into vertices per triangle (Point::index is not used).
+    // Degenerate triangles are fine: they are scored as their longest edge or point.
+    TriangleBVH(const std::vector<Point>& vertices, const std::vector<int>& triangles, int leafSize = DEFAULT_LEAF_SIZE)
+        : leafSize_(std::min(std::max(leafSize, 1), MAX_LEAF_SIZE)) {
+        build(vertices, triangles);
+    }
+
+    // Closest point of the surface to target, among points closer than maxDistance
+    SurfacePoint closestPoint(const Point& target, double maxDistance = std::numeric_limits<double>::infinity()) const {
+        SurfacePoint hit;
+        if (nodes_.empty() || !(maxDistance > 0)) {
+            return hit;
+        }
+        const double q[3] = { target.x, target.y, target.z };
+        double best = maxDistance * maxDistance;
+        Entry stack[MAX_DEPTH];
+        int top = 0;
+        stack[top++] = { 0, nodes_[0].distanceSquared(q) };
+        while (top > 0) {
+            Entry e = stack[--top];
+            if (e.bound >= best) {
+                continue;
+            }
+            const Node& node = nodes_[e.node];
+            if (node.count > 0) {
+                for (std::int32_t p = node.right; p < node.right + node.count; ++p) {
+                    scorePacket(packets_[p], q, best, hit);
+                }
+                continue;
+            }
+
+            Entry near = { e.node + 1, nodes_[e.node + 1].distanceSquared(q) };
+            Entry far = { node.right, nodes_[node.right].distanceSquared(q) };
+            if (far.bound < near.bound) {
+                std::swap(near, far);
+            }
+            if (far.bound < best) {
+                stack[top++] = far;
+            }
+            if (near.bound < best) {
+                stack[top++] = near;
+            }
+        }
+        if (hit.triangle >= 0) {
+            hit.distance = std::sqrt(best);
+        }
+        return hit;
+    }
+
+    using QueryOrder = KDTree::QueryOrder;
+
+    // closestPoint of each of the n queries into out, split across threads and run in the
+    // given order
+    void closestPoints(const Point* queries, std::size_t n, SurfacePoint* out,
+        double maxDistance = std::numeric_limits<double>::infinity(), QueryOrder order = QueryOrder::Input) const {
+        std::vector<std::uint32_t> sorted;
+        const std::uint32_t* runOrder = KDTree::queryOrder(queries, n, order, sorted);
+        KDTree::parallelFor(n, BATCH_CHUNK, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t r = begin; r < end; ++r) {
+                const std::size_t i = runOrder ? runOrder[r] : r;
+                out[i] = closestPoint(queries[i], maxDistance);
+            }
+        });
+    }
+
+    std::size_t triangleCount() const { return triangleCount_; }
+    bool empty() const { return triangleCount_ == 0; }
+    int leafSize() const { return leafSize_; }
+
+private:
+    struct Entry {
+        std::int32_t node;
+        double bound;
+    };
+
+    struct Bounds {
+        double minV[3];
+        double maxV[3];
+
+        static Bounds empty() {
+            const double inf = std::numeric_limits<double>::infinity();
+            return { { inf, inf, inf }, { -inf, -inf, -inf } };
+        }
+
+        void include(const double p[3]) {
+            for (int a = 0; a < 3; ++a) {
+                minV[a] = std::min(minV[a], p[a]);
+                maxV[a] = std::max(maxV[a], p[a]);
+            }
+        }
+
+        void include(const Bounds& other) {
+            for (int a = 0; a < 3; ++a) {
+                minV[a] = std::min(minV[a], other.minV[a]);
+                maxV[a] = std::max(maxV[a], other.maxV[a]);
+            }
+        }
+
+        double area() const {
+            double e[3];
+            for (int a = 0; a < 3; ++a) {
+                e[a] = std::max(maxV[a] - minV[a], 0.0);
+            }
+            return e[0] * e[1] + e[1] * e[2] + e[2] * e[0];
+        }
+    };
+
+    struct Node {
+        Bounds bounds;
+        std::int32_t right; // Internal: index of the right child; leaf: first packet
+        std::int32_t count; // Leaf: packets in the leaf; 0 for internal nodes
+
+        double distanceSquared(const double q[3]) const {
+            double d2 = 0;
+            for (int a = 0; a < 3; ++a) {
+                double d = std::max(std::max(bounds.minV[a] - q[a], q[a] - bounds.maxV[a]), 0.0);
+                d2 += d * d;
+            }
+            return d2;
+        }
+    };
+
+    // Four triangles a, b = a + ab, c = a + ac, lane by lane, with the dot products the closest
+    // point needs. Reciprocals of degenerate edges and faces are 0, which clamps their
+    // parameters to the edge start and turns the face test off. Unused lanes repeat a triangle.
+    struct alignas(32) Packet {
+        double ax[LANES], ay[LANES], az[LANES];
+        double abx[LANES], aby[LANES], abz[LANES];
+        double acx[LANES], acy[LANES], acz[LANES];
+        double d00[LANES], d01[LANES], d11[LANES]; // ab.ab, ab.ac, ac.ac
+        double invDenom[LANES];                    // 1 / (d00 d11 - d01^2)
+        double invD00[LANES], invD11[LANES];
+        double invBC[LANES];                       // 1 / |c - b|^2
+        int triangle[LANES];
+    };
+
+    // Four double lanes: one AVX register, two SSE2 registers or plain doubles. Comparisons
+    // return all-ones / all-zero lane masks for select().
+    struct Lanes {
+#if defined(KDTREE_AVX)
+        __m256d v;
+
+        static Lanes load(const double* p) { return { _mm256_load_pd(p) }; }
+        static Lanes set(double s) { return { _mm256_set1_pd(s) }; }
+        void store(double* p) const { _mm256_store_pd(p, v); }
+        friend Lanes operator+(Lanes a, Lanes b) { return { _mm256_add_pd(a.v, b.v) }; }
+        friend Lanes operator-(Lanes a, Lanes b) { return { _mm256_sub_pd(a.v, b.v) }; }
+        friend Lanes operator*(Lanes a, Lanes b) { return { _mm256_mul_pd(a.v, b.v) }; }
+        static Lanes min(Lanes a, Lanes b) { return { _mm256_min_pd(a.v, b.v) }; }
+        static Lanes max(Lanes a, Lanes b) { return { _mm256_max_pd(a.v, b.v) }; }
+        static Lanes less(Lanes a, Lanes b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ) }; }
+        static Lanes lessEqual(Lanes a, Lanes b) { return { _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ) }; }
+        static Lanes both(Lanes a, Lanes b) { return { _mm256_and_pd(a.v, b.v) }; }
+        static Lanes select(Lanes mask, Lanes a, Lanes b) { return { _mm256_blendv_pd(b.v, a.v, mask.v) }; }
+#elif defined(KDTREE_SSE)
+        __m128d lo, hi;
+
+        static Lanes load(const double* p) { return { _mm_load_pd(p), _mm_load_pd(p + 2) }; }
+        static Lanes set(double s) { return { _mm_set1_pd(s), _mm_set1_pd(s) }; }
+        void store(double* p) const {
+            _mm_store_pd(p, lo);
+            _mm_store_pd(p + 2, hi);
+        }
+        friend Lanes operator+(Lanes a, Lanes b) { return { _mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi) }; }
+        friend Lanes operator-(Lanes a, Lanes b) { return { _mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi) }; }
+        friend Lanes operator*(Lanes a, Lanes b) { return { _mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi) }; }
+        static Lanes min(Lanes a, Lanes b) { return { _mm_min_pd(a.lo, b.lo), _mm_min_pd(a.hi, b.hi) }; }
+        static Lanes max(Lanes a, Lanes b) { return { _mm_max_pd(a.lo, b.lo), _mm_max_pd(a.hi, b.hi) }; }
+        static Lanes less(Lanes a, Lanes b) { return { _mm_cmplt_pd(a.lo, b.lo), _mm_cmplt_pd(a.hi, b.hi) }; }
+        static Lanes lessEqual(Lanes a, Lanes b) { return { _mm_cmple_pd(a.lo, b.lo), _mm_cmple_pd(a.hi, b.hi) }; }
+        static Lanes both(Lanes a, Lanes b) { return { _mm_and_pd(a.lo, b.lo), _mm_and_pd(a.hi, b.hi) }; }
+        static Lanes select(Lanes mask, Lanes a, Lanes b) {
+            return { _mm_or_pd(_mm_and_pd(mask.lo, a.lo), _mm_andnot_pd(mask.lo, b.lo)),
+                _mm_or_pd(_mm_and_pd(mask.hi, a.hi), _mm_andnot_pd(mask.hi, b.hi)) };
+        }
+#else
+        double v[LANES];
+
+        template <typename Fn>
+        static Lanes map(Lanes a, Lanes b, Fn fn) {
+            Lanes r;
+            for (int i = 0; i < LANES; ++i) {
+                r.v[i] = fn(a.v[i], b.v[i]);
+            }
+            return r;
+        }
+        static Lanes load(const double* p) { return { { p[0], p[1], p[2], p[3] } }; }
+        static Lanes set(double s) { return { { s, s, s, s } }; }
+        void store(double* p) const { std::copy(v, v + LANES, p); }
+        friend Lanes operator+(Lanes a, Lanes b) { return map(a, b, [](double x, double y) { return x + y; }); }
+        friend Lanes operator-(Lanes a, Lanes b) { return map(a, b, [](double x, double y) { return x - y; }); }
+        friend Lanes operator*(Lanes a, Lanes b) { return map(a, b, [](double x, double y) { return x * y; }); }
+        static Lanes min(Lanes a, Lanes b) { return map(a, b, [](double x, double y) { return std::min(x, y); }); }
+        static Lanes max(Lanes a, Lanes b) { return map(a, b, [](double x, double y) { return std::max(x, y); }); }
+        // Masks are 1 or 0 per lane here
+        static Lanes less(Lanes a, Lanes b) { return map(a, b, [](double x, double y) { return x < y ? 1.0 : 0.0; }); }
+        static Lanes lessEqual(Lanes a, Lanes b) { return map(a, b, [](double x, double y) { return x <= y ? 1.0 : 0.0; }); }
+        static Lanes both(Lanes a, Lanes b) { return map(a, b, [](double x, double y) { return x != 0 && y != 0 ? 1.0 : 0.0; }); }
+        static Lanes select(Lanes mask, Lanes a, Lanes b) {
+            Lanes r;
+            for (int i = 0; i < LANES; ++i) {
+                r.v[i] = mask.v[i] != 0 ? a.v[i] : b.v[i];
+            }
+            return r;
+        }
+#endif
+    };
+
+    // Closest point of each triangle in the packet to q: the face projection when it falls
+    // inside, otherwise the nearest of the three clamped edge projections. Keeps the best
+    // lane that beats best.
+    static void scorePacket(const Packet& t, const double q[3], double& best, SurfacePoint& hit) {
+        const Lanes zero = Lanes::set(0.0), one = Lanes::set(1.0);
+        const Lanes abx = Lanes::load(t.abx), aby = Lanes::load(t.aby), abz = Lanes::load(t.abz);
+        const Lanes acx = Lanes::load(t.acx), acy = Lanes::load(t.acy), acz = Lanes::load(t.acz);
+        const Lanes d00 = Lanes::load(t.d00), d01 = Lanes::load(t.d01), d11 = Lanes::load(t.d11);
+        const Lanes apx = Lanes::set(q[0]) - Lanes::load(t.ax);
+        const Lanes apy = Lanes::set(q[1]) - Lanes::load(t.ay);
+        const Lanes apz = Lanes::set(q[2]) - Lanes::load(t.az);
+        const Lanes d20 = apx * abx + apy * aby + apz * abz;
+        const Lanes d21 = apx * acx + apy * acy + apz * acz;
+
+        // Squared distance from q to a + v ab + w ac
+        auto distance2 = [&](Lanes v, Lanes w) {
+            Lanes dx = apx - v * abx - w * acx;
+            Lanes dy = apy - v * aby - w * acy;
+            Lanes dz = apz - v * abz - w * acz;
+            return dx * dx + dy * dy + dz * dz;
+        };
+        auto clamp01 = [&](Lanes x) { return Lanes::min(Lanes::max(x, zero), one); };
+
+        // Edge ab, then ac and bc
+        Lanes bestV = clamp01(d20 * Lanes::load(t.invD00));
+        Lanes bestW = zero;
+        Lanes bestD2 = distance2(bestV, bestW);
+        Lanes w = clamp01(d21 * Lanes::load(t.invD11));
+        Lanes d2 = distance2(zero, w);
+        Lanes closer = Lanes::less(d2, bestD2);
+        bestV = Lanes::select(closer, zero, bestV);
+        bestW = Lanes::select(closer, w, bestW);
+        bestD2 = Lanes::select(closer, d2, bestD2);
+        w = clamp01((d21 - d20 - d01 + d00) * Lanes::load(t.invBC)); // (q - b).(c - b) / |c - b|^2
+        d2 = distance2(one - w, w);
+        closer = Lanes::less(d2, bestD2);
+        bestV = Lanes::select(closer, one - w, bestV);
+        bestW = Lanes::select(closer, w, bestW);
+        bestD2 = Lanes::select(closer, d2, bestD2);
+
+        // Face, where the projection lands inside a non-degenerate triangle
+        const Lanes invDenom = Lanes::load(t.invDenom);
+        Lanes v = (d11 * d20 - d01 * d21) * invDenom;
+        w = (d00 * d21 - d01 * d20) * invDenom;
+        Lanes inside = Lanes::both(Lanes::both(Lanes::lessEqual(zero, v), Lanes::lessEqual(zero, w)),
+            Lanes::both(Lanes::lessEqual(v + w, one), Lanes::less(zero, invDenom)));
+        bestV = Lanes::select(inside, v, bestV);
+        bestW = Lanes::select(inside, w, bestW);
+        bestD2 = Lanes::select(inside, distance2(v, w), bestD2);
+
+        alignas(32) double outD2[LANES], outV[LANES], outW[LANES];
+        bestD2.store(outD2);
+        bestV.store(outV);
+        bestW.store(outW);
+        for (int i = 0; i < LANES; ++i) {
+            if (outD2[i] < best) {
+                best = outD2[i];
+                hit.triangle = t.triangle[i];
+                hit.v = outV[i];
+                hit.w = outW[i];
+                hit.u = 1.0 - outV[i] - outW[i];
+            }
+        }
+    }
+
+    // Triangle reference sorted during the build
+    struct Item {
+        double centroid[3];
+        Bounds bounds;
+        int triangle;
+    };
+
+    struct BuildState {
+        std::vector<Item> items;
+        const std::vector<Point>* vertices;
+        const std::vector<int>* triangles;
+    };
+
+    void build(const std::vector<Point>& vertices, const std::vector<int>& triangles) {
+        BuildState state;
+        state.vertices = &vertices;
+        state.triangles = &triangles;
+        triangleCount_ = triangles.size() / 3;
+        state.items.resize(triangleCount_);
+        for (std::size_t t = 0; t < triangleCount_; ++t) {
+            Item& item = state.items[t];
+            item.bounds = Bounds::empty();
+            for (int c = 0; c < 3; ++c) {
+                const Point& p = vertices[triangles[3 * t + c]];
+                const double pos[3] = { p.x, p.y, p.z };
+                item.bounds.include(pos);
+            }
+            for (int a = 0; a < 3; ++a) {
+                item.centroid[a] = 0.5 * (item.bounds.minV[a] + item.bounds.maxV[a]);
+            }
+            item.triangle = static_cast<int>(t);
+        }
+        nodes_.clear();
+        packets_.clear();
+        if (triangleCount_ > 0) {
+            nodes_.reserve(2 * triangleCount_);
+            buildRange(state, 0, triangleCount_, 0);
+        }
+    }
+
+    static int packetsFor(std::size_t count) {
+        return static_cast<int>((count + LANES - 1) / LANES);
+    }
+
+    // Splits [lo, hi) at the cheapest of SAH_BINS boundaries per axis, counting a side's cost
+    // as its surface area times its packets; returns hi if keeping the leaf is cheaper
+    std::size_t sahSplit(BuildState& state, std::size_t lo, std::size_t hi, const Bounds& bounds) const {
+        Bounds centroids = Bounds::empty();
+        for (std::size_t i = lo; i < hi; ++i) {
+            centroids.include(state.items[i].centroid);
+        }
+        const std::size_t count = hi - lo;
+        double bestCost = count <= static_cast<std::size_t>(leafSize_) ? packetsFor(count) * bounds.area()
+                                                                        : std::numeric_limits<double>::infinity();
+        int bestAxis = -1;
+        int bestBin = 0;
+        for (int a = 0; a < 3; ++a) {
+            const double extent = centroids.maxV[a] - centroids.minV[a];
+            if (!(extent > 0)) {
+                continue;
+            }
+            const double scale = SAH_BINS / extent;
+            std::size_t binCount[SAH_BINS] = {};
+            Bounds binBounds[SAH_BINS];
+            std::fill(binBounds, binBounds + SAH_BINS, Bounds::empty());
+            for (std::size_t i = lo; i < hi; ++i) {
+                int b = std::min(static_cast<int>((state.items[i].centroid[a] - centroids.minV[a]) * scale), SAH_BINS - 1);
+                ++binCount[b];
+                binBounds[b].include(state.items[i].bounds);
+            }
+            // Right side costs, swept from the top
+            double rightCost[SAH_BINS];
+            Bounds right = Bounds::empty();
+            std::size_t rightCount = 0;
+            for (int b = SAH_BINS - 1; b > 0; --b) {
+                right.include(binBounds[b]);
+                rightCount += binCount[b];
+                rightCost[b] = packetsFor(rightCount) * right.area();
+            }
+            Bounds left = Bounds::empty();
+            std::size_t leftCount = 0;
+            for (int b = 0; b < SAH_BINS - 1; ++b) {
+                left.include(binBounds[b]);
+                leftCount += binCount[b];
+                if (leftCount == 0 || leftCount == count) {
+                    continue;
+                }
+                // One box test per child, in the same area units as the packets
+                double cost = bounds.area() + packetsFor(leftCount) * left.area() + rightCost[b + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = a;
+                    bestBin = b;
+                }
+            }
+        }
+        if (bestAxis < 0) {
+            return count <= static_cast<std::size_t>(leafSize_) ? hi : lo + count / 2;
+        }
+        const double scale = SAH_BINS / (centroids.maxV[bestAxis] - centroids.minV[bestAxis]);
+        auto mid = std::partition(state.items.begin() + lo, state.items.begin() + hi, [&](const Item& item) {
+            return std::min(static_cast<int>((item.centroid[bestAxis] - centroids.minV[bestAxis]) * scale), SAH_BINS - 1) <= bestBin;
+        });
+        return static_cast<std::size_t>(mid - state.items.begin());
+    }
+
+    // Median of the widest centroid axis, which bounds the depth whatever the geometry
+    std::size_t medianSplit(BuildState& state, std::size_t lo, std::size_t hi) const {
+        Bounds centroids = Bounds::empty();
+        for (std::size_t i = lo; i < hi; ++i) {
+            centroids.include(state.items[i].centroid);
+        }
+        int axis = 0;
+        for (int a = 1; a < 3; ++a) {
+            if (centroids.maxV[a] - centroids.minV[a] > centroids.maxV[axis] - centroids.minV[axis]) {
+                axis = a;
+            }
+        }
+        std::size_t mid = lo + (hi - lo) / 2;
+        std::nth_element(state.items.begin() + lo, state.items.begin() + mid, state.items.begin() + hi,
+            [axis](const Item& a, const Item& b) { return a.centroid[axis] < b.centroid[axis]; });
+        return mid;
+    }
+
+    void buildRange(BuildState& state, std::size_t lo, std::size_t hi, int depth) {
+        const std::size_t at = nodes_.size();
+        nodes_.emplace_back();
+        Bounds bounds = Bounds::empty();
+        for (std::size_t i = lo; i < hi; ++i) {
+            bounds.include(state.items[i].bounds);
+        }
+        nodes_[at].bounds = bounds;
+
+        std::size_t mid = hi;
+        if (hi - lo > static_cast<std::size_t>(leafSize_) || depth < SAH_DEPTH) {
+            mid = depth < SAH_DEPTH ? sahSplit(state, lo, hi, bounds) : medianSplit(state, lo, hi);
+        }
+        if (mid == hi || mid == lo) {
+            nodes_[at].right = static_cast<std::int32_t>(packets_.size());
+            nodes_[at].count = packetsFor(hi - lo);
+            writeLeaf(state, lo, hi);
+            return;
+        }
+        nodes_[at].count = 0;
+        buildRange(state, lo, mid, depth + 1);
+        nodes_[at].right = static_cast<std::int32_t>(nodes_.size());
+        buildRange(state, mid, hi, depth + 1);
+    }
+
+    void writeLeaf(const BuildState& state, std::size_t lo, std::size_t hi) {
+        for (std::size_t first = lo; first < hi; first += LANES) {
+            Packet packet;
+            for (int lane = 0; lane < LANES; ++lane) {
+                const std::size_t i = std::min(first + lane, hi - 1); // Pad with the last triangle
+                const int t = state.items[i].triangle;
+                const Point& a = (*state.vertices)[(*state.triangles)[3 * t]];
+                const Point& b = (*state.vertices)[(*state.triangles)[3 * t + 1]];
+                const Point& c = (*state.vertices)[(*state.triangles)[3 * t + 2]];
+                const double ab[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+                const double ac[3] = { c.x - a.x, c.y - a.y, c.z - a.z };
+                const double d00 = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+                const double d01 = ab[0] * ac[0] + ab[1] * ac[1] + ab[2] * ac[2];
+                const double d11 = ac[0] * ac[0] + ac[1] * ac[1] + ac[2] * ac[2];
+                const double denom = d00 * d11 - d01 * d01;
+                const double bc = d00 - 2.0 * d01 + d11;
+                packet.ax[lane] = a.x;
+                packet.ay[lane] = a.y;
+                packet.az[lane] = a.z;
+                packet.abx[lane] = ab[0];
+                packet.aby[lane] = ab[1];
+                packet.abz[lane] = ab[2];
+                packet.acx[lane] = ac[0];
+                packet.acy[lane] = ac[1];
+                packet.acz[lane] = ac[2];
+                packet.d00[lane] = d00;
+                packet.d01[lane] = d01;
+                packet.d11[lane] = d11;
+                // Faces thinner than this relative to their edges are treated as edges
+                packet.invDenom[lane] = denom > 1e-14 * d00 * d11 ? 1.0 / denom : 0.0;
+                packet.invD00[lane] = d00 > 0 ? 1.0 / d00 : 0.0;
+                packet.invD11[lane] = d11 > 0 ? 1.0 / d11 : 0.0;
+                packet.invBC[lane] = bc > 0 ? 1.0 / bc : 0.0;
+                packet.triangle[lane] = t;
+            }
+            packets_.push_back(packet);
+        }
+    }
+
+    int leafSize_;
+    std::size_t triangleCount_ = 0;
+    std::vector<Node> nodes_;
+    std::vector<Packet> packets_;
+};
+
+#endif // TRIANGLE_BVH_H
@@ -0,0 +1,395 @@
+#ifndef UNIFORM_GRID_H
+#define UNIFORM_GRID_H
+
+#include "KDTree.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/**
+ * Uniform grid over 3D points, with the query interface of KDTree.
+ *
+ * The bounding box is cut into about n / pointsPerCell cells; axes thinner than a cell get a
+ * single one, so flat and linear cages do not blow up the cell count. A counting sort groups
+ * the points by cell into flat x, y, z and index arrays (cellStart_ holds each cell's first
+ * slot), and a query scores a cell with the same SIMD kernel as a KDTree leaf.
+ *
+ * kNN starts in the target's cell and grows a cube of cells one ring at a time, skipping
+ * cells whose box is farther than the current k-th best, until no cell outside the cube can
+ * hold anything closer. On evenly spread points that is one or two rings, with no tree to
+ * walk, and building is a counting sort about ten times faster than a tree's. On clustered
+ * points most cells are empty or overfull and KDTree wins; SpatialIndex uses occupancy() to
+ * tell the two apart.
+ */
+class UniformGrid {
+public:
+    using Neighbor = KDTree::Neighbor;
+    using RadiusResult = KDTree::RadiusResult;
+    using QueryOrder = KDTree::QueryOrder;
+
+    static constexpr double DEFAULT_POINTS_PER_CELL = 4.0;
+    static constexpr int MAX_K = KDTree::MAX_K;
+    static constexpr std::size_t BATCH_CHUNK = KDTree::BATCH_CHUNK;
+
+    // Scratch space of the allocation-free findKNearest; keep one per thread
+    class QueryContext {
+        friend class UniformGrid;
+        Neighbor best_[MAX_K];
+    };
+
+    explicit UniformGrid(const std::vector<Point>& points, double pointsPerCell = DEFAULT_POINTS_PER_CELL) {
+        build(points, pointsPerCell);
+    }
+
+    // Share of the cells a grid over points would have that hold at least one point: near 1
+    // for lattices and evenly scattered points, low for clusters, surfaces and outliers. Only
+    // lays out the cells and marks the ones hit; no grid is built.
+    static double occupancy(const std::vector<Point>& points, double pointsPerCell = DEFAULT_POINTS_PER_CELL) {
+        if (points.empty()) {
+            return 0.0;
+        }
+        UniformGrid grid;
+        grid.layout(points, pointsPerCell);
+        std::vector<char> hit(grid.cellCount(), 0);
+        std::size_t occupied = 0;
+        for (const Point& p : points) {
+            char& cell = hit[grid.cellOf(p)];
+            occupied += cell ? 0 : 1;
+            cell = 1;
+        }
+        return static_cast<double>(occupied) / static_cast<double>(hit.size());
+    }
+
+    // Indices (Point::index) of the k nearest points, nearest first
+    std::vector<int> findKNearest(const Point& target, int k) const {
+        std::vector<int> indices;
+        if (k <= MAX_K) {
+            QueryContext context;
+            Neighbor found[MAX_K];
+            int count = findKNearest(target, k, context, found);
+            for (int i = 0; i < count; ++i) {
+                indices.push_back(found[i].index);
+            }
+            return indices;
+        }
+
+        std::vector<KDTree::Candidate> heap;
+        searchHeap(target, static_cast<std::size_t>(k), heap);
+        for (const KDTree::Candidate& c : heap) {
+            indices.push_back(indices_[c.second]);
+        }
+        return indices;
+    }
+
+    // Writes the k nearest points (k clamped to [0, MAX_K]) to out, nearest first, with their
+    // squared distances, and returns how many were written
+    int findKNearest(const Point& target, int k, QueryContext& context, Neighbor* out) const {
+        KDTree::SortedCandidates best{ context.best_, std::min(std::max(k, 0), MAX_K), 0, std::numeric_limits<double>::infinity() };
+        if (best.k > 0) {
+            searchNearest(target, best);
+        }
+        for (int i = 0; i < best.count; ++i) {
+            out[i] = { indices_[best.items[i].index], best.items[i].distanceSquared };
+        }
+        return best.count;
+    }
+
+    // As KDTree::findKNearestBatch: row i of the n x k outputs holds query i's neighbours
+    void findKNearestBatch(const Point* queries, std::size_t n, int k, int* outIndices, double* outDistances,
+        QueryOrder order = QueryOrder::Input) const {
+        std::vector<std::uint32_t> sorted;
+        const std::uint32_t* runOrder = KDTree::queryOrder(queries, n, order, sorted);
+        KDTree::kNearestRows(n, k, runOrder, outIndices, outDistances, [&]() {
+            return [&, context = QueryContext(), found = std::array<Neighbor, MAX_K>(),
+                       heap = std::vector<KDTree::Candidate>()](std::size_t i, const KDTree::BatchRow<double>& row) mutable {
+                if (k <= MAX_K) {
+                    return row.take(found.data(), findKNearest(queries[i], k, context, found.data()));
+                }
+                searchHeap(queries[i], static_cast<std::size_t>(k), heap);
+                return row.take(heap, indices_.data());
+            };
+        });
+    }
+
+    // As KDTree::findWithinRadius: points with distance <= radius, nearest first, the
+    // maxCount nearest of them if maxCount > 0
+    std::size_t findWithinRadius(const Point& target, double radius, std::vector<Neighbor>& out, int maxCount = 0) const {
+        return KDTree::radiusNeighbors<KDTree::SortedCandidates, KDTree::AllCandidates>(radius, maxCount, indices_.data(), out,
+            [&](auto& candidates) { searchRadius(target, radius, candidates); });
+    }
+
+    std::size_t countWithinRadius(const Point& target, double radius) const {
+        KDTree::CountCandidates counter{ 0, KDTree::radiusLimit(radius) };
+        if (radius >= 0) {
+            searchRadius(target, radius, counter);
+        }
+        return counter.count;
+    }
+
+    // As KDTree::findWithinRadiusBatch, in compressed sparse row form
+    void findWithinRadiusBatch(const Point* queries, std::size_t n, double radius, RadiusResult& out, int maxCount = 0,
+        QueryOrder order = QueryOrder::Input) const {
+        std::vector<std::uint32_t> sorted;
+        const std::uint32_t* runOrder = KDTree::queryOrder(queries, n, order, sorted);
+        KDTree::radiusRows(n, runOrder, out, [&](std::size_t i, std::vector<Neighbor>& found) {
+            return findWithinRadius(queries[i], radius, found, maxCount);
+        });
+    }
+
+    std::size_t size() const { return indices_.size(); }
+    bool empty() const { return indices_.empty(); }
+    // Cells along x, y and z
+    int cells(int axis) const { return dims_[axis]; }
+
+private:
+    // Cells per axis beyond which the grid stops refining, whatever pointsPerCell asks for
+    static constexpr int MAX_DIM = 1024;
+
+    double origin_[3] = { 0, 0, 0 };
+    double cell_[3] = { 1, 1, 1 };    // Cell size per axis
+    double invCell_[3] = { 0, 0, 0 };
+    double slack_ = 0;                // Rounding margin of the cell-box pruning bounds
+    int dims_[3] = { 0, 0, 0 };
+    std::vector<std::uint32_t> cellStart_; // Cell c holds slots [cellStart_[c], cellStart_[c + 1])
+    std::vector<double> xs_, ys_, zs_;
+    std::vector<int> indices_;
+
+    int coord(double v, int axis) const {
+        double cell = (v - origin_[axis]) * invCell_[axis];
+        cell = cell >= 0 ? std::min(cell, static_cast<double>(dims_[axis] - 1)) : 0.0; // Also sends NaN to 0
+        return static_cast<int>(cell);
+    }
+
+    std::size_t cellOf(int x, int y, int z) const {
+        return (static_cast<std::size_t>(z) * dims_[1] + y) * dims_[0] + x;
+    }
+
+    UniformGrid() = default; // For occupancy(), which only needs the layout
+
+    std::size_t cellOf(const Point& p) const {
+        return cellOf(coord(p.x, 0), coord(p.y, 1), coord(p.z, 2));
+    }
+
+    std::size_t cellCount() const {
+        return static_cast<std::size_t>(dims_[0]) * dims_[1] * dims_[2];
+    }
+
+    void build(const std::vector<Point>& points, double pointsPerCell) {
+        const std::size_t n = points.size();
+        if (n == 0) {
+            cellStart_.assign(1, 0);
+            return;
+        }
+        layout(points, pointsPerCell);
+
+        // Counting sort by cell
+        const std::size_t cells = cellCount();
+        std::vector<std::uint32_t> cellOfPoint(n);
+        cellStart_.assign(cells + 1, 0);
+        for (std::size_t i = 0; i < n; ++i) {
+            cellOfPoint[i] = static_cast<std::uint32_t>(cellOf(points[i]));
+            ++cellStart_[cellOfPoint[i] + 1];
+        }
+        for (std::size_t c = 0; c < cells; ++c) {
+            cellStart_[c + 1] += cellStart_[c];
+        }
+        std::vector<std::uint32_t> next(cellStart_.begin(), cellStart_.end() - 1);
+        xs_.resize(n);
+        ys_.resize(n);
+        zs_.resize(n);
+        indices_.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint32_t slot = next[cellOfPoint[i]]++;
+            xs_[slot] = points[i].x;
+            ys_[slot] = points[i].y;
+            zs_[slot] = points[i].z;
+            indices_[slot] = points[i].index;
+        }
+    }
+
+    // Fits the cells to the bounding box of points, which must not be empty
+    void layout(const std::vector<Point>& points, double pointsPerCell) {
+        const std::size_t n = points.size();
+        double hi[3];
+        for (int a = 0; a < 3; ++a) {
+            origin_[a] = std::numeric_limits<double>::infinity();
+            hi[a] = -origin_[a];
+        }
+        for (const Point& p : points) {
+            for (int a = 0; a < 3; ++a) {
+                origin_[a] = std::min(origin_[a], p[a]);
+                hi[a] = std::max(hi[a], p[a]);
+            }
+        }
+
+        // Cube cells sized for the wanted count over the axes that are at least a cell thick;
+        // thinner axes get one cell and the size is worked out again over the rest
+        const double wanted = std::max(static_cast<double>(n) / std::max(pointsPerCell, 1e-3), 1.0);
+        bool thick[3];
+        for (int a = 0; a < 3; ++a) {
+            thick[a] = hi[a] > origin_[a];
+        }
+        double side = 0;
+        for (int pass = 0; pass < 3; ++pass) {
+            double measure = 1;
+            int axes = 0;
+            for (int a = 0; a < 3; ++a) {
+                if (thick[a]) {
+                    measure *= hi[a] - origin_[a];
+                    ++axes;
+                }
+            }
+            if (axes == 0) {
+                break;
+            }
+            side = std::pow(measure / wanted, 1.0 / axes);
+            bool changed = false;
+            for (int a = 0; a < 3; ++a) {
+                if (thick[a] && hi[a] - origin_[a] < side) {
+                    thick[a] = false;
+                    changed = true;
+                }
+            }
+            if (!changed) {
+                break;
+            }
+        }
+        double largest = 0;
+        for (int a = 0; a < 3; ++a) {
+            const double extent = hi[a] - origin_[a];
+            dims_[a] = thick[a] ? static_cast<int>(std::min(std::ceil(extent / side), static_cast<double>(MAX_DIM))) : 1;
+            dims_[a] = std::max(dims_[a], 1);
+            cell_[a] = extent > 0 ? extent / dims_[a] : 1.0;
+            invCell_[a] = extent > 0 ? 1.0 / cell_[a] : 0.0;
+            largest = std::max(largest, std::max(std::abs(origin_[a]), std::abs(hi[a])));
+        }
+        slack_ = 1e-9 * largest;
+    }
+
+    // Lower bound of the distance along axis from q to cell i
+    double axisGap(const double q[3], int axis, int i) const {
+        const double lo = origin_[axis] + i * cell_[axis];
+        return std::max(std::max(lo - q[axis], q[axis] - (lo + cell_[axis])) - slack_, 0.0);
+    }
+
+    // Offers the points of cell c that beat the current bound
+    template <typename Candidates>
+    void scanCell(std::size_t c, const double q[3], Candidates& best) const {
+        double d2[KDTree::MAX_LEAF_SIZE];
+        for (std::size_t first = cellStart_[c]; first < cellStart_[c + 1]; first += KDTree::MAX_LEAF_SIZE) {
+            const std::size_t count = std::min<std::size_t>(cellStart_[c + 1] - first, KDTree::MAX_LEAF_SIZE);
+            KDTree::squaredDistances(&xs_[first], &ys_[first], &zs_[first], count, q[0], q[1], q[2], d2);
+            for (std::size_t i = 0; i < count; ++i) {
+                if (d2[i] < best.bound()) {
+                    best.insert(d2[i], static_cast<int>(first + i));
+                }
+            }
+        }
+    }
+
+    // Visits rings of cells around the target's cell, nearest ring first, until the k-th best
+    // is closer than anything outside the cube visited so far
+    template <typename Candidates>
+    void searchNearest(const Point& target, Candidates& best) const {
+        if (empty()) {
+            return;
+        }
+        const double q[3] = { target.x, target.y, target.z };
+        int c[3];
+        for (int a = 0; a < 3; ++a) {
+            c[a] = coord(q[a], a);
+        }
+        for (int r = 0;; ++r) {
+            int lo[3], hi[3];
+            bool whole = true;
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::max(c[a] - r, 0);
+                hi[a] = std::min(c[a] + r, dims_[a] - 1);
+                whole = whole && lo[a] == 0 && hi[a] == dims_[a] - 1;
+            }
+            for (int z = lo[2]; z <= hi[2]; ++z) {
+                const double gz = axisGap(q, 2, z);
+                for (int y = lo[1]; y <= hi[1]; ++y) {
+                    const double gy = axisGap(q, 1, y);
+                    const double gzy = gz * gz + gy * gy;
+                    if (gzy >= best.bound()) {
+                        continue;
+                    }
+                    // Rows inside the shell only touch it at both ends
+                    const bool face = std::abs(z - c[2]) == r || std::abs(y - c[1]) == r;
+                    const int step = face ? 1 : 2 * r;
+                    for (int x = face ? lo[0] : c[0] - r; x <= hi[0]; x += step) {
+                        if (x < 0) {
+                            continue;
+                        }
+                        const double gx = axisGap(q, 0, x);
+                        if (gzy + gx * gx < best.bound()) {
+                            scanCell(cellOf(x, y, z), q, best);
+                        }
+                    }
+                }
+            }
+            if (whole) {
+                return;
+            }
+            // Nothing beyond the cube is closer than its nearest face that has cells behind it
+            double reach = std::numeric_limits<double>::infinity();
+            for (int a = 0; a < 3; ++a) {
+                if (c[a] - r > 0) {
+                    reach = std::min(reach, q[a] - (origin_[a] + (c[a] - r) * cell_[a]));
+                }
+                if (c[a] + r < dims_[a] - 1) {
+                    reach = std::min(reach, origin_[a] + (c[a] + r + 1) * cell_[a] - q[a]);
+                }
+            }
+            reach = std::max(reach - slack_, 0.0);
+            if (reach * reach >= best.bound()) {
+                return;
+            }
+        }
+    }
+
+    // Scans the cells overlapping the sphere's bounding box whose box is within radius
+    template <typename Candidates>
+    void searchRadius(const Point& target, double radius, Candidates& best) const {
+        if (empty()) {
+            return;
+        }
+        const double q[3] = { target.x, target.y, target.z };
+        int lo[3], hi[3];
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = coord(q[a] - radius, a);
+            hi[a] = coord(q[a] + radius, a);
+        }
+        for (int z = lo[2]; z <= hi[2]; ++z) {
+            const double gz = axisGap(q, 2, z);
+            for (int y = lo[1]; y <= hi[1]; ++y) {
+                const double gy = axisGap(q, 1, y);
+                for (int x = lo[0]; x <= hi[0]; ++x) {
+                    const double gx = axisGap(q, 0, x);
+                    if (gz * gz + gy * gy + gx * gx < best.bound()) {
+                        scanCell(cellOf(x, y, z), q, best);
+                    }
+                }
+            }
+        }
+    }
+
+    // heap is cleared first and left sorted nearest first
+    void searchHeap(const Point& target, std::size_t k, std::vector<KDTree::Candidate>& heap) const {
+        heap.clear();
+        if (k == 0) {
+            return;
+        }
+        KDTree::HeapCandidates best{ heap, k };
+        searchNearest(target, best);
+        std::sort_heap(heap.begin(), heap.end());
+    }
+};
+
+#endif // UNIFORM_GRID_H
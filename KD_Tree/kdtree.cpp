@@ -1,109 +1,1501 @@
+#include "BruteForceKNN.h"
+#include "KDTree.h"
+#include "KDTreeFile.h"
+#include "KDTreeND.h"
+#include "KNNGraph.h"
+#include "SpatialIndex.h"
+#include "TriangleBVH.h"
+#include "UniformGrid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <random>
+#include <thread>
 #include <vector>
-#include <queue>
-#include <cmath>
-#include <algorithm>
 
-struct Point {
-    double x, y, z;
-    int index;
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+// Distances computed along different arithmetic paths (the SIMD kernels, scalar code the
+// compiler may contract into FMAs) agree to a few rounding steps, not bit for bit
+template <typename Scalar>
+bool nearlyEqual(Scalar a, Scalar b) {
+    return std::abs(a - b) <= 64 * std::numeric_limits<Scalar>::epsilon() * std::max(std::abs(a), std::abs(b));
+}
+
+// Reference answer: sort every point by distance
+std::vector<int> bruteForceKNearest(const std::vector<Point>& points, const Point& target, int k) {
+    std::vector<std::pair<double, int>> all;
+    for (const Point& p : points) {
+        all.emplace_back(target.distanceSquared(p), p.index);
+    }
+    std::sort(all.begin(), all.end());
+    std::vector<int> indices;
+    for (int i = 0; i < k && i < static_cast<int>(all.size()); ++i) {
+        indices.push_back(all[i].second);
+    }
+    return indices;
+}
+
+std::vector<Point> randomPoints(std::mt19937& rng, int n) {
+    std::uniform_real_distribution<double> value(-100.0, 100.0);
+    std::vector<Point> points(n);
+    for (int i = 0; i < n; ++i) {
+        points[i] = { value(rng), value(rng), value(rng), i };
+    }
+    return points;
+}
+
+void testKNearest() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> value(-120.0, 120.0);
+    for (int leafSize : { 1, 8, 16, 32 }) {
+        for (int n : { 1, 2, 7, 100, 5000 }) {
+            std::vector<Point> points = randomPoints(rng, n);
+            KDTree tree(points, leafSize);
+            bool ok = tree.size() == points.size();
+            for (int q = 0; q < 200; ++q) {
+                Point target = { value(rng), value(rng), value(rng), -1 };
+                for (int k : { 1, 4, 16, 40 }) { // 40 > MAX_K takes the heap path
+                    ok = ok && tree.findKNearest(target, k) == bruteForceKNearest(points, target, k);
+                }
+            }
+            check(ok, "findKNearest matches brute force");
+        }
+    }
+    check(KDTree(std::vector<Point>()).findKNearest({ 0.0, 0.0, 0.0, -1 }, 3).empty(), "empty tree returns nothing");
+    check(KDTree(randomPoints(rng, 10), 0).leafSize() == 1, "leaf size is clamped");
+    std::cout << "findKNearest checked against brute force\n";
+}
+
+void testSquaredDistances() {
+    std::mt19937 rng(11);
+    std::vector<Point> points = randomPoints(rng, KDTree::MAX_LEAF_SIZE);
+    std::vector<double> xs, ys, zs;
+    for (const Point& p : points) {
+        xs.push_back(p.x);
+        ys.push_back(p.y);
+        zs.push_back(p.z);
+    }
+    Point target = { 1.5, -2.5, 3.5, -1 };
+    bool ok = true;
+    // Every length exercises a different mix of vector lanes and scalar tail
+    for (std::size_t n = 0; n <= points.size(); ++n) {
+        double d2[KDTree::MAX_LEAF_SIZE];
+        KDTree::squaredDistances(xs.data(), ys.data(), zs.data(), n, target.x, target.y, target.z, d2);
+        for (std::size_t i = 0; i < n; ++i) {
+            ok = ok && std::abs(d2[i] - target.distanceSquared(points[i])) <= 1e-9 * d2[i];
+        }
+    }
+    check(ok, "squaredDistances matches Point::distanceSquared");
+    std::cout << "squaredDistances checked\n";
+}
+
+void testKNearestBatch() {
+    std::mt19937 rng(5);
+    std::vector<Point> points = randomPoints(rng, 2000);
+    std::vector<Point> queries = randomPoints(rng, 3000); // Enough to split across threads
+    KDTree tree(points);
+    for (int k : { 1, 8 }) {
+        std::vector<int> indices(queries.size() * k);
+        std::vector<double> distances(queries.size() * k);
+        tree.findKNearestBatch(queries.data(), queries.size(), k, indices.data(), distances.data());
+        bool ok = true;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            std::vector<int> expected = tree.findKNearest(queries[i], k);
+            for (int j = 0; j < k; ++j) {
+                // Indices may only differ where two neighbours nearly tie
+                const double distance = queries[i].distance(points[expected[j]]);
+                ok = ok && nearlyEqual(distances[i * k + j], distance) &&
+                    (indices[i * k + j] == expected[j] || nearlyEqual(queries[i].distance(points[indices[i * k + j]]), distance));
+            }
+        }
+        check(ok, "findKNearestBatch matches findKNearest");
+    }
+
+    // Fewer points than k: rows are padded, and outDistances may be omitted
+    KDTree small(randomPoints(rng, 3));
+    std::vector<int> indices(2 * 5, 99);
+    small.findKNearestBatch(queries.data(), 2, 5, indices.data(), nullptr);
+    check(indices[3] == -1 && indices[4] == -1 && indices[8] == -1 && indices[2] != -1, "short rows are padded");
+
+    // Batches from several threads share the worker threads, which stop and start again
+    const int k = 4;
+    std::vector<int> expected(queries.size() * k);
+    tree.findKNearestBatch(queries.data(), queries.size(), k, expected.data(), nullptr);
+    std::vector<std::vector<int>> rows(4, std::vector<int>(queries.size() * k));
+    std::vector<std::thread> callers;
+    for (std::vector<int>& row : rows) {
+        callers.emplace_back([&]() { tree.findKNearestBatch(queries.data(), queries.size(), k, row.data(), nullptr); });
+    }
+    for (std::thread& t : callers) {
+        t.join();
+    }
+    KDTree::stopThreadPool();
+    rows.push_back(std::vector<int>(queries.size() * k));
+    tree.findKNearestBatch(queries.data(), queries.size(), k, rows.back().data(), nullptr);
+    check(std::all_of(rows.begin(), rows.end(), [&](const std::vector<int>& row) { return row == expected; }),
+        "concurrent batches match");
+    std::cout << "findKNearestBatch checked\n";
+}
+
+void testKNearestContext() {
+    std::mt19937 rng(9);
+    std::vector<Point> points = randomPoints(rng, 1000);
+    KDTree tree(points);
+    KDTree::QueryContext context; // One context serves every query
+    KDTree::Neighbor found[KDTree::MAX_K];
+    bool ok = true;
+    for (int q = 0; q < 200; ++q) {
+        Point target = randomPoints(rng, 1)[0];
+        for (int k : { 1, 4, 16, 32 }) {
+            int count = tree.findKNearest(target, k, context, found);
+            std::vector<int> expected = bruteForceKNearest(points, target, k);
+            ok = ok && count == k;
+            for (int j = 0; j < count; ++j) {
+                const double d2 = target.distanceSquared(points[expected[j]]);
+                ok = ok && nearlyEqual(found[j].distanceSquared, d2) &&
+                    (found[j].index == expected[j] || nearlyEqual(target.distanceSquared(points[found[j].index]), d2));
+            }
+        }
+    }
+    check(ok, "context query matches brute force");
+    check(tree.findKNearest(points[0], 100, context, found) == KDTree::MAX_K, "k is clamped to MAX_K");
+    check(KDTree(randomPoints(rng, 5)).findKNearest(points[0], 8, context, found) == 5, "short trees return what they have");
+    std::cout << "findKNearest with QueryContext checked\n";
+}
+
+// Reference answer: every point within radius, nearest first
+std::vector<int> bruteForceWithinRadius(const std::vector<Point>& points, const Point& target, double radius) {
+    std::vector<std::pair<double, int>> inside;
+    for (const Point& p : points) {
+        double d2 = target.distanceSquared(p);
+        if (d2 <= radius * radius) {
+            inside.emplace_back(d2, p.index);
+        }
+    }
+    std::sort(inside.begin(), inside.end());
+    std::vector<int> indices;
+    for (const auto& c : inside) {
+        indices.push_back(c.second);
+    }
+    return indices;
+}
+
+std::vector<int> indicesOf(const KDTree::Neighbor* begin, const KDTree::Neighbor* end) {
+    std::vector<int> indices;
+    for (const KDTree::Neighbor* n = begin; n != end; ++n) {
+        indices.push_back(n->index);
+    }
+    return indices;
+}
+
+void testWithinRadius() {
+    std::mt19937 rng(13);
+    std::vector<Point> points = randomPoints(rng, 3000);
+    std::vector<Point> queries = randomPoints(rng, 600);
+    KDTree tree(points, 8);
+    std::vector<KDTree::Neighbor> found;
+    bool ok = true;
+    for (double radius : { 0.0, 5.0, 20.0, 45.0 }) {
+        for (const Point& q : queries) {
+            std::vector<int> expected = bruteForceWithinRadius(points, q, radius);
+            tree.findWithinRadius(q, radius, found);
+            ok = ok && indicesOf(found.data(), found.data() + found.size()) == expected;
+            ok = ok && tree.countWithinRadius(q, radius) == expected.size();
+            // Capped: the nearest maxCount of them, through the sorted buffer and beyond MAX_K
+            for (int maxCount : { 3, 40 }) {
+                tree.findWithinRadius(q, radius, found, maxCount);
+                std::vector<int> nearest(expected.begin(), expected.begin() + std::min<std::size_t>(maxCount, expected.size()));
+                ok = ok && indicesOf(found.data(), found.data() + found.size()) == nearest;
+            }
+        }
+    }
+    check(ok, "findWithinRadius matches brute force");
+
+    // A point exactly on the sphere is inside
+    KDTree line({ { 0.0, 0.0, 0.0, 0 }, { 3.0, 0.0, 0.0, 1 } });
+    check(line.countWithinRadius({ 0.0, 0.0, 0.0, -1 }, 3.0) == 2, "radius is inclusive");
+    check(line.findWithinRadius({ 0.0, 0.0, 0.0, -1 }, -1.0, found) == 0, "negative radius finds nothing");
+
+    for (int maxCount : { 0, 4 }) {
+        KDTree::RadiusResult result;
+        tree.findWithinRadiusBatch(queries.data(), queries.size(), 20.0, result, maxCount);
+        bool batchOk = result.offsets.size() == queries.size() + 1 && result.offsets.back() == result.neighbors.size();
+        for (std::size_t i = 0; batchOk && i < queries.size(); ++i) {
+            tree.findWithinRadius(queries[i], 20.0, found, maxCount);
+            const KDTree::Neighbor* row = result.neighbors.data();
+            batchOk = indicesOf(row + result.offsets[i], row + result.offsets[i + 1]) ==
+                indicesOf(found.data(), found.data() + found.size());
+        }
+        check(batchOk, "findWithinRadiusBatch matches findWithinRadius");
+    }
+    std::cout << "radius queries checked against brute force\n";
+}
+
+void testParallelBuild() {
+    std::mt19937 rng(17);
+    std::vector<Point> uniform = randomPoints(rng, static_cast<int>(3 * KDTree::PARALLEL_BUILD_MIN));
+    // A tight cluster plus one far outlier: the histogram puts nearly everything in one bin,
+    // so Binned has to fall back to the median instead of peeling one point per level
+    std::vector<Point> clustered = randomPoints(rng, static_cast<int>(3 * KDTree::PARALLEL_BUILD_MIN));
+    for (Point& p : clustered) {
+        p.x *= 1e-3;
+        p.y *= 1e-3;
+        p.z *= 1e-3;
+    }
+    clustered.back().x = 1e9;
+    std::vector<Point> queries = randomPoints(rng, 8);
+    bool ok = true;
+    for (const std::vector<Point>* points : { &uniform, &clustered }) {
+        for (KDTree::SplitRule rule : { KDTree::SplitRule::Median, KDTree::SplitRule::Binned }) {
+            // Explicit thread counts take the parallel path even on a single-core machine
+            for (unsigned threads : { 1u, 3u, 8u }) {
+                KDTree::BuildOptions options;
+                options.split = rule;
+                options.threads = threads;
+                KDTree tree(*points, options);
+                ok = ok && tree.size() == points->size();
+                for (const Point& q : queries) {
+                    Point target = { q.x * 1e-3, q.y * 1e-3, q.z * 1e-3, -1 };
+                    ok = ok && tree.findKNearest(target, 8) == bruteForceKNearest(*points, target, 8);
+                    ok = ok && tree.findKNearest(q, 8) == bruteForceKNearest(*points, q, 8);
+                }
+            }
+        }
+    }
+    check(ok, "parallel and binned builds answer like brute force");
+    std::cout << "parallel build checked\n";
+}
+
+// Compares kNN and radius answers with brute force over the points the tree should hold
+bool matchesBruteForce(const KDTree& tree, const std::vector<Point>& live, std::mt19937& rng) {
+    bool ok = tree.size() == live.size();
+    std::vector<KDTree::Neighbor> found;
+    for (const Point& q : randomPoints(rng, 20)) {
+        ok = ok && tree.findKNearest(q, 6) == bruteForceKNearest(live, q, 6);
+        ok = ok && tree.findKNearest(q, 40) == bruteForceKNearest(live, q, 40);
+        tree.findWithinRadius(q, 15.0, found);
+        ok = ok && indicesOf(found.data(), found.data() + found.size()) == bruteForceWithinRadius(live, q, 15.0);
+    }
+    return ok;
+}
+
+void testDynamic() {
+    std::mt19937 rng(19);
+    std::uniform_real_distribution<double> offset(-30.0, 30.0);
+    std::vector<Point> live = randomPoints(rng, 2000);
+    KDTree tree(live);
+
+    // Inserts go to the scanned tail until it outgrows MAX_PENDING and is rebuilt in
+    bool insertOk = true;
+    for (int i = 2000; i < 4000; ++i) {
+        Point p = randomPoints(rng, 1)[0];
+        p.index = i;
+        tree.insert(p);
+        live.push_back(p);
+        if (i % 500 == 0) {
+            insertOk = insertOk && matchesBruteForce(tree, live, rng);
+        }
+    }
+    check(insertOk && matchesBruteForce(tree, live, rng), "queries see inserted points");
+
+    // An index that is already there is refused, in the tree and in the tail alike
+    bool duplicateOk = tree.insert({ 1.0, 2.0, 3.0, 5000 });
+    live.push_back({ 1.0, 2.0, 3.0, 5000 });
+    duplicateOk = duplicateOk && !tree.insert({ 4.0, 5.0, 6.0, 5000 }) && !tree.insert({ 4.0, 5.0, 6.0, live.front().index });
+    check(duplicateOk && tree.size() == live.size() && matchesBruteForce(tree, live, rng), "insert rejects an existing index");
+
+    // Remove from both the tree and the tail, enough to trigger a rebalance
+    bool removeOk = !tree.remove(-7);
+    std::shuffle(live.begin(), live.end(), rng);
+    for (int i = 0; i < 1500; ++i) {
+        removeOk = removeOk && tree.remove(live.back().index);
+        live.pop_back();
+        if (i % 300 == 0) {
+            removeOk = removeOk && matchesBruteForce(tree, live, rng);
+        }
+    }
+    check(removeOk && matchesBruteForce(tree, live, rng), "removed points are not returned");
+
+    // Moves keep answers exact before and after refit
+    bool moveOk = !tree.move(-7, 0.0, 0.0, 0.0);
+    for (int i = 0; i < 200; ++i) {
+        Point& p = live[i];
+        p = { p.x + offset(rng), p.y + offset(rng), p.z + offset(rng), p.index };
+        moveOk = moveOk && tree.move(p.index, p.x, p.y, p.z);
+    }
+    moveOk = moveOk && matchesBruteForce(tree, live, rng);
+    tree.refit();
+    moveOk = moveOk && matchesBruteForce(tree, live, rng);
+    for (Point& p : live) {
+        p = { p.x * 0.5 + 40.0, p.y, p.z - 10.0, p.index };
+    }
+    moveOk = moveOk && tree.refit(live) == live.size() && matchesBruteForce(tree, live, rng);
+    check(moveOk, "moved points are found at their new positions");
+
+    // A tree built empty grows by inserts alone
+    KDTree grown{ std::vector<Point>() };
+    std::vector<Point> added = randomPoints(rng, 300);
+    for (const Point& p : added) {
+        grown.insert(p);
+    }
+    check(matchesBruteForce(grown, added, rng), "inserts into an empty tree");
+    std::cout << "insert, remove, move and refit checked\n";
+}
+
+void testFileImage() {
+    std::mt19937 rng(23);
+    std::vector<Point> points = randomPoints(rng, 5000);
+    KDTree tree(points, 12);
+    const std::string path = "kdtree_test.kdt";
+    check(saveKDTree(tree, path), "saveKDTree writes the file");
+
+    std::string error;
+    std::unique_ptr<KDTree> loaded = loadKDTree(path, &error, true);
+    check(loaded && loaded->isMapped() && loaded->size() == tree.size() && loaded->leafSize() == 12, "loadKDTree maps the file");
+    if (loaded) {
+        check(matchesBruteForce(*loaded, points, rng), "mapped tree answers like brute force");
+        // Editing copies the image out of the mapping first
+        loaded->remove(points.back().index);
+        points.pop_back();
+        check(!loaded->isMapped() && matchesBruteForce(*loaded, points, rng), "mapped tree can be edited");
+    }
+
+    // Pending inserts and tombstones are folded in when saving
+    KDTree edited(points);
+    edited.insert({ 1.0, 1.0, 1.0, 9000 });
+    edited.remove(points.front().index);
+    points.erase(points.begin());
+    points.push_back({ 1.0, 1.0, 1.0, 9000 });
+    std::stringstream stream;
+    check(edited.save(stream), "save to a stream");
+    std::string image = stream.str();
+    std::vector<double> buffer(image.size() / sizeof(double) + 1); // 8-byte aligned copy
+    std::memcpy(buffer.data(), image.data(), image.size());
+    loaded = KDTree::fromImage(nullptr, buffer.data(), image.size(), &error, true);
+    check(loaded && matchesBruteForce(*loaded, points, rng), "edited tree round-trips");
+
+    // Damage is reported, not queried
+    std::vector<double> damaged = buffer;
+    reinterpret_cast<char*>(damaged.data())[20] ^= 1;
+    check(!KDTree::fromImage(nullptr, damaged.data(), image.size(), &error) && error == "header checksum mismatch", "header damage is detected");
+    damaged = buffer;
+    reinterpret_cast<char*>(damaged.data())[image.size() - 1] ^= 1;
+    check(KDTree::fromImage(nullptr, damaged.data(), image.size(), &error) != nullptr, "payload is not read without verification");
+    check(!KDTree::fromImage(nullptr, damaged.data(), image.size(), &error, true) && error == "payload checksum mismatch", "payload damage is detected");
+    check(!KDTree::fromImage(nullptr, buffer.data(), image.size() - 8, &error), "truncated image is rejected");
+
+    // Broken node links are caught without the payload checksum: the root's right child past
+    // the last node, and the root turned into a leaf larger than the leaf size. The root sits
+    // at FileHeader::nodesOffset (byte 48), with Node::right at byte 24 and Node::count at 28.
+    std::uint64_t nodesOffset;
+    std::memcpy(&nodesOffset, reinterpret_cast<const char*>(buffer.data()) + 48, sizeof(nodesOffset));
+    const std::int32_t pastEnd = std::numeric_limits<std::int32_t>::max();
+    const std::uint16_t oversized = 1000;
+    damaged = buffer;
+    std::memcpy(reinterpret_cast<char*>(damaged.data()) + nodesOffset + 24, &pastEnd, sizeof(pastEnd));
+    bool linksChecked = !KDTree::fromImage(nullptr, damaged.data(), image.size(), &error) && error == "image nodes are out of bounds";
+    damaged = buffer;
+    std::memcpy(reinterpret_cast<char*>(damaged.data()) + nodesOffset + 28, &oversized, sizeof(oversized));
+    linksChecked = linksChecked && !KDTree::fromImage(nullptr, damaged.data(), image.size(), &error) && error == "image nodes are out of bounds";
+    check(linksChecked, "broken node links are detected");
+    check(!loadKDTree("missing.kdt", &error), "missing file is reported");
+    std::remove(path.c_str());
+    std::cout << "file image checked\n";
+}
+
+void testApproximate() {
+    std::mt19937 rng(29);
+    std::vector<Point> points = randomPoints(rng, 4000);
+    KDTree tree(points);
+    KDTree::QueryContext context;
+    KDTree::Neighbor found[KDTree::MAX_K];
+    const int k = 8;
+    bool exactOk = true;
+    bool boundOk = true;
+    bool reportOk = true;
+    int inexact = 0;
+    for (int q = 0; q < 200; ++q) {
+        Point target = randomPoints(rng, 1)[0];
+        std::vector<int> expected = bruteForceKNearest(points, target, k);
+        KDTree::ApproximateResult result = tree.findKNearest(target, k, KDTree::SearchBudget(), context, found);
+        exactOk = exactOk && result.exact && result.count == k &&
+            indicesOf(found, found + result.count) == expected;
+
+        for (double epsilon : { 0.5, 2.0 }) {
+            result = tree.findKNearest(target, k, KDTree::SearchBudget{ epsilon, 0 }, context, found);
+            boundOk = boundOk && result.count == k;
+            for (int j = 0; j < result.count; ++j) {
+                double trueDistance = target.distance(points[expected[j]]);
+                boundOk = boundOk && std::sqrt(found[j].distanceSquared) <= (1.0 + epsilon) * trueDistance + 1e-12;
+            }
+            reportOk = reportOk && (!result.exact || indicesOf(found, found + result.count) == expected);
+        }
+        result = tree.findKNearest(target, k, KDTree::SearchBudget{ 0.0, 1 }, context, found);
+        inexact += result.exact ? 0 : 1;
+        reportOk = reportOk && result.count == k && (!result.exact || indicesOf(found, found + result.count) == expected);
+    }
+    check(exactOk, "an unlimited budget is exact");
+    check(boundOk, "epsilon bounds the distance error");
+    check(reportOk, "results reported exact are exact");
+    check(inexact > 0, "a one-leaf budget cuts some queries short");
+
+    std::vector<Point> queries = randomPoints(rng, 300);
+    for (int kk : { 4, 40 }) { // 40 > MAX_K takes the heap path
+        KDTree::SearchBudget budget{ 0.0, 2 };
+        std::vector<int> indices(queries.size() * kk);
+        std::size_t reported = tree.findKNearestBatch(queries.data(), queries.size(), kk, budget, indices.data(), nullptr);
+        std::size_t wrong = 0;
+        for (std::size_t i = 0; i < queries.size(); ++i) {
+            std::vector<int> row(indices.begin() + i * kk, indices.begin() + (i + 1) * kk);
+            wrong += row == bruteForceKNearest(points, queries[i], kk) ? 0 : 1;
+        }
+        check(reported > 0 && wrong <= reported, "batch counts the rows that may be inexact");
+        check(tree.findKNearestBatch(queries.data(), queries.size(), kk, KDTree::SearchBudget(), indices.data(), nullptr) == 0,
+            "unlimited batch is exact");
+    }
+    std::cout << "approximate findKNearest checked\n";
+}
+
+// Reference answer: closest point on triangle abc by Voronoi region (Ericson, Real-Time
+// Collision Detection 5.1.5), as barycentric weights of b and c
+void closestOnTriangle(const Point& p, const Point& a, const Point& b, const Point& c, double& v, double& w) {
+    auto sub = [](const Point& x, const Point& y) { return Point{ x.x - y.x, x.y - y.y, x.z - y.z, -1 }; };
+    auto dot = [](const Point& x, const Point& y) { return x.x * y.x + x.y * y.y + x.z * y.z; };
+    Point ab = sub(b, a), ac = sub(c, a), ap = sub(p, a);
+    double d1 = dot(ab, ap), d2 = dot(ac, ap);
+    v = 0;
+    w = 0;
+    if (d1 <= 0 && d2 <= 0) {
+        return;
+    }
+    Point bp = sub(p, b);
+    double d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3 >= 0 && d4 <= d3) {
+        v = 1;
+        return;
+    }
+    double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+        v = d1 / (d1 - d3);
+        return;
+    }
+    Point cp = sub(p, c);
+    double d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) {
+        w = 1;
+        return;
+    }
+    double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+        w = d2 / (d2 - d6);
+        return;
+    }
+    double va = d3 * d6 - d5 * d4;
+    if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0) {
+        w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        v = 1 - w;
+        return;
+    }
+    double denom = 1 / (va + vb + vc);
+    v = vb * denom;
+    w = vc * denom;
+}
+
+// Reference answer: closest point on segment ab, as the weight of b
+double closestOnSegment(const Point& p, const Point& a, const Point& b) {
+    const double ab[3] = { b.x - a.x, b.y - a.y, b.z - a.z };
+    const double length2 = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+    if (length2 == 0) {
+        return 0;
+    }
+    const double t = ((p.x - a.x) * ab[0] + (p.y - a.y) * ab[1] + (p.z - a.z) * ab[2]) / length2;
+    return std::min(1.0, std::max(0.0, t));
+}
+
+Point onTriangle(const std::vector<Point>& vertices, const std::vector<int>& triangles, int t, double u, double v, double w) {
+    const Point& a = vertices[triangles[3 * t]];
+    const Point& b = vertices[triangles[3 * t + 1]];
+    const Point& c = vertices[triangles[3 * t + 2]];
+    return { u * a.x + v * b.x + w * c.x, u * a.y + v * b.y + w * c.y, u * a.z + v * b.z + w * c.z, -1 };
+}
+
+// Closed surface of a torus with rings x sides quads split into triangles
+void torusMesh(int rings, int sides, std::vector<Point>& vertices, std::vector<int>& triangles) {
+    const double pi = 3.14159265358979323846;
+    vertices.clear();
+    triangles.clear();
+    for (int i = 0; i < rings; ++i) {
+        for (int j = 0; j < sides; ++j) {
+            double a = 2 * pi * i / rings, b = 2 * pi * j / sides;
+            double r = 10.0 + 3.0 * std::cos(b);
+            vertices.push_back({ r * std::cos(a), r * std::sin(a), 3.0 * std::sin(b), static_cast<int>(vertices.size()) });
+            int p = i * sides + j, q = ((i + 1) % rings) * sides + j;
+            int pn = i * sides + (j + 1) % sides, qn = ((i + 1) % rings) * sides + (j + 1) % sides;
+            triangles.insert(triangles.end(), { p, q, qn, p, qn, pn });
+        }
+    }
+}
+
+void testTriangleBVH() {
+    std::mt19937 rng(31);
+    std::uniform_real_distribution<double> offset(-2.0, 2.0);
+    std::vector<Point> vertices;
+    std::vector<int> triangles;
+    torusMesh(40, 24, vertices, triangles);
+    // A loose soup around the torus, with degenerate triangles among it
+    std::vector<Point> soup = randomPoints(rng, 600);
+    for (std::size_t i = 0; i < soup.size(); i += 3) {
+        int base = static_cast<int>(vertices.size());
+        Point a = { soup[i].x * 0.2, soup[i].y * 0.2, soup[i].z * 0.2, -1 };
+        vertices.push_back(a);
+        vertices.push_back({ a.x + offset(rng), a.y + offset(rng), a.z + offset(rng), -1 });
+        vertices.push_back(i % 30 == 0 ? a : Point{ a.x + offset(rng), a.y + offset(rng), a.z + offset(rng), -1 });
+        triangles.insert(triangles.end(), { base, base + 1, i % 45 == 0 ? base + 1 : base + 2 });
+    }
+    const int triangleCount = static_cast<int>(triangles.size() / 3);
+
+    std::vector<Point> queries = randomPoints(rng, 400);
+    for (Point& q : queries) {
+        q = { q.x * 0.2, q.y * 0.2, q.z * 0.1, -1 };
+    }
+    for (int i = 0; i < 50; ++i) { // Points on the surface
+        queries.push_back(onTriangle(vertices, triangles, i * 37 % triangleCount, 0.2, 0.3, 0.5));
+    }
+
+    // Rounding in the distances grows with the size of the coordinates, not of the distance
+    double extent = 0;
+    for (const Point& p : vertices) {
+        extent = std::max({ extent, std::abs(p.x), std::abs(p.y), std::abs(p.z) });
+    }
+    const double tolerance = 1e-12 * extent;
+    for (int leafSize : { 1, 4, 8 }) {
+        TriangleBVH bvh(vertices, triangles, leafSize);
+        bool ok = bvh.triangleCount() == static_cast<std::size_t>(triangleCount);
+        for (const Point& q : queries) {
+            double expected = std::numeric_limits<double>::infinity();
+            for (int t = 0; t < triangleCount; ++t) {
+                const Point& a = vertices[triangles[3 * t]];
+                const Point& b = vertices[triangles[3 * t + 1]];
+                const Point& c = vertices[triangles[3 * t + 2]];
+                double v, w;
+                closestOnTriangle(q, a, b, c, v, w);
+                expected = std::min(expected, q.distance(onTriangle(vertices, triangles, t, 1 - v - w, v, w)));
+                // The Voronoi regions of a degenerate triangle hinge on products that cancel to
+                // exactly zero only without FMA contraction, so its edges are measured directly
+                // (on a proper triangle they are never closer than its face)
+                double ab = closestOnSegment(q, a, b), bc = closestOnSegment(q, b, c), ca = closestOnSegment(q, c, a);
+                expected = std::min({ expected, q.distance(onTriangle(vertices, triangles, t, 1 - ab, ab, 0)),
+                    q.distance(onTriangle(vertices, triangles, t, 0, 1 - bc, bc)),
+                    q.distance(onTriangle(vertices, triangles, t, ca, 0, 1 - ca)) });
+            }
+            TriangleBVH::SurfacePoint hit = bvh.closestPoint(q);
+            ok = ok && hit.triangle >= 0 && std::abs(hit.distance - expected) <= tolerance;
+            ok = ok && hit.u >= -1e-12 && hit.v >= -1e-12 && hit.w >= -1e-12 && std::abs(hit.u + hit.v + hit.w - 1) < 1e-12;
+            Point at = onTriangle(vertices, triangles, hit.triangle, hit.u, hit.v, hit.w);
+            ok = ok && std::abs(q.distance(at) - hit.distance) <= tolerance;
+        }
+        check(ok, "closestPoint matches brute force");
+    }
+
+    TriangleBVH bvh(vertices, triangles);
+    std::vector<TriangleBVH::SurfacePoint> hits(queries.size());
+    bvh.closestPoints(queries.data(), queries.size(), hits.data());
+    bool same = true;
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        TriangleBVH::SurfacePoint hit = bvh.closestPoint(queries[i]);
+        same = same && hits[i].triangle == hit.triangle && hits[i].distance == hit.distance;
+    }
+    check(same, "closestPoints matches closestPoint");
+
+    TriangleBVH::SurfacePoint hit = bvh.closestPoint({ 0.0, 0.0, 0.0, -1 }, 0.01);
+    check(hit.triangle == -1 && std::isinf(hit.distance), "maxDistance limits the search");
+    check(TriangleBVH(vertices, std::vector<int>()).closestPoint(queries[0]).triangle == -1, "empty BVH finds nothing");
+    std::cout << "TriangleBVH checked against brute force\n";
+}
+
+void testMortonOrder() {
+    // Corners of a cube, listed backwards, come out in Z-order: x varies fastest, then y, z
+    std::vector<Point> corners;
+    for (int i = 7; i >= 0; --i) {
+        corners.push_back({ double(i & 1), double((i >> 1) & 1), double(i >> 2), i });
+    }
+    std::vector<std::uint32_t> order;
+    KDTree::mortonOrder(corners.data(), corners.size(), order);
+    bool zOrder = order.size() == 8;
+    for (std::size_t i = 0; zOrder && i < 8; ++i) {
+        zOrder = corners[order[i]].index == static_cast<int>(i);
+    }
+    check(zOrder, "mortonOrder follows the Z curve");
+
+    std::mt19937 rng(37);
+    std::vector<Point> points = randomPoints(rng, 3000);
+    std::vector<Point> queries = randomPoints(rng, 2000);
+    queries[5].x = std::numeric_limits<double>::quiet_NaN(); // Still gets a place in the order
+    KDTree::mortonOrder(queries.data(), queries.size(), order);
+    std::vector<std::uint32_t> sorted = order;
+    std::sort(sorted.begin(), sorted.end());
+    bool permutation = true;
+    for (std::size_t i = 0; i < sorted.size(); ++i) {
+        permutation = permutation && sorted[i] == i;
+    }
+    check(permutation, "mortonOrder is a permutation");
+
+    // Results come back in input order whichever order the queries ran in
+    KDTree tree(points);
+    for (int k : { 8, 40 }) {
+        std::vector<int> input(queries.size() * k), morton(queries.size() * k);
+        std::vector<double> inputDistances(queries.size() * k), mortonDistances(queries.size() * k);
+        tree.findKNearestBatch(queries.data(), queries.size(), k, input.data(), inputDistances.data());
+        tree.findKNearestBatch(queries.data(), queries.size(), k, morton.data(), mortonDistances.data(), KDTree::QueryOrder::Morton);
+        check(input == morton && std::equal(inputDistances.begin(), inputDistances.end(), mortonDistances.begin(),
+            [](double a, double b) { return a == b || (a != a && b != b); }), "Morton kNN batch matches input order");
+    }
+    KDTree::RadiusResult input, morton;
+    tree.findWithinRadiusBatch(queries.data(), queries.size(), 15.0, input);
+    tree.findWithinRadiusBatch(queries.data(), queries.size(), 15.0, morton, 0, KDTree::QueryOrder::Morton);
+    check(input.offsets == morton.offsets && indicesOf(input.neighbors.data(), input.neighbors.data() + input.neighbors.size()) ==
+        indicesOf(morton.neighbors.data(), morton.neighbors.data() + morton.neighbors.size()), "Morton radius batch matches input order");
 
-    // Calculate distance to another point
-    double distance(const Point& other) const {
-        return std::sqrt((x - other.x) * (x - other.x) +
-            (y - other.y) * (y - other.y) +
-            (z - other.z) * (z - other.z));
+    std::vector<Point> vertices;
+    std::vector<int> triangles;
+    torusMesh(30, 20, vertices, triangles);
+    TriangleBVH bvh(vertices, triangles);
+    std::vector<TriangleBVH::SurfacePoint> inputHits(queries.size()), mortonHits(queries.size());
+    bvh.closestPoints(queries.data(), queries.size(), inputHits.data());
+    bvh.closestPoints(queries.data(), queries.size(), mortonHits.data(), std::numeric_limits<double>::infinity(),
+        TriangleBVH::QueryOrder::Morton);
+    bool same = true;
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        same = same && inputHits[i].triangle == mortonHits[i].triangle && inputHits[i].u == mortonHits[i].u;
     }
-};
+    check(same, "Morton closestPoints matches input order");
+    std::cout << "Morton query order checked\n";
+}
 
-struct KDNode {
-    Point point;
-    KDNode* left;
-    KDNode* right;
+// n^3 lattice points spaced 1 apart, like a lattice cage
+std::vector<Point> latticePoints(int n) {
+    std::vector<Point> points;
+    for (int z = 0; z < n; ++z) {
+        for (int y = 0; y < n; ++y) {
+            for (int x = 0; x < n; ++x) {
+                points.push_back({ double(x), double(y), double(z), static_cast<int>(points.size()) });
+            }
+        }
+    }
+    return points;
+}
 
-    KDNode(const Point& p) : point(p), left(nullptr), right(nullptr) {}
-};
+// Squared distances of the listed points (Point::index is the position in points), which
+// compare nearly equal across ties where the indices need not
+std::vector<double> distancesOf(const std::vector<Point>& points, const Point& target, const std::vector<int>& indices) {
+    std::vector<double> d2;
+    for (int index : indices) {
+        d2.push_back(target.distanceSquared(points[index]));
+    }
+    return d2;
+}
 
-// Custom comparator for the max-heap
-struct Compare {
-    bool operator()(const std::pair<double, int>& a, const std::pair<double, int>& b) {
-        return a.first < b.first; // Max-heap: larger distance at the top
+// Two nearest-first answers agree when their distances do position by position; the index
+// set may still differ where the last places nearly tie
+template <typename Scalar>
+bool nearlyEqual(const std::vector<Scalar>& a, const std::vector<Scalar>& b) {
+    if (a.size() != b.size()) {
+        return false;
     }
-};
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (!nearlyEqual(a[i], b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testUniformGrid() {
+    std::mt19937 rng(41);
+    std::vector<std::vector<Point>> sets;
+    sets.push_back(latticePoints(12));
+    sets.push_back(randomPoints(rng, 3000));
+    std::vector<Point> plane = randomPoints(rng, 1500); // Flat, and a line inside it
+    for (Point& p : plane) {
+        p.z = 4.0;
+    }
+    sets.push_back(plane);
+    std::vector<Point> line = randomPoints(rng, 300);
+    for (Point& p : line) {
+        p.y = p.z = 0.0;
+    }
+    sets.push_back(line);
+    std::vector<Point> clustered = randomPoints(rng, 2000); // Tight cluster, far outlier, duplicates
+    for (Point& p : clustered) {
+        p = { p.x * 1e-3, p.y * 1e-3, p.z * 1e-3, p.index };
+    }
+    clustered[0] = { 1e4, -1e4, 5e3, 0 };
+    clustered[1] = { clustered[2].x, clustered[2].y, clustered[2].z, 1 };
+    sets.push_back(clustered);
+    sets.push_back({ { 1.0, 2.0, 3.0, 0 } });
 
-class KDTree {
-public:
-    KDTree(std::vector<Point>& points) {
-        root = buildTree(points.begin(), points.end(), 0);
+    std::uniform_real_distribution<double> value(-150.0, 150.0);
+    UniformGrid::QueryContext context;
+    UniformGrid::Neighbor found[UniformGrid::MAX_K];
+    std::vector<UniformGrid::Neighbor> within;
+    bool knnOk = true;
+    bool radiusOk = true;
+    for (const std::vector<Point>& points : sets) {
+        UniformGrid grid(points);
+        knnOk = knnOk && grid.size() == points.size();
+        for (int q = 0; q < 150; ++q) {
+            // Inside the cloud and well outside it
+            Point target = q % 3 == 0 ? Point{ value(rng), value(rng), value(rng), -1 } : points[q % points.size()];
+            if (q % 3 == 1) {
+                target.x += 0.37;
+                target.y -= 0.21;
+            }
+            for (int k : { 1, 4, 16, 40 }) {
+                std::vector<int> expected = bruteForceKNearest(points, target, k);
+                knnOk = knnOk && nearlyEqual(distancesOf(points, target, grid.findKNearest(target, k)), distancesOf(points, target, expected));
+            }
+            int count = grid.findKNearest(target, 8, context, found);
+            std::vector<int> expected = bruteForceKNearest(points, target, 8);
+            knnOk = knnOk && count == static_cast<int>(expected.size()) &&
+                (count == 0 || nearlyEqual(found[count - 1].distanceSquared, target.distanceSquared(points[expected.back()])));
+            for (double radius : { 0.0, 0.6, 7.0, 40.0 }) {
+                std::vector<int> inside = bruteForceWithinRadius(points, target, radius);
+                grid.findWithinRadius(target, radius, within);
+                std::vector<int> got = indicesOf(within.data(), within.data() + within.size());
+                std::sort(got.begin(), got.end());
+                std::vector<int> sortedInside = inside;
+                std::sort(sortedInside.begin(), sortedInside.end());
+                radiusOk = radiusOk && got == sortedInside && grid.countWithinRadius(target, radius) == inside.size();
+                grid.findWithinRadius(target, radius, within, 3);
+                radiusOk = radiusOk && within.size() == std::min<std::size_t>(3, inside.size());
+            }
+        }
     }
+    check(knnOk, "UniformGrid kNN matches brute force");
+    check(radiusOk, "UniformGrid radius queries match brute force");
 
-    std::vector<int> findKNearest(const Point& target, int k) {
-        std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, Compare> maxHeap;
-        findKNearest(root, target, k, 0, maxHeap);
+    std::vector<Point> points = randomPoints(rng, 4000);
+    std::vector<Point> queries = randomPoints(rng, 1500);
+    UniformGrid grid(points);
+    const int k = 6;
+    std::vector<int> indices(queries.size() * k);
+    grid.findKNearestBatch(queries.data(), queries.size(), k, indices.data(), nullptr, UniformGrid::QueryOrder::Morton);
+    bool batchOk = true;
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        batchOk = batchOk && std::vector<int>(indices.begin() + i * k, indices.begin() + (i + 1) * k) == grid.findKNearest(queries[i], k);
+    }
+    UniformGrid::RadiusResult result;
+    grid.findWithinRadiusBatch(queries.data(), queries.size(), 12.0, result, 0, UniformGrid::QueryOrder::Morton);
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        grid.findWithinRadius(queries[i], 12.0, within);
+        batchOk = batchOk && result.offsets[i + 1] - result.offsets[i] == within.size() &&
+            std::equal(within.begin(), within.end(), result.neighbors.begin() + result.offsets[i],
+                [](const UniformGrid::Neighbor& a, const UniformGrid::Neighbor& b) { return a.index == b.index; });
+    }
+    check(batchOk, "UniformGrid batches match single queries");
+    check(UniformGrid(std::vector<Point>()).findKNearest(points[0], 3).empty(), "empty grid finds nothing");
+
+    // The selector takes the grid for a dense lattice, and the tree for a small lattice and
+    // for a cluster with an outlier
+    std::vector<Point> dense = latticePoints(26);
+    SpatialIndex latticeIndex(dense);
+    SpatialIndex clusterIndex(clustered);
+    check(latticeIndex.kind() == SpatialIndex::Kind::Grid && SpatialIndex(latticePoints(10)).kind() == SpatialIndex::Kind::Tree &&
+        clusterIndex.kind() == SpatialIndex::Kind::Tree, "SpatialIndex picks by count and occupancy");
+    check(nearlyEqual(distancesOf(dense, dense[77], latticeIndex.findKNearest(dense[77], 7)),
+        distancesOf(dense, dense[77], bruteForceKNearest(dense, dense[77], 7))), "grid-backed SpatialIndex answers queries");
+    check(clusterIndex.findKNearest(clustered[5], 5) == KDTree(clustered).findKNearest(clustered[5], 5), "SpatialIndex forwards queries");
+
+    // Refit chooses again: the lattice squeezed into a corner with one point left far out
+    // no longer fills the grid, and spread out again it does
+    std::vector<Point> squeezed = dense;
+    for (Point& p : squeezed) {
+        p.x *= 0.01, p.y *= 0.01, p.z *= 0.01;
+    }
+    squeezed.back().x = 1000.0;
+    latticeIndex.refit(squeezed);
+    bool rechosen = latticeIndex.kind() == SpatialIndex::Kind::Tree &&
+        nearlyEqual(distancesOf(squeezed, squeezed[77], latticeIndex.findKNearest(squeezed[77], 7)),
+            distancesOf(squeezed, squeezed[77], bruteForceKNearest(squeezed, squeezed[77], 7)));
+    latticeIndex.refit(dense);
+    rechosen = rechosen && latticeIndex.kind() == SpatialIndex::Kind::Grid &&
+        nearlyEqual(distancesOf(dense, dense[77], latticeIndex.findKNearest(dense[77], 7)),
+            distancesOf(dense, dense[77], bruteForceKNearest(dense, dense[77], 7)));
+    check(rechosen, "SpatialIndex refit re-chooses the kind");
+    std::cout << "UniformGrid and SpatialIndex checked\n";
+}
+
+void testBruteForceKNN() {
+    std::mt19937 rng(67);
+    std::uniform_real_distribution<double> value(-150.0, 150.0);
+    BruteForceKNN::QueryContext context;
+    BruteForceKNN::Neighbor found[BruteForceKNN::MAX_K];
+    std::vector<BruteForceKNN::Neighbor> within;
+    bool knnOk = true;
+    bool radiusOk = true;
+    // Sizes around the scan's groups of eight, and duplicates
+    for (int n : { 1, 3, 7, 8, 9, 16, 17, 100, 700 }) {
+        std::vector<Point> points = randomPoints(rng, n);
+        if (n > 4) {
+            points[3] = { points[1].x, points[1].y, points[1].z, 3 };
+        }
+        BruteForceKNN brute(points);
+        knnOk = knnOk && brute.size() == points.size();
+        for (int q = 0; q < 60; ++q) {
+            Point target = q % 2 == 0 ? Point{ value(rng), value(rng), value(rng), -1 } : points[q % points.size()];
+            for (int k : { 1, 4, 16, 40 }) {
+                std::vector<int> expected = bruteForceKNearest(points, target, k);
+                knnOk = knnOk && nearlyEqual(distancesOf(points, target, brute.findKNearest(target, k)), distancesOf(points, target, expected));
+            }
+            int count = brute.findKNearest(target, 8, context, found);
+            std::vector<int> expected = bruteForceKNearest(points, target, 8);
+            knnOk = knnOk && count == static_cast<int>(expected.size()) &&
+                nearlyEqual(found[count - 1].distanceSquared, target.distanceSquared(points[expected.back()]));
+            for (double radius : { 0.0, 20.0, 90.0 }) {
+                std::vector<int> inside = bruteForceWithinRadius(points, target, radius);
+                brute.findWithinRadius(target, radius, within);
+                std::vector<int> got = indicesOf(within.data(), within.data() + within.size());
+                std::sort(got.begin(), got.end());
+                std::sort(inside.begin(), inside.end());
+                radiusOk = radiusOk && got == inside && brute.countWithinRadius(target, radius) == inside.size();
+            }
+        }
+    }
+    check(knnOk, "BruteForceKNN kNN matches brute force");
+    check(radiusOk, "BruteForceKNN radius queries match brute force");
+
+    std::vector<Point> points = randomPoints(rng, 300);
+    std::vector<Point> queries = randomPoints(rng, 1000);
+    BruteForceKNN brute(points);
+    const int k = 5;
+    std::vector<int> indices(queries.size() * k);
+    brute.findKNearestBatch(queries.data(), queries.size(), k, indices.data(), nullptr);
+    bool batchOk = true;
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        batchOk = batchOk && std::vector<int>(indices.begin() + i * k, indices.begin() + (i + 1) * k) == brute.findKNearest(queries[i], k);
+    }
+    BruteForceKNN::RadiusResult result;
+    brute.findWithinRadiusBatch(queries.data(), queries.size(), 30.0, result);
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        brute.findWithinRadius(queries[i], 30.0, within);
+        batchOk = batchOk && result.offsets[i + 1] - result.offsets[i] == within.size() &&
+            std::equal(within.begin(), within.end(), result.neighbors.begin() + result.offsets[i],
+                [](const BruteForceKNN::Neighbor& a, const BruteForceKNN::Neighbor& b) { return a.index == b.index; });
+    }
+    check(batchOk, "BruteForceKNN batches match single queries");
+    check(BruteForceKNN(std::vector<Point>()).findKNearest(points[0], 3).empty(), "empty BruteForceKNN finds nothing");
+
+    // The selector keeps even the smallest cages in the tree, and refit moves the points of
+    // every kind
+    std::vector<Point> cage = randomPoints(rng, 8);
+    check(SpatialIndex(cage).kind() == SpatialIndex::Kind::Tree && SpatialIndex(std::vector<Point>()).kind() == SpatialIndex::Kind::Tree,
+        "SpatialIndex never picks the scan");
+    bool refitOk = true;
+    for (SpatialIndex::Kind kind : { SpatialIndex::Kind::BruteForce, SpatialIndex::Kind::Tree, SpatialIndex::Kind::Grid }) {
+        SpatialIndex index(cage, kind);
+        std::vector<Point> moved = cage;
+        for (Point& p : moved) {
+            p.x += 500.0;
+        }
+        index.refit(moved);
+        refitOk = refitOk && index.kind() == kind && index.findKNearest(moved[2], 1) == std::vector<int>{ 2 };
+    }
+    check(refitOk, "SpatialIndex refit moves the points");
+    std::cout << "BruteForceKNN checked\n";
+}
 
-        std::vector<int> indices;
-        while (!maxHeap.empty()) {
-            indices.push_back(maxHeap.top().second);
-            maxHeap.pop();
+template <int Dim, typename Scalar>
+std::vector<PointND<Dim, Scalar>> randomPointsND(std::mt19937& rng, int n) {
+    std::uniform_real_distribution<Scalar> value(-1, 1);
+    std::vector<PointND<Dim, Scalar>> points(n);
+    for (int i = 0; i < n; ++i) {
+        for (int a = 0; a < Dim; ++a) {
+            points[i].coords[a] = value(rng);
         }
-        std::reverse(indices.begin(), indices.end());
-        return indices;
+        points[i].index = i;
     }
+    return points;
+}
 
-private:
-    KDNode* root;
+// Sorted squared distances from target to the points with these indices
+template <int Dim, typename Scalar>
+std::vector<Scalar> distancesOfND(const std::vector<PointND<Dim, Scalar>>& points, const PointND<Dim, Scalar>& target,
+    const std::vector<int>& indices) {
+    std::vector<Scalar> d2;
+    for (int index : indices) {
+        d2.push_back(target.distanceSquared(points[index]));
+    }
+    std::sort(d2.begin(), d2.end());
+    return d2;
+}
 
-    // Build the KD-Tree using iterators and nth_element for better performance
-    KDNode* buildTree(std::vector<Point>::iterator start, std::vector<Point>::iterator end, int depth) {
-        if (start >= end) return nullptr;
+// KDTreeND against brute force: kNN, radius and batch queries in Dim dimensions
+template <int Dim, typename Scalar>
+bool checkKDTreeND(std::mt19937& rng, int n, int leafSize) {
+    using Tree = KDTreeND<Dim, Scalar>;
+    using P = PointND<Dim, Scalar>;
+    std::vector<P> points = randomPointsND<Dim, Scalar>(rng, n);
+    std::vector<P> targets = randomPointsND<Dim, Scalar>(rng, 60);
+    for (int i = 0; i < 20; ++i) {
+        targets.push_back(points[(i * 37) % n]); // On a point
+    }
+    Tree tree(points, leafSize);
+    bool ok = tree.size() == points.size();
 
-        int axis = depth % 3;
-        auto comparator = [axis](const Point& a, const Point& b) {
-            return (axis == 0) ? (a.x < b.x) : (axis == 1) ? (a.y < b.y) : (a.z < b.z);
-            };
+    typename Tree::QueryContext context;
+    typename Tree::Neighbor found[Tree::MAX_K];
+    std::vector<typename Tree::Neighbor> within;
+    for (const P& target : targets) {
+        std::vector<std::pair<Scalar, int>> all;
+        for (const P& p : points) {
+            all.emplace_back(target.distanceSquared(p), p.index);
+        }
+        std::sort(all.begin(), all.end());
+        for (int k : { 1, 5, 40 }) {
+            std::vector<Scalar> expected;
+            for (int i = 0; i < k && i < n; ++i) {
+                expected.push_back(all[i].first);
+            }
+            ok = ok && nearlyEqual(distancesOfND(points, target, tree.findKNearest(target, k)), expected);
+        }
+        int count = tree.findKNearest(target, 8, context, found);
+        ok = ok && count == std::min(8, n) && nearlyEqual(found[count - 1].distanceSquared, all[count - 1].first);
 
-        auto medianIt = start + (end - start) / 2;
-        std::nth_element(start, medianIt, end, comparator);
+        const Scalar radius = static_cast<Scalar>(0.35 * std::sqrt(static_cast<double>(Dim)));
+        std::size_t inside = 0;
+        while (inside < all.size() && all[inside].first <= radius * radius) {
+            ++inside;
+        }
+        tree.findWithinRadius(target, radius, within);
+        ok = ok && within.size() == inside && tree.countWithinRadius(target, radius) == inside;
+        for (std::size_t i = 0; i < within.size(); ++i) {
+            ok = ok && nearlyEqual(within[i].distanceSquared, all[i].first);
+        }
+        tree.findWithinRadius(target, radius, within, 3);
+        ok = ok && within.size() == std::min<std::size_t>(3, inside);
+    }
 
-        KDNode* node = new KDNode(*medianIt);
-        node->left = buildTree(start, medianIt, depth + 1);
-        node->right = buildTree(medianIt + 1, end, depth + 1);
+    const int k = 6;
+    std::vector<int> indices(targets.size() * k);
+    std::vector<Scalar> distances(targets.size() * k);
+    tree.findKNearestBatch(targets.data(), targets.size(), k, indices.data(), distances.data());
+    for (std::size_t i = 0; i < targets.size(); ++i) {
+        std::vector<int> row(indices.begin() + i * k, indices.begin() + (i + 1) * k);
+        row.erase(std::remove(row.begin(), row.end(), -1), row.end()); // Padding past n
+        ok = ok && nearlyEqual(distancesOfND(points, targets[i], row), distancesOfND(points, targets[i], tree.findKNearest(targets[i], k)));
+    }
+    return ok;
+}
 
-        return node;
+void testKDTreeND() {
+    std::mt19937 rng(53);
+    bool ok = true;
+    for (int leafSize : { 1, 16 }) {
+        for (int n : { 1, 9, 3000 }) {
+            ok = ok && checkKDTreeND<1, double>(rng, n, leafSize);
+            ok = ok && checkKDTreeND<4, double>(rng, n, leafSize);
+            ok = ok && checkKDTreeND<7, float>(rng, n, leafSize);
+            ok = ok && checkKDTreeND<12, double>(rng, n, leafSize);
+        }
     }
+    check(ok, "KDTreeND matches brute force in 1, 4, 7 and 12 dimensions");
 
-    // Optimized k-nearest neighbor search
-    void findKNearest(KDNode* node, const Point& target, int k, int depth,
-        std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, Compare>& maxHeap) {
-        if (!node) return;
+    // Three dimensions answer like KDTree
+    std::vector<Point> points = randomPoints(rng, 5000);
+    std::vector<PointND<3>> same(points.size());
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        same[i] = { { points[i].x, points[i].y, points[i].z }, points[i].index };
+    }
+    KDTree tree(points);
+    KDTreeND<3> treeND(same);
+    bool sameOk = true;
+    for (int q = 0; q < 200; ++q) {
+        const Point& p = points[(q * 131) % points.size()];
+        Point target = { p.x + 0.5, p.y - 0.25, p.z, -1 };
+        PointND<3> targetND = { { target.x, target.y, target.z }, -1 };
+        sameOk = sameOk && nearlyEqual(distancesOf(points, target, tree.findKNearest(target, 9)),
+            distancesOf(points, target, treeND.findKNearest(targetND, 9)));
+        sameOk = sameOk && tree.countWithinRadius(target, 15.0) == treeND.countWithinRadius(targetND, 15.0);
+    }
+    check(sameOk, "KDTreeND<3> agrees with KDTree");
+    check(KDTreeND<5>(std::vector<PointND<5>>()).findKNearest(PointND<5>{ {}, -1 }, 3).empty(), "empty KDTreeND finds nothing");
+    std::cout << "KDTreeND checked\n";
+}
+
+// Sorted squared distances from vertex v to every other vertex
+std::vector<double> otherDistances(const std::vector<Point>& vertices, std::size_t v) {
+    std::vector<double> d2;
+    for (std::size_t u = 0; u < vertices.size(); ++u) {
+        if (u != v) {
+            d2.push_back(vertices[v].distanceSquared(vertices[u]));
+        }
+    }
+    std::sort(d2.begin(), d2.end());
+    return d2;
+}
+
+bool sameGraph(const KNNGraph& a, const KNNGraph& b) {
+    return a.offsets() == b.offsets() && a.neighbors() == b.neighbors() && a.distances() == b.distances();
+}
+
+void testKNNGraph() {
+    std::mt19937 rng(73);
+    bool knnOk = true;
+    bool symmetricOk = true;
+    for (int n : { 1, 2, 5, 9, 33, 2000 }) {
+        std::vector<Point> vertices = randomPoints(rng, n);
+        if (n > 4) {
+            vertices[3] = { vertices[1].x, vertices[1].y, vertices[1].z, 3 }; // A seam vertex
+        }
+        for (int k : { 1, 4, 8, 40 }) {
+            const std::size_t kk = std::min<std::size_t>(k, n - 1);
+            KNNGraph graph(vertices, k, false, 3);
+            knnOk = knnOk && graph.size() == vertices.size() && graph.edgeCount() == vertices.size() * kk;
+            for (std::size_t v = 0; v < graph.size() && knnOk; ++v) {
+                std::vector<double> expected = otherDistances(vertices, v);
+                expected.resize(kk);
+                std::vector<double> got;
+                for (std::size_t j = 0; j < graph.degree(v); ++j) {
+                    const int u = graph.neighborsOf(v)[j];
+                    knnOk = knnOk && u != static_cast<int>(v) &&
+                        nearlyEqual(graph.distancesOf(v)[j], std::sqrt(vertices[v].distanceSquared(vertices[u])));
+                    got.push_back(vertices[v].distanceSquared(vertices[u]));
+                }
+                knnOk = knnOk && nearlyEqual(got, expected);
+            }
+            if (n > 4) {
+                knnOk = knnOk && graph.neighborsOf(1)[0] == 3 && graph.distancesOf(1)[0] == 0.0;
+            }
 
-        double dist = target.distance(node->point);
-        if (maxHeap.size() < k) {
-            maxHeap.emplace(dist, node->point.index);
+            KNNGraph symmetric(vertices, k, true, 3);
+            for (std::size_t v = 0; v < symmetric.size(); ++v) {
+                const int* row = symmetric.neighborsOf(v);
+                const std::size_t degree = symmetric.degree(v);
+                symmetricOk = symmetricOk && std::is_sorted(symmetric.distancesOf(v), symmetric.distancesOf(v) + degree);
+                for (std::size_t j = 0; j < degree; ++j) {
+                    const int* back = symmetric.neighborsOf(row[j]);
+                    symmetricOk = symmetricOk && std::count(row, row + degree, row[j]) == 1 &&
+                        std::count(back, back + symmetric.degree(row[j]), static_cast<int>(v)) == 1;
+                }
+                for (std::size_t j = 0; j < graph.degree(v); ++j) {
+                    symmetricOk = symmetricOk && std::count(row, row + degree, graph.neighborsOf(v)[j]) == 1;
+                }
+            }
         }
-        else if (dist < maxHeap.top().first) {
-            maxHeap.pop();
-            maxHeap.emplace(dist, node->point.index);
+    }
+    check(knnOk, "KNNGraph rows match brute force without the vertex itself");
+    check(symmetricOk, "symmetric KNNGraph holds every edge both ways");
+
+    std::vector<Point> vertices = randomPoints(rng, 20000);
+    bool threadsOk = true;
+    for (bool symmetric : { false, true }) {
+        KNNGraph serial(vertices, 6, symmetric, 1);
+        for (unsigned threads : { 2u, 5u }) {
+            threadsOk = threadsOk && sameGraph(serial, KNNGraph(vertices, 6, symmetric, threads));
         }
+    }
+    check(threadsOk, "KNNGraph does not depend on the thread count");
 
-        int axis = depth % 3;
-        double diff = (axis == 0 ? target.x - node->point.x :
-            (axis == 1 ? target.y - node->point.y :
-                target.z - node->point.z));
+    // A vertex with no position gets no neighbours and is nobody's neighbour
+    vertices.resize(50);
+    vertices[7].x = std::numeric_limits<double>::quiet_NaN();
+    KNNGraph graph(vertices, 4, true);
+    bool nanOk = graph.degree(7) == 0;
+    for (std::size_t v = 0; v < graph.size(); ++v) {
+        nanOk = nanOk && (v == 7 || graph.degree(v) >= 4) &&
+            std::count(graph.neighborsOf(v), graph.neighborsOf(v) + graph.degree(v), 7) == 0;
+    }
+    check(nanOk, "KNNGraph skips a NaN vertex");
+    check(KNNGraph(std::vector<Point>(), 4).size() == 0 && KNNGraph(vertices, 0).edgeCount() == 0,
+        "empty KNNGraph has no edges");
+    std::cout << "KNNGraph checked\n";
+}
 
-        KDNode* first = (diff < 0) ? node->left : node->right;
-        KDNode* second = (diff < 0) ? node->right : node->left;
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
 
-        findKNearest(first, target, k, depth + 1, maxHeap);
+// Recall of the k = 4 binding query against its cost, on cage-sized trees
+void approximateBenchmark(int queries) {
+    std::mt19937 rng(5);
+    std::vector<Point> targets = randomPoints(rng, queries);
+    const KDTree::SearchBudget budgets[] = { { 0.0, 0 }, { 0.5, 0 }, { 1.0, 0 }, { 2.0, 0 }, { 0.0, 8 }, { 0.0, 4 }, { 0.0, 2 },
+        { 0.0, 1 }, { 1.0, 2 } };
+    const int k = 4;
+    for (int cage : { 500, 5000, 50000 }) {
+        std::vector<Point> points = randomPoints(rng, cage);
+        KDTree tree(points);
+        std::vector<int> exact(targets.size() * k);
+        tree.findKNearestBatch(targets.data(), targets.size(), k, exact.data(), nullptr);
+        std::printf("cage %d points, k=%d\n  epsilon  leaves   ns/query   recall   inexact\n", cage, k);
 
-        if (maxHeap.size() < k || std::abs(diff) < maxHeap.top().first) {
-            findKNearest(second, target, k, depth + 1, maxHeap);
+        KDTree::QueryContext context;
+        KDTree::Neighbor found[k];
+        for (const KDTree::SearchBudget& budget : budgets) {
+            std::size_t hits = 0;
+            std::size_t inexact = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < targets.size(); ++i) {
+                KDTree::ApproximateResult result = tree.findKNearest(targets[i], k, budget, context, found);
+                inexact += result.exact ? 0 : 1;
+                for (int j = 0; j < result.count; ++j) {
+                    hits += std::count(exact.begin() + i * k, exact.begin() + (i + 1) * k, found[j].index);
+                }
+            }
+            double perQuery = secondsSince(start) * 1e9 / queries;
+            std::printf("  %7.1f  %6d   %8.0f   %5.1f%%   %6.1f%%\n", budget.epsilon, budget.maxLeaves, perQuery,
+                100.0 * hits / exact.size(), 100.0 * inexact / targets.size());
         }
     }
-};
+}
+
+// Closest point on a torus per leaf size, against scoring every triangle
+void bvhBenchmark(int queries) {
+    std::vector<Point> vertices;
+    std::vector<int> triangles;
+    torusMesh(256, 128, vertices, triangles);
+    // Queries near the surface, like the vertices of a mesh wrapped around it
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> offset(-0.5, 0.5);
+    std::vector<Point> targets(queries);
+    for (int i = 0; i < queries; ++i) {
+        const Point& v = vertices[(i * 7919) % vertices.size()];
+        targets[i] = { v.x + offset(rng), v.y + offset(rng), v.z + offset(rng), -1 };
+    }
+    std::printf("torus %zu triangles\nleaf  build ms   ns/query   batch ns/query\n", triangles.size() / 3);
+    for (int leafSize : { 1, 4, 8 }) {
+        auto start = std::chrono::steady_clock::now();
+        TriangleBVH bvh(vertices, triangles, leafSize);
+        double build = secondsSince(start);
+        volatile double sink = 0;
+        start = std::chrono::steady_clock::now();
+        for (const Point& t : targets) {
+            sink = sink + bvh.closestPoint(t).distance;
+        }
+        double single = secondsSince(start) * 1e9 / queries;
+        std::vector<TriangleBVH::SurfacePoint> hits(targets.size());
+        start = std::chrono::steady_clock::now();
+        bvh.closestPoints(targets.data(), targets.size(), hits.data());
+        std::printf("%4d  %8.1f   %8.0f   %14.0f\n", leafSize, build * 1e3, single, secondsSince(start) * 1e9 / queries);
+    }
+
+    const int bruteQueries = std::min(queries, 200);
+    auto start = std::chrono::steady_clock::now();
+    volatile double sink = 0;
+    for (int i = 0; i < bruteQueries; ++i) {
+        for (std::size_t t = 0; t < triangles.size(); t += 3) {
+            double v, w;
+            closestOnTriangle(targets[i], vertices[triangles[t]], vertices[triangles[t + 1]], vertices[triangles[t + 2]], v, w);
+            sink = sink + v;
+        }
+    }
+    std::printf("brute force %8.0f ns/query\n", secondsSince(start) * 1e9 / bruteQueries);
+}
+
+// Batch queries in index order against Morton order, for the vertices of a tessellated torus
+// (rings in order) and of a scanned one (points in arbitrary order). The Morton times include
+// the sort.
+void mortonBenchmark(int n, int queries) {
+    std::vector<Point> driverVertices;
+    std::vector<int> driverTriangles;
+    int rings = std::max(static_cast<int>(std::sqrt(n / 2.0)), 3);
+    torusMesh(2 * rings, rings, driverVertices, driverTriangles);
+    KDTree tree(driverVertices);
+    TriangleBVH bvh(driverVertices, driverTriangles);
+
+    std::vector<Point> tessellated, scanned;
+    std::vector<int> unused;
+    rings = std::max(static_cast<int>(std::sqrt(queries / 2.0)), 3);
+    torusMesh(2 * rings, rings, tessellated, unused);
+    scanned = tessellated;
+    std::mt19937 rng(13);
+    std::shuffle(scanned.begin(), scanned.end(), rng);
+    std::printf("%zu driver points, %zu query vertices: ns/query\n", driverVertices.size(), tessellated.size());
+    std::printf("mesh          kNN k=8 index  Morton   closest point index  Morton\n");
+
+    const int k = 8;
+    std::vector<int> indices(tessellated.size() * k);
+    std::vector<TriangleBVH::SurfacePoint> hits(tessellated.size());
+    for (const std::vector<Point>* mesh : { &tessellated, &scanned }) {
+        double perQuery[4];
+        int column = 0;
+        for (KDTree::QueryOrder order : { KDTree::QueryOrder::Input, KDTree::QueryOrder::Morton }) {
+            auto start = std::chrono::steady_clock::now();
+            tree.findKNearestBatch(mesh->data(), mesh->size(), k, indices.data(), nullptr, order);
+            perQuery[column] = secondsSince(start) * 1e9 / mesh->size();
+            start = std::chrono::steady_clock::now();
+            bvh.closestPoints(mesh->data(), mesh->size(), hits.data(), std::numeric_limits<double>::infinity(), order);
+            perQuery[column + 2] = secondsSince(start) * 1e9 / mesh->size();
+            ++column;
+        }
+        std::printf("%-12s  %13.0f  %6.0f   %19.0f  %6.0f\n", mesh == &tessellated ? "tessellated" : "scanned",
+            perQuery[0], perQuery[1], perQuery[2], perQuery[3]);
+    }
+}
+
+// UniformGrid against KDTree on cage-like point sets, with the occupancy SpatialIndex
+// chooses by
+void gridBenchmark(int queries) {
+    std::mt19937 rng(17);
+    struct Set {
+        const char* name;
+        std::vector<Point> points;
+    };
+    std::vector<Set> sets;
+    sets.push_back({ "lattice 3^3", latticePoints(3) });
+    sets.push_back({ "lattice 10^3", latticePoints(10) });
+    sets.push_back({ "lattice 24^3", latticePoints(24) });
+    sets.push_back({ "lattice 50^3", latticePoints(50) });
+    sets.push_back({ "uniform 100k", randomPoints(rng, 100000) });
+    std::vector<Point> torus;
+    std::vector<int> unused;
+    torusMesh(400, 200, torus, unused);
+    sets.push_back({ "torus 80k", torus });
+    std::vector<Point> clustered = randomPoints(rng, 100000);
+    std::normal_distribution<double> spread(0.0, 1.0);
+    for (Point& p : clustered) {
+        p = { p.x * 0.01 + spread(rng), p.y * 0.01 + spread(rng), p.z * 0.01 + spread(rng), p.index };
+    }
+    clustered[0] = { 500.0, 500.0, 500.0, 0 };
+    sets.push_back({ "clustered 100k", clustered });
+
+    std::printf("set             occupancy  pick   build us tree/grid   k=4 ns tree/grid   r ns tree/grid\n");
+    for (const Set& set : sets) {
+        // Queries near the points, as binding queries are
+        std::vector<Point> targets(queries);
+        std::uniform_real_distribution<double> offset(-0.5, 0.5);
+        for (int i = 0; i < queries; ++i) {
+            const Point& p = set.points[(i * 7919) % set.points.size()];
+            targets[i] = { p.x + offset(rng), p.y + offset(rng), p.z + offset(rng), -1 };
+        }
+        auto start = std::chrono::steady_clock::now();
+        KDTree tree(set.points);
+        double treeBuild = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        UniformGrid grid(set.points);
+        double gridBuild = secondsSince(start);
+
+        std::vector<int> indices(targets.size() * 4);
+        start = std::chrono::steady_clock::now();
+        tree.findKNearestBatch(targets.data(), targets.size(), 4, indices.data(), nullptr);
+        double treeKnn = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        grid.findKNearestBatch(targets.data(), targets.size(), 4, indices.data(), nullptr);
+        double gridKnn = secondsSince(start);
+
+        volatile std::size_t sink = 0;
+        start = std::chrono::steady_clock::now();
+        for (const Point& t : targets) {
+            sink = sink + tree.countWithinRadius(t, 1.5);
+        }
+        double treeRadius = secondsSince(start);
+        start = std::chrono::steady_clock::now();
+        for (const Point& t : targets) {
+            sink = sink + grid.countWithinRadius(t, 1.5);
+        }
+        double gridRadius = secondsSince(start);
+
+        std::printf("%-14s  %9.2f  %-5s  %9.0f %9.0f  %8.0f %8.0f  %7.0f %7.0f\n", set.name, UniformGrid::occupancy(set.points),
+            SpatialIndex::choose(set.points) == SpatialIndex::Kind::Grid ? "grid" : "tree", treeBuild * 1e6, gridBuild * 1e6,
+            treeKnn * 1e9 / queries, gridKnn * 1e9 / queries, treeRadius * 1e9 / queries, gridRadius * 1e9 / queries);
+    }
+}
+
+// Tree against brute force on cage-sized sets; the scan only wins the build
+void bruteForceBenchmark(int queries) {
+    std::mt19937 rng(71);
+    std::printf("points   build ns tree/brute   k=4 ns tree/brute   k=8 ns tree/brute\n");
+    for (int n : { 8, 16, 32, 64, 128, 192, 256, 384, 512, 1024, 2048 }) {
+        std::vector<Point> points = randomPoints(rng, n);
+        std::vector<Point> targets = randomPoints(rng, queries);
+        const int builds = std::max(1, 200000 / n);
+        auto start = std::chrono::steady_clock::now();
+        for (int b = 0; b < builds; ++b) {
+            KDTree built(points, KDTree::BuildOptions{ KDTree::DEFAULT_LEAF_SIZE, KDTree::SplitRule::Median, 1 });
+        }
+        double treeBuild = secondsSince(start) / builds;
+        start = std::chrono::steady_clock::now();
+        for (int b = 0; b < builds; ++b) {
+            BruteForceKNN built(points);
+        }
+        double bruteBuild = secondsSince(start) / builds;
+
+        KDTree tree(points);
+        BruteForceKNN brute(points);
+        std::vector<int> indices(targets.size() * 8);
+        double perQuery[4];
+        for (int j = 0; j < 2; ++j) {
+            const int k = j == 0 ? 4 : 8;
+            start = std::chrono::steady_clock::now();
+            tree.findKNearestBatch(targets.data(), targets.size(), k, indices.data(), nullptr);
+            perQuery[2 * j] = secondsSince(start) * 1e9 / queries;
+            start = std::chrono::steady_clock::now();
+            brute.findKNearestBatch(targets.data(), targets.size(), k, indices.data(), nullptr);
+            perQuery[2 * j + 1] = secondsSince(start) * 1e9 / queries;
+        }
+        std::printf("%6d  %9.0f %9.0f  %8.0f %8.0f  %8.0f %8.0f\n", n, treeBuild * 1e9, bruteBuild * 1e9,
+            perQuery[0], perQuery[1], perQuery[2], perQuery[3]);
+    }
+}
+
+// Pose-space lookups: tree against a scan of every sample, in 4 (quaternion) to 12 dimensions
+template <int Dim>
+void poseBenchmark(std::mt19937& rng, int n, int queries) {
+    std::vector<PointND<Dim>> samples = randomPointsND<Dim, double>(rng, n);
+    std::vector<PointND<Dim>> targets = randomPointsND<Dim, double>(rng, queries);
+    auto start = std::chrono::steady_clock::now();
+    KDTreeND<Dim> tree(samples);
+    double build = secondsSince(start);
+    std::vector<int> indices(targets.size() * 4);
+    start = std::chrono::steady_clock::now();
+    tree.findKNearestBatch(targets.data(), targets.size(), 4, indices.data(), nullptr);
+    double treeKnn = secondsSince(start);
+
+    const int scanned = std::min(queries, 200);
+    volatile double sink = 0;
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < scanned; ++q) {
+        double best = std::numeric_limits<double>::infinity();
+        for (const PointND<Dim>& s : samples) {
+            best = std::min(best, targets[q].distanceSquared(s));
+        }
+        sink = sink + best;
+    }
+    double scan = secondsSince(start);
+    std::printf("%2d-D %7d samples: build %7.1f ms, k=4 %8.0f ns/query, scan %10.0f ns/query\n", Dim, n, build * 1e3,
+        treeKnn * 1e9 / queries, scan * 1e9 / scanned);
+}
+
+void poseBenchmarks(int queries) {
+    std::mt19937 rng(61);
+    for (int n : { 1000, 100000 }) {
+        poseBenchmark<4>(rng, n, queries);
+        poseBenchmark<6>(rng, n, queries);
+        poseBenchmark<12>(rng, n, queries);
+    }
+}
+
+// All-kNN graph of n vertices, serial and on every thread, plain and symmetric
+void knnGraphBenchmark(int n) {
+    std::mt19937 rng(79);
+    std::vector<Point> vertices = randomPoints(rng, n);
+    unsigned hw = std::thread::hardware_concurrency();
+    for (unsigned threads : { 1u, hw ? hw : 1u }) {
+        for (bool symmetric : { false, true }) {
+            auto start = std::chrono::steady_clock::now();
+            KNNGraph graph(vertices, 8, symmetric, threads);
+            std::printf("kNN graph %d vertices, k=8%s, %2u threads: %8.1f ms, %zu edges\n", n,
+                symmetric ? " symmetric" : "", threads, secondsSince(start) * 1e3, graph.edgeCount());
+        }
+    }
+}
+
+// Build and query cost per leaf size: kdtree --bench [points] [queries]
+void benchmark(int n, int queries) {
+    std::mt19937 rng(3);
+    std::vector<Point> points = randomPoints(rng, n);
+    std::vector<Point> targets = randomPoints(rng, queries);
+    std::cout << n << " points, " << queries << " queries\n";
+    std::cout << "leaf  build ms   k=4 ns/query   k=16 ns/query\n";
+    for (int leafSize : { 1, 4, 8, 12, 16, 24, 32, 48, 64 }) {
+        auto start = std::chrono::steady_clock::now();
+        KDTree tree(points, leafSize);
+        double build = secondsSince(start);
+
+        double perQuery[2];
+        volatile std::size_t sink = 0; // Keeps the queries from being optimized away
+        int ks[2] = { 4, 16 };
+        for (int j = 0; j < 2; ++j) {
+            start = std::chrono::steady_clock::now();
+            for (const Point& t : targets) {
+                sink = sink + tree.findKNearest(t, ks[j]).size();
+            }
+            perQuery[j] = secondsSince(start) * 1e9 / queries;
+        }
+        std::printf("%4d  %8.1f   %12.0f   %13.0f\n", leafSize, build * 1e3, perQuery[0], perQuery[1]);
+    }
+
+    // Build scaling: 1, 2, 4, ... threads up to the core count, speedup against one thread
+    unsigned hw = std::thread::hardware_concurrency();
+    std::vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < hw; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hw ? hw : 1u);
+    for (KDTree::SplitRule rule : { KDTree::SplitRule::Median, KDTree::SplitRule::Binned }) {
+        double serial = 0;
+        for (unsigned threads : threadCounts) {
+            KDTree::BuildOptions options;
+            options.split = rule;
+            options.threads = threads;
+            auto start = std::chrono::steady_clock::now();
+            KDTree built(points, options);
+            double build = secondsSince(start);
+            serial = threads == 1 ? build : serial;
+            start = std::chrono::steady_clock::now();
+            for (const Point& t : targets) {
+                built.findKNearest(t, 8);
+            }
+            std::printf("%s build, %2u threads: %8.1f ms (x%4.1f), k=8 %6.0f ns/query\n",
+                rule == KDTree::SplitRule::Median ? "median" : "binned", threads, build * 1e3, serial / build,
+                secondsSince(start) * 1e9 / queries);
+        }
+    }
+
+    KDTree tree(points);
+    KDTree::QueryContext context;
+    KDTree::Neighbor found[KDTree::MAX_K];
+    for (int k : { 4, 16 }) {
+        volatile int sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const Point& t : targets) {
+            sink = sink + tree.findKNearest(t, k, context, found);
+        }
+        std::printf("findKNearest(context) k=%-2d %8.0f ns/query\n", k, secondsSince(start) * 1e9 / queries);
+    }
+
+    std::vector<int> indices(targets.size() * 16);
+    std::vector<double> distances(targets.size() * 16);
+    for (int k : { 4, 16 }) {
+        auto start = std::chrono::steady_clock::now();
+        tree.findKNearestBatch(targets.data(), targets.size(), k, indices.data(), distances.data());
+        std::printf("findKNearestBatch k=%-2d %8.0f ns/query\n", k, secondsSince(start) * 1e9 / queries);
+    }
+    approximateBenchmark(queries);
+    bvhBenchmark(queries);
+    mortonBenchmark(n, queries);
+    gridBenchmark(queries);
+    poseBenchmarks(queries);
+    bruteForceBenchmark(queries);
+    knnGraphBenchmark(n);
+}
+
+} // namespace
+
+// Example usage, followed by the checks
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--bench") == 0) {
+        benchmark(argc > 2 ? std::atoi(argv[2]) : 1000000, argc > 3 ? std::atoi(argv[3]) : 200000);
+        return 0;
+    }
 
-// Example usage
-int main() {
     std::vector<Point> points = {
         {3.0, 6.0, 7.0, 0}, {17.0, 15.0, 13.0, 1}, {13.0, 15.0, 6.0, 2},
         {6.0, 12.0, 10.0, 3}, {9.0, 1.0, 2.0, 4}, {2.0, 7.0, 3.0, 5},
@@ -122,5 +1514,26 @@ int main() {
     }
     std::cout << std::endl;
 
+    testKNearest();
+    testSquaredDistances();
+    testKNearestBatch();
+    testKNearestContext();
+    testWithinRadius();
+    testParallelBuild();
+    testDynamic();
+    testFileImage();
+    testApproximate();
+    testTriangleBVH();
+    testMortonOrder();
+    testUniformGrid();
+    testKDTreeND();
+    testBruteForceKNN();
+    testKNNGraph();
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All KDTree checks passed\n";
     return 0;
 }
@@ -709,103 +709,7 @@
 
 //#include "thirdParty/KDTree/KDTree.hpp"
 
-struct Point {
-    double x, y, z;
-    int index;
-
-    // Calculate distance to another point
-    double distance(const Point& other) const {
-        return std::sqrt((x - other.x) * (x - other.x) +
-            (y - other.y) * (y - other.y) +
-            (z - other.z) * (z - other.z));
-    }
-};
-
-struct KDNode {
-    Point point;
-    KDNode* left;
-    KDNode* right;
-
-    KDNode(const Point& p) : point(p), left(nullptr), right(nullptr) {}
-};
-
-// Custom comparator for the max-heap
-struct Compare {
-    bool operator()(const std::pair<double, int>& a, const std::pair<double, int>& b) {
-        return a.first < b.first; // Max-heap: larger distance at the top
-    }
-};
-
-class KDTree {
-public:
-    KDTree(std::vector<Point>& points) {
-        root = buildTree(points.begin(), points.end(), 0);
-    }
-
-    std::vector<int> findKNearest(const Point& target, int k) {
-        std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, Compare> maxHeap;
-        findKNearest(root, target, k, 0, maxHeap);
-
-        std::vector<int> indices;
-        while (!maxHeap.empty()) {
-            indices.push_back(maxHeap.top().second);
-            maxHeap.pop();
-        }
-        std::reverse(indices.begin(), indices.end());
-        return indices;
-    }
-
-private:
-    KDNode* root;
-
-    // Build the KD-Tree using iterators and nth_element for better performance
-    KDNode* buildTree(std::vector<Point>::iterator start, std::vector<Point>::iterator end, int depth) {
-        if (start >= end) return nullptr;
-
-        int axis = depth % 3;
-        auto comparator = [axis](const Point& a, const Point& b) {
-            return (axis == 0) ? (a.x < b.x) : (axis == 1) ? (a.y < b.y) : (a.z < b.z);
-            };
-
-        auto medianIt = start + (end - start) / 2;
-        std::nth_element(start, medianIt, end, comparator);
-
-        KDNode* node = new KDNode(*medianIt);
-        node->left = buildTree(start, medianIt, depth + 1);
-        node->right = buildTree(medianIt + 1, end, depth + 1);
-
-        return node;
-    }
-
-    // Optimized k-nearest neighbor search
-    void findKNearest(KDNode* node, const Point& target, int k, int depth,
-        std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, Compare>& maxHeap) {
-        if (!node) return;
-
-        double dist = target.distance(node->point);
-        if (maxHeap.size() < k) {
-            maxHeap.emplace(dist, node->point.index);
-        }
-        else if (dist < maxHeap.top().first) {
-            maxHeap.pop();
-            maxHeap.emplace(dist, node->point.index);
-        }
-
-        int axis = depth % 3;
-        double diff = (axis == 0 ? target.x - node->point.x :
-            (axis == 1 ? target.y - node->point.y :
-                target.z - node->point.z));
-
-        KDNode* first = (diff < 0) ? node->left : node->right;
-        KDNode* second = (diff < 0) ? node->right : node->left;
-
-        findKNearest(first, target, k, depth + 1, maxHeap);
-
-        if (maxHeap.size() < k || std::abs(diff) < maxHeap.top().first) {
-            findKNearest(second, target, k, depth + 1, maxHeap);
-        }
-    }
-};
+#include "../KD_Tree/SpatialIndex.h"
 
 
 #pragma endregion
@@ -1379,7 +1283,7 @@ MStatus thuyWrapCmd::calBinding(MDagPath& pathBindingMesh, MDGModifier& dgMod)
         Point pt = { restPoints[i].x, restPoints[i].y, restPoints[i].z, i };
         points.push_back(pt);
     }
-    KDTree* tree = new KDTree(points);
+    SpatialIndex tree(points); // Grid for dense even drivers, KD-tree otherwise
 
     MPlug plugRestPoints(oWrapNode_, thuyPointDeformer::aRestPoints);
     CHECK_MSTATUS_AND_RETURN_IT(status);
@@ -1423,20 +1327,30 @@ MStatus thuyWrapCmd::calBinding(MDagPath& pathBindingMesh, MDGModifier& dgMod)
 
         bindData.weights.resize(bindData.inputPoints.length());
         bindData.boneIDs.resize(bindData.inputPoints.length());
-        
-        for (size_t i = 0; i < bindData.inputPoints.length(); ++i)
-        {
-            float weightSum = 0.0f;
 
-            //point_t pt = { bindData.inputPoints[i].x, bindData.inputPoints[i].y, bindData.inputPoints[i].z };
-            //auto clsPts = tree.nearest_indices(pt, maxInfluence);
+        // Closest rest points of every input point, queried in one batch across threads, in
+        // Morton order
+        const size_t inputCount = bindData.inputPoints.length();
+        const int influenceCount = std::min<int>(maxInfluence, static_cast<int>(tree.size()));
+        std::vector<Point> queries(inputCount);
+        for (size_t i = 0; i < inputCount; ++i)
+        {
+            queries[i] = { bindData.inputPoints[i].x, bindData.inputPoints[i].y, bindData.inputPoints[i].z, -1 };
+        }
+        std::vector<int> closestIndices(inputCount * influenceCount);
+        std::vector<double> closestDistances(inputCount * influenceCount);
+        tree.findKNearestBatch(queries.data(), inputCount, influenceCount, closestIndices.data(), closestDistances.data(),
+            SpatialIndex::QueryOrder::Morton);
 
-            Point pt = { bindData.inputPoints[i].x, bindData.inputPoints[i].y, bindData.inputPoints[i].z,-1 };
-            std::vector<int> clsPts = tree->findKNearest(pt, maxInfluence); 
+        for (size_t i = 0; i < inputCount; ++i)
+        {
+            float weightSum = 0.0f;
+            const int* clsPts = closestIndices.data() + i * influenceCount;
+            const double* clsDistances = closestDistances.data() + i * influenceCount;
 
-            for (size_t j = 0; j < clsPts.size(); ++j)
+            for (int j = 0; j < influenceCount; ++j)
             {
-                float distance = (bindData.inputPoints[i] - restPoints[clsPts[j]]).length();
+                float distance = static_cast<float>(clsDistances[j]);
                 // Compute the weight as the inverse of the distance
                 float _w = 1.0f / (distance + 1e-5f); // Adding a small value to avoid division by zero
                 bindData.weights[i].append(_w);
@@ -1562,5 +1476,7 @@ MStatus uninitializePlugin(MObject obj)
     // status = plugin.deregisterNode(RBFDeformerNode::id);
     // CHECK_MSTATUS_AND_RETURN_IT(status);
 
+    KDTree::stopThreadPool(); // Its threads cannot be joined once the plugin is unloading
+
     return MS::kSuccess;
 }
\ No newline at end of file
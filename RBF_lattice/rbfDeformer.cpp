@@ -22,106 +22,9 @@
 #include <queue>
 #include <cmath>
 #include <algorithm>
+#include <memory>
 
-struct Point {
-    double x, y, z;
-    int index;
-
-    // Calculate distance to another point
-    double distance(const Point& other) const {
-        return std::sqrt((x - other.x) * (x - other.x) +
-            (y - other.y) * (y - other.y) +
-            (z - other.z) * (z - other.z));
-    }
-};
-
-struct KDNode {
-    Point point;
-    KDNode* left;
-    KDNode* right;
-
-    KDNode(const Point& p) : point(p), left(nullptr), right(nullptr) {}
-};
-
-// Custom comparator for the max-heap
-struct Compare {
-    bool operator()(const std::pair<double, int>& a, const std::pair<double, int>& b) {
-        return a.first < b.first; // Max-heap: larger distance at the top
-    }
-};
-
-class KDTree {
-public:
-    KDTree(std::vector<Point>& points) {
-        root = buildTree(points.begin(), points.end(), 0);
-    }
-
-    std::vector<int> findKNearest(const Point& target, int k) {
-        std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, Compare> maxHeap;
-        findKNearest(root, target, k, 0, maxHeap);
-
-        std::vector<int> indices;
-        while (!maxHeap.empty()) {
-            indices.push_back(maxHeap.top().second);
-            maxHeap.pop();
-        }
-        std::reverse(indices.begin(), indices.end());
-        return indices;
-    }
-
-private:
-    KDNode* root;
-
-    // Build the KD-Tree using iterators and nth_element for better performance
-    KDNode* buildTree(std::vector<Point>::iterator start, std::vector<Point>::iterator end, int depth) {
-        if (start >= end) return nullptr;
-
-        int axis = depth % 3;
-        auto comparator = [axis](const Point& a, const Point& b) {
-            return (axis == 0) ? (a.x < b.x) : (axis == 1) ? (a.y < b.y) : (a.z < b.z);
-            };
-
-        auto medianIt = start + (end - start) / 2;
-        std::nth_element(start, medianIt, end, comparator);
-
-        KDNode* node = new KDNode(*medianIt);
-        node->left = buildTree(start, medianIt, depth + 1);
-        node->right = buildTree(medianIt + 1, end, depth + 1);
-
-        return node;
-    }
-
-    // Optimized k-nearest neighbor search
-    void findKNearest(KDNode* node, const Point& target, int k, int depth,
-        std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, Compare>& maxHeap) {
-        if (!node) return;
-
-        double dist = target.distance(node->point);
-        if (maxHeap.size() < k) {
-            maxHeap.emplace(dist, node->point.index);
-        }
-        else if (dist < maxHeap.top().first) {
-            maxHeap.pop();
-            maxHeap.emplace(dist, node->point.index);
-        }
-
-        int axis = depth % 3;
-        double diff = (axis == 0 ? target.x - node->point.x :
-            (axis == 1 ? target.y - node->point.y :
-                target.z - node->point.z));
-
-        KDNode* first = (diff < 0) ? node->left : node->right;
-        KDNode* second = (diff < 0) ? node->right : node->left;
-
-        findKNearest(first, target, k, depth + 1, maxHeap);
-
-        if (maxHeap.size() < k || std::abs(diff) < maxHeap.top().first) {
-            findKNearest(second, target, k, depth + 1, maxHeap);
-        }
-    }
-};
-
-
+#include "../KD_Tree/SpatialIndex.h"
 
 class RBFDeformerNode : public MPxDeformerNode {
 public:
@@ -130,6 +33,7 @@ public:
     static MObject aControlMesh;
     static MObject aControlMeshTransform;
     static MObject aMaxInfluence;
+    static MObject aPreviewBind;
     static MObject aClosestIndices;
     static MObject aWeightBasedClosestIndices;
 
@@ -152,7 +56,6 @@ public:
     virtual MStatus setDependentsDirty(const MPlug& plug, MPlugArray& plugArray) override;
     MStatus deform(MDataBlock& dataBlock, MItGeometry& iter,
         const MMatrix& localToWorldMatrix, unsigned int geomIndex) override;
-    std::vector<int> getNClosestControlPoints(int vertexIndex, int n, const Eigen::MatrixXd& vertices, const Eigen::MatrixXd& controlPoints);
     ~RBFDeformerNode();
 private:
     //bool controlMeshChanged = false;
@@ -175,7 +78,7 @@ private:
     Eigen::MatrixXd weightsMatrixOrig;
     bool epsilonUpdated = true;
     bool maxInfluentUpdated = true;
-    KDTree* tree;
+    std::unique_ptr<SpatialIndex> tree; // Grid or KD-tree, by cage size and layout
 
 
 };
@@ -185,6 +88,7 @@ MObject RBFDeformerNode::aEpsilon;
 MObject RBFDeformerNode::aControlMesh;
 MObject RBFDeformerNode::aControlMeshTransform;
 MObject RBFDeformerNode::aMaxInfluence;
+MObject RBFDeformerNode::aPreviewBind;
 MObject RBFDeformerNode::aClosestIndices;
 MObject RBFDeformerNode::aWeightBasedClosestIndices;
 MStatus RBFDeformerNode::initialize()
@@ -237,6 +141,14 @@ MStatus RBFDeformerNode::initialize()
     // Attribute affects
     attributeAffects(aMaxInfluence, outputGeom);
 
+    // Preview bind attribute: approximate closest control points while tweaking, exact when turned off
+    aPreviewBind = nAttr.create("previewBind", "pvBind", MFnNumericData::kBoolean, false, &status);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    nAttr.setStorable(true);
+    nAttr.setKeyable(true);
+    addAttribute(aPreviewBind);
+    attributeAffects(aPreviewBind, outputGeom);
+
     // Create the integer array attribute
     aClosestIndices = tAttr.create("closestIndices", "cidx", MFnData::kIntArray, MObject::kNullObj, &status);
     CHECK_MSTATUS_AND_RETURN_IT(status);
@@ -353,7 +265,7 @@ MStatus RBFDeformerNode::setDependentsDirty(const MPlug& plug, MPlugArray& plugA
     {
         epsilonUpdated = true;
     }
-    if (plug == aMaxInfluence && hasControlMesh)
+    if ((plug == aMaxInfluence || plug == aPreviewBind) && hasControlMesh)
     {
         maxInfluentUpdated = true;
     }
@@ -415,7 +327,8 @@ MStatus RBFDeformerNode::deform(MDataBlock& dataBlock, MItGeometry& iter,
         {
             restControlPoints[i] = { mayaRestControlPoints[i].x, mayaRestControlPoints[i].y, mayaRestControlPoints[i].z, i };
         }
-        tree=new KDTree(restControlPoints);
+        // The control mesh was reconnected, possibly to another mesh: index its points afresh
+        tree = std::make_unique<SpatialIndex>(restControlPoints);
         enableRecalcualte = false;
     }
     
@@ -431,6 +344,7 @@ MStatus RBFDeformerNode::deform(MDataBlock& dataBlock, MItGeometry& iter,
 
         // Retrieve maxInfluence value
         int maxInfluence = dataBlock.inputValue(aMaxInfluence, &status).asInt();
+        maxInfluence = std::min(maxInfluence, static_cast<int>(tree->size()));
         int vertexNumber = mayaRestVertices.length();
         CHECK_MSTATUS_AND_RETURN_IT(status);
 
@@ -445,17 +359,38 @@ MStatus RBFDeformerNode::deform(MDataBlock& dataBlock, MItGeometry& iter,
 
 
 
-        //for (unsigned int i = 0; i < vertexNumber; ++i)
+        // Get the closest control points of every vertex in one batch, spread across threads and
+        // run in Morton order, since vertex order is often spatially incoherent
+        std::vector<Point> targets;
+        targets.reserve(iter.count());
         for (; !iter.isDone(); iter.next())
         {
-            unsigned ptindex = iter.index();
             MPoint pt = iter.position();
+            targets.push_back({ pt.x, pt.y, pt.z, -1 });
+        }
+        iter.reset();
+        std::vector<int> closestIndices(targets.size() * maxInfluence);
+        std::vector<double> closestDistances(targets.size() * maxInfluence);
+        if (dataBlock.inputValue(aPreviewBind, &status).asBool())
+        {
+            // Neighbours within 1.5x of the true distance and at most 8 leaves per vertex;
+            // turning previewBind off rebinds exactly
+            SpatialIndex::SearchBudget budget{ 0.5, 8 };
+            tree->findKNearestBatch(targets.data(), targets.size(), maxInfluence, budget, closestIndices.data(), closestDistances.data(),
+                SpatialIndex::QueryOrder::Morton);
+        }
+        else
+        {
+            tree->findKNearestBatch(targets.data(), targets.size(), maxInfluence, closestIndices.data(), closestDistances.data(),
+                SpatialIndex::QueryOrder::Morton);
+        }
 
-
-            // Get the closest control points for the current vertex
-            //std::vector<int> indexInfluent = getNClosestControlPoints(ptindex, maxInfluence, eigenRestVertices, RestEigenControlPoints);
-            Point target = { pt.x,pt.y,pt.z,-1 };
-            std::vector<int> indexInfluent = tree->findKNearest(target, maxInfluence); 
+        //for (unsigned int i = 0; i < vertexNumber; ++i)
+        for (size_t i = 0; !iter.isDone(); iter.next(), ++i)
+        {
+            unsigned ptindex = iter.index();
+            const int* indexInfluent = closestIndices.data() + i * maxInfluence;
+            const double* distanceInfluent = closestDistances.data() + i * maxInfluence;
             // Add an element to the builder
             MDataHandle hElement = builder.addElement(ptindex, &status);
             CHECK_MSTATUS_AND_RETURN_IT(status);
@@ -479,8 +414,7 @@ MStatus RBFDeformerNode::deform(MDataBlock& dataBlock, MItGeometry& iter,
             {
                 unsigned int infIndex = indexInfluent[idx];
                 intArray.append(infIndex);
-                MPoint rpt = mayaRestControlPoints[infIndex];
-                double r = sqrt(pow((rpt.x - pt.x), 2) + pow((rpt.y - pt.y), 2) + pow((rpt.z - pt.z), 2));
+                double r = distanceInfluent[idx];
 
                 sumdis += r;
                 dis[idx] = r;
@@ -659,54 +593,6 @@ MStatus RBFDeformerNode::deform(MDataBlock& dataBlock, MItGeometry& iter,
     return MS::kSuccess;
 }
 
-std::vector<int> RBFDeformerNode::getNClosestControlPoints(int vertexIndex, int n, const Eigen::MatrixXd& vertices, const Eigen::MatrixXd& controlPoints)
-{
-    // Get the position of the input mesh vertex at index i as a row vector
-    Eigen::RowVector3d vertexPosition = vertices.row(vertexIndex);
-
-    // Number of control points
-    int numControlPoints = controlPoints.rows();
-
-    // Vector to store distances and corresponding control point indices
-    std::vector<std::pair<double, int>> distanceIndexPairs;
-    distanceIndexPairs.reserve(numControlPoints); // Reserve space for efficiency
-
-    // Compute distances from the input vertex to each control point
-    for (int j = 0; j < numControlPoints; ++j) {
-        // Ensure controlPoints.row(j) is also a row vector
-        Eigen::RowVector3d controlPointPosition = controlPoints.row(j);
-
-        // Subtract row vectors and compute the norm
-        double distance = (vertexPosition - controlPointPosition).norm();
-        distanceIndexPairs.emplace_back(distance, j);
-    }
-
-    // Handle the case where n exceeds the number of control points
-    int numInfluences = std::min(n, numControlPoints);
-
-    // Partially sort the vector to get the n closest control points
-    std::nth_element(distanceIndexPairs.begin(), distanceIndexPairs.begin() + numInfluences, distanceIndexPairs.end(),
-        [](const std::pair<double, int>& a, const std::pair<double, int>& b) {
-            return a.first < b.first;
-        });
-
-    // Extract the indices of the n closest control points
-    std::vector<int> closestIndices;
-    closestIndices.reserve(numInfluences);
-    for (int k = 0; k < numInfluences; ++k) {
-        closestIndices.push_back(distanceIndexPairs[k].second);
-    }
-
-    // Optional: Sort the indices based on distance (smallest to largest)
-    std::sort(closestIndices.begin(), closestIndices.end(),
-        [&distanceIndexPairs](int a, int b) {
-            return distanceIndexPairs[a].first < distanceIndexPairs[b].first;
-        });
-
-    return closestIndices;
-}
-
-
 MStatus initializePlugin(MObject obj) {
     MFnPlugin plugin(obj, "YourName", "1.0", "Any");
     return plugin.registerNode("RBFDeformerNode", RBFDeformerNode::id,
@@ -715,10 +601,10 @@ MStatus initializePlugin(MObject obj) {
 
 MStatus uninitializePlugin(MObject obj) {
     MFnPlugin plugin(obj);
+    KDTree::stopThreadPool(); // Its threads cannot be joined once the plugin is unloading
     return plugin.deregisterNode(RBFDeformerNode::id);
 }
 
 
 RBFDeformerNode::~RBFDeformerNode() {
-    delete tree;
 }
@@ -0,0 +1,129 @@
+#include "Affine3.h"
+#include <cmath>
+#include <iomanip>
+#include "Quaternion.h"
+#include "TiMathError.h"
+
+namespace TiMath {
+
+Affine3 Affine3::rotation(const Quaternion& q) {
+    return fromTRS(Vector3::zero, q, Vector3(1.0f, 1.0f, 1.0f));
+}
+
+Affine3 Affine3::fromTRS(const Vector3& t, const Quaternion& r, const Vector3& s) {
+    Quaternion q = r.normalized();
+    float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+    Affine3 result;
+    result.m[0] = (1.0f - 2.0f * (yy + zz)) * s.x;
+    result.m[1] = 2.0f * (xy + wz) * s.x;
+    result.m[2] = 2.0f * (xz - wy) * s.x;
+
+    result.m[3] = 2.0f * (xy - wz) * s.y;
+    result.m[4] = (1.0f - 2.0f * (xx + zz)) * s.y;
+    result.m[5] = 2.0f * (yz + wx) * s.y;
+
+    result.m[6] = 2.0f * (xz + wy) * s.z;
+    result.m[7] = 2.0f * (yz - wx) * s.z;
+    result.m[8] = (1.0f - 2.0f * (xx + yy)) * s.z;
+
+    result.m[9] = t.x;
+    result.m[10] = t.y;
+    result.m[11] = t.z;
+    return result;
+}
+
+Affine3 Affine3::lookAt(const Vector3& eye, const Vector3& target, const Vector3& up) {
+    return Affine3(Matrix4::lookAt(eye, target, up));
+}
+
+Affine3 Affine3::operator*(const Affine3& o) const {
+    Affine3 result;
+    for (int col = 0; col < 4; ++col) {
+        const float x = o.m[col * 3 + 0], y = o.m[col * 3 + 1], z = o.m[col * 3 + 2];
+        for (int row = 0; row < 3; ++row) {
+            result.m[col * 3 + row] = m[row] * x + m[3 + row] * y + m[6 + row] * z;
+        }
+    }
+    result.m[9] += m[9];
+    result.m[10] += m[10];
+    result.m[11] += m[11];
+    return result;
+}
+
+float Affine3::determinant() const {
+    return m[0] * (m[4] * m[8] - m[7] * m[5]) -
+           m[3] * (m[1] * m[8] - m[7] * m[2]) +
+           m[6] * (m[1] * m[5] - m[4] * m[2]);
+}
+
+Affine3 Affine3::inverse() const {
+    std::optional<Affine3> result = tryInverse();
+    if (!result) {
+        reportError(MathStatus::SingularMatrix);
+        return getIdentity();
+    }
+    return *result;
+}
+
+std::optional<Affine3> Affine3::tryInverse() const {
+    // Rows of the inverse linear part are the cofactor columns divided by det.
+    float c00 = m[4] * m[8] - m[7] * m[5];
+    float c01 = m[7] * m[2] - m[1] * m[8];
+    float c02 = m[1] * m[5] - m[4] * m[2];
+    float det = m[0] * c00 + m[3] * c01 + m[6] * c02;
+    if (std::fabs(det) < EPSILON) {
+        return std::nullopt;
+    }
+    float invDet = 1.0f / det;
+
+    Affine3 result;
+    result.m[0] = c00 * invDet;
+    result.m[1] = c01 * invDet;
+    result.m[2] = c02 * invDet;
+    result.m[3] = (m[6] * m[5] - m[3] * m[8]) * invDet;
+    result.m[4] = (m[0] * m[8] - m[6] * m[2]) * invDet;
+    result.m[5] = (m[3] * m[2] - m[0] * m[5]) * invDet;
+    result.m[6] = (m[3] * m[7] - m[6] * m[4]) * invDet;
+    result.m[7] = (m[6] * m[1] - m[0] * m[7]) * invDet;
+    result.m[8] = (m[0] * m[4] - m[3] * m[1]) * invDet;
+
+    Vector3 t = result.transformDirection(getTranslation());
+    result.m[9] = -t.x;
+    result.m[10] = -t.y;
+    result.m[11] = -t.z;
+    return result;
+}
+
+Affine3 Affine3::inverseRigid() const {
+    Affine3 result;
+    result.m[0] = m[0]; result.m[1] = m[3]; result.m[2] = m[6];
+    result.m[3] = m[1]; result.m[4] = m[4]; result.m[5] = m[7];
+    result.m[6] = m[2]; result.m[7] = m[5]; result.m[8] = m[8];
+    // -R^T t: dot t with each basis column.
+    result.m[9] = -(m[0] * m[9] + m[1] * m[10] + m[2] * m[11]);
+    result.m[10] = -(m[3] * m[9] + m[4] * m[10] + m[5] * m[11]);
+    result.m[11] = -(m[6] * m[9] + m[7] * m[10] + m[8] * m[11]);
+    return result;
+}
+
+Vector3 Affine3::transformNormal(const Vector3& n) const {
+    // The cofactor matrix is det * inverse-transpose; the det sign keeps mirrored normals facing out.
+    Vector3 x(m[0], m[1], m[2]);
+    Vector3 y(m[3], m[4], m[5]);
+    Vector3 z(m[6], m[7], m[8]);
+    Vector3 r = y.cross(z) * n.x + z.cross(x) * n.y + x.cross(y) * n.z;
+    return (determinant() < 0.0f ? -r : r).normalized();
+}
+
+std::ostream& operator<<(std::ostream& os, const Affine3& a) {
+    os << std::fixed << std::setprecision(4);
+    os << "[" << a.m[0] << ", " << a.m[3] << ", " << a.m[6] << ", " << a.m[9] << "]\n";
+    os << "[" << a.m[1] << ", " << a.m[4] << ", " << a.m[7] << ", " << a.m[10] << "]\n";
+    os << "[" << a.m[2] << ", " << a.m[5] << ", " << a.m[8] << ", " << a.m[11] << "]";
+    return os;
+}
+
+} // namespace TiMath
@@ -0,0 +1,171 @@
+#ifndef AFFINE3_H
+#define AFFINE3_H
+
+#include <array>
+#include <optional>
+#include <ostream>
+#include "TiMathConfig.h"
+#include "TiMathFwd.h"
+#include "Vector3.h"
+#include "Matrix4.h"
+
+namespace TiMath {
+
+/**
+ * @class Affine3
+ * @brief A 3x4 affine transform (column-major: three basis columns, then translation).
+ *
+ * The implicit bottom row is (0, 0, 0, 1). That saves a quarter of Matrix4's storage and
+ * lets compose, inverse and point transforms skip the projective terms entirely.
+ */
+class Affine3 {
+public:
+    std::array<float, 12> m; // Column-major order: m[0..2] X, m[3..5] Y, m[6..8] Z, m[9..11] translation
+
+    // Default constructor: initializes to identity
+    constexpr Affine3() : m{1.0f, 0.0f, 0.0f,
+                            0.0f, 1.0f, 0.0f,
+                            0.0f, 0.0f, 1.0f,
+                            0.0f, 0.0f, 0.0f} {}
+
+    /**
+     * @brief Builds an affine transform from a Matrix4, dropping its bottom row.
+     * @param mat The source matrix; its bottom row is assumed to be (0, 0, 0, 1).
+     */
+    explicit constexpr Affine3(const Matrix4& mat)
+        : m{mat.m[0], mat.m[1], mat.m[2],
+            mat.m[4], mat.m[5], mat.m[6],
+            mat.m[8], mat.m[9], mat.m[10],
+            mat.m[12], mat.m[13], mat.m[14]} {}
+
+    /**
+     * @brief Expands the transform to a full 4x4 matrix with bottom row (0, 0, 0, 1).
+     * @return The equivalent Matrix4.
+     */
+    [[nodiscard]] constexpr Matrix4 toMatrix4() const {
+        Matrix4 result;
+        result.m[0] = m[0];  result.m[1] = m[1];   result.m[2] = m[2];
+        result.m[4] = m[3];  result.m[5] = m[4];   result.m[6] = m[5];
+        result.m[8] = m[6];  result.m[9] = m[7];   result.m[10] = m[8];
+        result.m[12] = m[9]; result.m[13] = m[10]; result.m[14] = m[11];
+        return result;
+    }
+
+    /**
+     * @brief Returns the identity transform.
+     * @return The identity.
+     */
+    [[nodiscard]] static constexpr Affine3 getIdentity() {
+        return Affine3();
+    }
+
+    /**
+     * @brief Creates a translation.
+     * @param v The translation vector.
+     * @return The transform.
+     */
+    [[nodiscard]] static constexpr Affine3 translation(const Vector3& v) {
+        Affine3 result;
+        result.m[9] = v.x;
+        result.m[10] = v.y;
+        result.m[11] = v.z;
+        return result;
+    }
+
+    /**
+     * @brief Creates a non-uniform scale.
+     * @param s The scaling factors for x, y, z.
+     * @return The transform.
+     */
+    [[nodiscard]] static constexpr Affine3 scaling(const Vector3& s) {
+        Affine3 result;
+        result.m[0] = s.x;
+        result.m[4] = s.y;
+        result.m[8] = s.z;
+        return result;
+    }
+
+    /**
+     * @brief Creates a rotation from a quaternion (normalized internally).
+     * @param q The rotation.
+     * @return The transform.
+     */
+    [[nodiscard]] static Affine3 rotation(const Quaternion& q);
+
+    /**
+     * @brief Creates translate * rotate * scale without any intermediate products.
+     * @param t The translation.
+     * @param r The rotation.
+     * @param s The scaling factors.
+     * @return The transform.
+     */
+    [[nodiscard]] static Affine3 fromTRS(const Vector3& t, const Quaternion& r, const Vector3& s);
+
+    /**
+     * @brief Creates a look-at view transform; same conventions and validation as Matrix4::lookAt.
+     * @param eye The camera position.
+     * @param target The target point to look at.
+     * @param up The up vector (must be non-zero).
+     * @return The view transform.
+     */
+    [[nodiscard]] static Affine3 lookAt(const Vector3& eye, const Vector3& target, const Vector3& up);
+
+    /**
+     * @brief Composes two transforms (this applied after other).
+     * @param other The transform applied first.
+     * @return The composed transform.
+     */
+    [[nodiscard]] Affine3 operator*(const Affine3& other) const;
+
+    /**
+     * @brief General affine inverse through the 3x3 cofactor matrix; handles scale and shear.
+     * @return The inverse, or identity if the linear part is singular (reported per TIMATH_ERROR_POLICY).
+     */
+    [[nodiscard]] Affine3 inverse() const;
+
+    /** @brief Like inverse, but returns std::nullopt for a singular linear part without reporting it. */
+    [[nodiscard]] std::optional<Affine3> tryInverse() const;
+
+    /**
+     * @brief Inverse of a rigid transform: transposed rotation and -R^T t.
+     *        Only valid when the linear part is orthonormal (rotation only, e.g. a view transform).
+     * @return The inverse.
+     */
+    [[nodiscard]] Affine3 inverseRigid() const;
+
+    /** @brief Returns the determinant of the linear 3x3 part. */
+    [[nodiscard]] float determinant() const;
+
+    /** @brief Returns the translation column. */
+    [[nodiscard]] constexpr Vector3 getTranslation() const {
+        return Vector3(m[9], m[10], m[11]);
+    }
+
+    /** @brief Transforms a point (w = 1). */
+    [[nodiscard]] constexpr Vector3 transformPoint(const Vector3& p) const {
+        return Vector3(m[0] * p.x + m[3] * p.y + m[6] * p.z + m[9],
+                       m[1] * p.x + m[4] * p.y + m[7] * p.z + m[10],
+                       m[2] * p.x + m[5] * p.y + m[8] * p.z + m[11]);
+    }
+
+    /** @brief Transforms a direction (w = 0); translation is ignored. */
+    [[nodiscard]] constexpr Vector3 transformDirection(const Vector3& d) const {
+        return Vector3(m[0] * d.x + m[3] * d.y + m[6] * d.z,
+                       m[1] * d.x + m[4] * d.y + m[7] * d.z,
+                       m[2] * d.x + m[5] * d.y + m[8] * d.z);
+    }
+
+    /**
+     * @brief Transforms a surface normal by the inverse transpose of the linear part.
+     *        Uses the cofactor matrix so no division is needed; the result is re-normalized.
+     * @param n The normal.
+     * @return The transformed unit normal, or zero if the linear part is singular.
+     */
+    [[nodiscard]] Vector3 transformNormal(const Vector3& n) const;
+
+    friend std::ostream& operator<<(std::ostream& os, const Affine3& a);
+};
+
+} // namespace TiMath
+
+#endif // AFFINE3_H
@@ -0,0 +1,43 @@
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+
+namespace TiMath {
+
+/**
+ * @brief Minimal std::allocator replacement returning Alignment-byte aligned storage.
+ *        Used for SIMD streams so full-width loads never straddle a cache line.
+ */
+template <typename T, std::size_t Alignment = 32>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    constexpr AlignedAllocator() noexcept = default;
+    template <typename U>
+    constexpr AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    [[nodiscard]] T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    constexpr bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    template <typename U>
+    constexpr bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept { return false; }
+};
+
+} // namespace TiMath
+
+#endif // ALIGNED_ALLOCATOR_H
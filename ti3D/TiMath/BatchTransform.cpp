@@ -0,0 +1,185 @@
+#include "BatchTransform.h"
+#include <algorithm>
+#include <cmath>
+#include "Parallel.h"
+#include "TiMathSIMD.h"
+
+namespace TiMath {
+
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "batched kernels treat Vector3 arrays as packed floats");
+static_assert(sizeof(Vector4) == 4 * sizeof(float), "batched kernels treat Vector4 arrays as packed floats");
+static_assert(sizeof(Quaternion) == 4 * sizeof(float), "batched kernels treat Quaternion arrays as packed floats");
+
+namespace {
+
+// W is the homogeneous coordinate of the inputs: 1 for points, 0 for directions.
+template <int W>
+void transformRange(const Matrix4& m, const Vector3* in, Vector3* out, std::size_t begin, std::size_t end) {
+    std::size_t i = begin;
+#if defined(TIMATH_SSE)
+    const __m128 m0 = _mm_set1_ps(m.m[0]), m1 = _mm_set1_ps(m.m[1]), m2 = _mm_set1_ps(m.m[2]);
+    const __m128 m4 = _mm_set1_ps(m.m[4]), m5 = _mm_set1_ps(m.m[5]), m6 = _mm_set1_ps(m.m[6]);
+    const __m128 m8 = _mm_set1_ps(m.m[8]), m9 = _mm_set1_ps(m.m[9]), m10 = _mm_set1_ps(m.m[10]);
+    const __m128 tx = _mm_set1_ps(W * m.m[12]), ty = _mm_set1_ps(W * m.m[13]), tz = _mm_set1_ps(W * m.m[14]);
+    for (; i + 4 <= end; i += 4) {
+        __m128 x, y, z;
+        simd::loadTransposed3x4(&in[i].x, x, y, z);
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_add_ps(_mm_mul_ps(m8, z), tx));
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_add_ps(_mm_mul_ps(m9, z), ty));
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_add_ps(_mm_mul_ps(m10, z), tz));
+        simd::storeTransposed3x4(&out[i].x, rx, ry, rz);
+    }
+#endif
+    for (; i < end; ++i) {
+        out[i] = W ? m.transformPoint(in[i]) : m.transformDirection(in[i]);
+    }
+}
+
+void transformProjectiveRange(const Matrix4& m, const Vector3* in, Vector3* out, std::size_t begin, std::size_t end) {
+    std::size_t i = begin;
+#if defined(TIMATH_SSE)
+    const __m128 m0 = _mm_set1_ps(m.m[0]), m1 = _mm_set1_ps(m.m[1]), m2 = _mm_set1_ps(m.m[2]), m3 = _mm_set1_ps(m.m[3]);
+    const __m128 m4 = _mm_set1_ps(m.m[4]), m5 = _mm_set1_ps(m.m[5]), m6 = _mm_set1_ps(m.m[6]), m7 = _mm_set1_ps(m.m[7]);
+    const __m128 m8 = _mm_set1_ps(m.m[8]), m9 = _mm_set1_ps(m.m[9]), m10 = _mm_set1_ps(m.m[10]), m11 = _mm_set1_ps(m.m[11]);
+    const __m128 m12 = _mm_set1_ps(m.m[12]), m13 = _mm_set1_ps(m.m[13]), m14 = _mm_set1_ps(m.m[14]), m15 = _mm_set1_ps(m.m[15]);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 eps = _mm_set1_ps(EPSILON);
+    for (; i + 4 <= end; i += 4) {
+        __m128 x, y, z;
+        simd::loadTransposed3x4(&in[i].x, x, y, z);
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), _mm_add_ps(_mm_mul_ps(m8, z), m12));
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), _mm_add_ps(_mm_mul_ps(m9, z), m13));
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m2, x), _mm_mul_ps(m6, y)), _mm_add_ps(_mm_mul_ps(m10, z), m14));
+        __m128 rw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m3, x), _mm_mul_ps(m7, y)), _mm_add_ps(_mm_mul_ps(m11, z), m15));
+        // Lanes with |w| < EPSILON become zero instead of inf/nan.
+        __m128 valid = _mm_cmpge_ps(_mm_and_ps(rw, absMask), eps);
+        __m128 invW = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), rw), valid);
+        simd::storeTransposed3x4(&out[i].x, _mm_mul_ps(rx, invW), _mm_mul_ps(ry, invW), _mm_mul_ps(rz, invW));
+    }
+#endif
+    for (; i < end; ++i) {
+        out[i] = (m * Vector4(in[i], 1.0f)).homogeneousDivide();
+    }
+}
+
+void transformHomogeneousRange(const Matrix4& m, const Vector4* in, Vector4* out, std::size_t begin, std::size_t end) {
+    std::size_t i = begin;
+#if defined(TIMATH_SSE)
+    const __m128 c0 = _mm_load_ps(&m.m[0]);
+    const __m128 c1 = _mm_load_ps(&m.m[4]);
+    const __m128 c2 = _mm_load_ps(&m.m[8]);
+    const __m128 c3 = _mm_load_ps(&m.m[12]);
+    for (; i < end; ++i) {
+        __m128 v = _mm_loadu_ps(&in[i].x);
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, simd::splat<0>(v)), _mm_mul_ps(c1, simd::splat<1>(v))),
+                              _mm_add_ps(_mm_mul_ps(c2, simd::splat<2>(v)), _mm_mul_ps(c3, simd::splat<3>(v))));
+        _mm_storeu_ps(&out[i].x, r);
+    }
+#endif
+    for (; i < end; ++i) {
+        out[i] = m * in[i];
+    }
+}
+
+#if defined(TIMATH_SSE)
+// v + w t + u x t with t = s (u x v); s is 2 for unit quaternions, 2 / |q|^2 otherwise.
+inline void rotate4(__m128 qx, __m128 qy, __m128 qz, __m128 qw, __m128 s,
+                    __m128& x, __m128& y, __m128& z) {
+    __m128 tx = _mm_mul_ps(s, _mm_sub_ps(_mm_mul_ps(qy, z), _mm_mul_ps(qz, y)));
+    __m128 ty = _mm_mul_ps(s, _mm_sub_ps(_mm_mul_ps(qz, x), _mm_mul_ps(qx, z)));
+    __m128 tz = _mm_mul_ps(s, _mm_sub_ps(_mm_mul_ps(qx, y), _mm_mul_ps(qy, x)));
+    x = _mm_add_ps(_mm_add_ps(x, _mm_mul_ps(qw, tx)), _mm_sub_ps(_mm_mul_ps(qy, tz), _mm_mul_ps(qz, ty)));
+    y = _mm_add_ps(_mm_add_ps(y, _mm_mul_ps(qw, ty)), _mm_sub_ps(_mm_mul_ps(qz, tx), _mm_mul_ps(qx, tz)));
+    z = _mm_add_ps(_mm_add_ps(z, _mm_mul_ps(qw, tz)), _mm_sub_ps(_mm_mul_ps(qx, ty), _mm_mul_ps(qy, tx)));
+}
+#endif
+
+void rotateRange(const Quaternion& q, const Vector3* in, Vector3* out, std::size_t begin, std::size_t end) {
+    std::size_t i = begin;
+#if defined(TIMATH_SSE)
+    const __m128 qx = _mm_set1_ps(q.x), qy = _mm_set1_ps(q.y), qz = _mm_set1_ps(q.z), qw = _mm_set1_ps(q.w);
+    const __m128 two = _mm_set1_ps(2.0f);
+    for (; i + 4 <= end; i += 4) {
+        __m128 x, y, z;
+        simd::loadTransposed3x4(&in[i].x, x, y, z);
+        rotate4(qx, qy, qz, qw, two, x, y, z);
+        simd::storeTransposed3x4(&out[i].x, x, y, z);
+    }
+#endif
+    for (; i < end; ++i) {
+        out[i] = q.rotateVectorUnit(in[i]);
+    }
+}
+
+void rotateEachRange(const Quaternion* qs, const Vector3* in, Vector3* out, std::size_t begin, std::size_t end) {
+    std::size_t i = begin;
+#if defined(TIMATH_SSE)
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 eps = _mm_set1_ps(EPSILON);
+    for (; i + 4 <= end; i += 4) {
+        __m128 qx = _mm_loadu_ps(&qs[i].x);
+        __m128 qy = _mm_loadu_ps(&qs[i + 1].x);
+        __m128 qz = _mm_loadu_ps(&qs[i + 2].x);
+        __m128 qw = _mm_loadu_ps(&qs[i + 3].x);
+        _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+        __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)),
+                                  _mm_add_ps(_mm_mul_ps(qz, qz), _mm_mul_ps(qw, qw)));
+        // Near-zero quaternions get s = 0, which leaves the vector unchanged like rotateVector.
+        __m128 s = _mm_and_ps(_mm_div_ps(two, lenSq), _mm_cmpge_ps(lenSq, eps));
+        __m128 x, y, z;
+        simd::loadTransposed3x4(&in[i].x, x, y, z);
+        rotate4(qx, qy, qz, qw, s, x, y, z);
+        simd::storeTransposed3x4(&out[i].x, x, y, z);
+    }
+#endif
+    for (; i < end; ++i) {
+        out[i] = qs[i].rotateVector(in[i]);
+    }
+}
+
+} // namespace
+
+void transformPoints(const Matrix4& m, const Vector3* in, Vector3* out, std::size_t n) {
+    parallelFor(n, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        transformRange<1>(m, in, out, begin, end);
+    });
+}
+
+void transformPointsProjective(const Matrix4& m, const Vector3* in, Vector3* out, std::size_t n) {
+    parallelFor(n, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        transformProjectiveRange(m, in, out, begin, end);
+    });
+}
+
+void transformDirections(const Matrix4& m, const Vector3* in, Vector3* out, std::size_t n) {
+    parallelFor(n, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        transformRange<0>(m, in, out, begin, end);
+    });
+}
+
+void transformHomogeneous(const Matrix4& m, const Vector4* in, Vector4* out, std::size_t n) {
+    parallelFor(n, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        transformHomogeneousRange(m, in, out, begin, end);
+    });
+}
+
+void rotateVectors(const Quaternion& q, const Vector3* in, Vector3* out, std::size_t n) {
+    if (q.lengthSquared() < EPSILON) {
+        if (in != out) {
+            std::copy(in, in + n, out);
+        }
+        return;
+    }
+    const Quaternion unit = q.normalized();
+    parallelFor(n, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        rotateRange(unit, in, out, begin, end);
+    });
+}
+
+void rotateVectors(const Quaternion* qs, const Vector3* in, Vector3* out, std::size_t n) {
+    parallelFor(n, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        rotateEachRange(qs, in, out, begin, end);
+    });
+}
+
+} // namespace TiMath
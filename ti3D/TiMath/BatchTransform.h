@@ -0,0 +1,81 @@
+#ifndef BATCH_TRANSFORM_H
+#define BATCH_TRANSFORM_H
+
+#include <cstddef>
+#include "TiMathConfig.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+
+namespace TiMath {
+
+// Smallest share of a batch worth its own thread. A batch is split across threads once it
+// holds at least twice this many elements; smaller ones run on the calling thread.
+constexpr std::size_t PARALLEL_BATCH_THRESHOLD = 32768;
+
+// Batched transforms for whole meshes. Each entry point is vectorized when TIMATH_SSE is
+// defined (four elements per iteration) and splits into parallel chunks of at least
+// PARALLEL_BATCH_THRESHOLD elements. `in` and `out` may be the same array for in-place
+// updates, but must not otherwise overlap.
+
+/**
+ * @brief Transforms points (w = 1) by the affine part of m; the bottom row is ignored.
+ * @param m The transform.
+ * @param in Source points.
+ * @param out Destination points.
+ * @param n Number of points.
+ */
+void transformPoints(const Matrix4& m, const Vector3* in, Vector3* out, std::size_t n);
+
+/**
+ * @brief Transforms points (w = 1) by the full matrix and divides by the resulting w.
+ *        Points that land on w near zero are written as zero, matching Vector4::homogeneousDivide.
+ * @param m The transform, typically a view-projection matrix.
+ * @param in Source points.
+ * @param out Destination points.
+ * @param n Number of points.
+ */
+void transformPointsProjective(const Matrix4& m, const Vector3* in, Vector3* out, std::size_t n);
+
+/**
+ * @brief Transforms directions (w = 0) by the upper 3x3 of m; translation is ignored.
+ * @param m The transform.
+ * @param in Source directions.
+ * @param out Destination directions.
+ * @param n Number of directions.
+ */
+void transformDirections(const Matrix4& m, const Vector3* in, Vector3* out, std::size_t n);
+
+/**
+ * @brief Transforms homogeneous vectors by the full matrix, equivalent to m * in[i].
+ * @param m The transform.
+ * @param in Source vectors.
+ * @param out Destination vectors.
+ * @param n Number of vectors.
+ */
+void transformHomogeneous(const Matrix4& m, const Vector4* in, Vector4* out, std::size_t n);
+
+/**
+ * @brief Rotates every vector by one quaternion, equivalent to q.rotateVector(in[i]).
+ *        q is normalized once up front, so it need not be unit length.
+ * @param q The rotation.
+ * @param in Source vectors.
+ * @param out Destination vectors.
+ * @param n Number of vectors.
+ */
+void rotateVectors(const Quaternion& q, const Vector3* in, Vector3* out, std::size_t n);
+
+/**
+ * @brief Rotates each vector by its own quaternion, equivalent to qs[i].rotateVector(in[i]).
+ *        Non-unit quaternions are handled; near-zero ones leave the vector unchanged.
+ * @param qs One rotation per vector.
+ * @param in Source vectors.
+ * @param out Destination vectors.
+ * @param n Number of vectors.
+ */
+void rotateVectors(const Quaternion* qs, const Vector3* in, Vector3* out, std::size_t n);
+
+} // namespace TiMath
+
+#endif // BATCH_TRANSFORM_H
@@ -0,0 +1,337 @@
+// TiMath micro-benchmarks. Builds without GL/GLFW (see TiMath/CMakeLists.txt).
+//
+//   TiMathBench [--filter <substring>] [--reps <n>] [--json <file>]
+//
+// Every case is warmed up, then timed over --reps repetitions; each repetition runs the
+// case often enough to take about a millisecond. Reported times are nanoseconds per
+// element (per operation for the single-value cases, per vector or quaternion for batches).
+
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include "Affine3.h"
+#include "BatchTransform.h"
+#include "Vector3Stream.h"
+#include "QuaternionBlend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace TiMath;
+
+namespace {
+
+/** @brief Keeps the compiler from discarding a value that is only computed for timing. */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+struct Result {
+    std::string name;
+    std::size_t elements; // Elements processed per call of the case.
+    double medianNs, minNs, meanNs, stddevNs; // Per element.
+};
+
+struct Options {
+    std::string filter;
+    std::string jsonPath;
+    int reps = 15;
+};
+
+class Runner {
+public:
+    explicit Runner(const Options& options) : options_(options) {}
+
+    /** @brief Times fn, which processes `elements` elements per call. */
+    void run(const std::string& name, std::size_t elements, const std::function<void()>& fn) {
+        if (!options_.filter.empty() && name.find(options_.filter) == std::string::npos) {
+            return;
+        }
+        using Clock = std::chrono::steady_clock;
+        // Warm up caches and the branch predictor, and size a repetition to ~1 ms.
+        std::size_t calls = 1;
+        for (;;) {
+            auto start = Clock::now();
+            for (std::size_t c = 0; c < calls; ++c) fn();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            if (ns > 1e6 || calls >= (std::size_t(1) << 24)) break;
+            calls *= 2;
+        }
+
+        std::vector<double> samples;
+        samples.reserve(options_.reps);
+        for (int r = 0; r < options_.reps; ++r) {
+            auto start = Clock::now();
+            for (std::size_t c = 0; c < calls; ++c) fn();
+            double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+            samples.push_back(ns / (double(calls) * double(elements)));
+        }
+        std::sort(samples.begin(), samples.end());
+        double mean = 0.0;
+        for (double s : samples) mean += s;
+        mean /= samples.size();
+        double var = 0.0;
+        for (double s : samples) var += (s - mean) * (s - mean);
+        double stddev = samples.size() > 1 ? std::sqrt(var / (samples.size() - 1)) : 0.0;
+
+        Result result{name, elements, samples[samples.size() / 2], samples.front(), mean, stddev};
+        std::printf("%-48s %10.3f ns  (min %.3f, +/- %.3f)\n", name.c_str(), result.medianNs, result.minNs, result.stddevNs);
+        results_.push_back(result);
+    }
+
+    void writeJson(std::ostream& os) const {
+#if defined(TIMATH_AVX)
+        const char* backend = "avx";
+#elif defined(TIMATH_SSE)
+        const char* backend = "sse";
+#else
+        const char* backend = "scalar";
+#endif
+        os << "{\n  \"backend\": \"" << backend << "\",\n  \"repetitions\": " << options_.reps
+           << ",\n  \"unit\": \"ns/element\",\n  \"results\": [\n";
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            os << "    {\"name\": \"" << r.name << "\", \"elements\": " << r.elements
+               << ", \"median\": " << r.medianNs << ", \"min\": " << r.minNs
+               << ", \"mean\": " << r.meanNs << ", \"stddev\": " << r.stddevNs << "}"
+               << (i + 1 < results_.size() ? ",\n" : "\n");
+        }
+        os << "  ]\n}\n";
+    }
+
+private:
+    Options options_;
+    std::vector<Result> results_;
+};
+
+// Single-value cases sweep this many inputs per call, so results are not constant-folded
+// and the loop overhead is amortized.
+constexpr std::size_t SINGLE = 1024;
+// Batched cases: large enough to leave L1, below PARALLEL_BATCH_THRESHOLD so they stay single-threaded.
+constexpr std::size_t BATCH = 16384;
+// Batched cases above the threshold, to show the threaded path.
+constexpr std::size_t BATCH_PARALLEL = 4 * PARALLEL_BATCH_THRESHOLD;
+
+struct Data {
+    std::vector<Vector3> v3a, v3b, v3out;
+    std::vector<Vector4> v4a, v4b, v4out;
+    std::vector<Quaternion> qa, qb, qout;
+    std::vector<Matrix4> ma, mb, mout;
+    std::vector<Matrix4d> mda, mdb, mdout;
+    std::vector<Affine3> aa, ab, aout;
+    std::vector<float> t, scalars;
+
+    explicit Data(std::size_t n) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        auto vec3 = [&] { return Vector3(value(rng), value(rng), value(rng)); };
+        auto quat = [&] { return Quaternion(value(rng), value(rng), value(rng), value(rng)).normalized(); };
+        auto trs = [&] {
+            return Matrix4::translation(vec3()) * quat().toMatrix4() *
+                   Matrix4::scaling(Vector3(1.0f + unit(rng), 1.0f + unit(rng), 1.0f + unit(rng)));
+        };
+        for (std::size_t i = 0; i < n; ++i) {
+            v3a.push_back(vec3());
+            v3b.push_back(vec3());
+            v4a.push_back(Vector4(vec3(), 1.0f));
+            v4b.push_back(Vector4(vec3(), value(rng)));
+            qa.push_back(quat());
+            qb.push_back(quat());
+            t.push_back(unit(rng));
+            scalars.push_back(value(rng));
+        }
+        for (std::size_t i = 0; i < SINGLE; ++i) {
+            ma.push_back(trs());
+            mb.push_back(trs());
+            mda.push_back(Matrix4d(ma.back()));
+            mdb.push_back(Matrix4d(mb.back()));
+            aa.push_back(Affine3(ma.back()));
+            ab.push_back(Affine3(mb.back()));
+        }
+        v3out.resize(n);
+        v4out.resize(n);
+        qout.resize(n);
+        mout.resize(SINGLE);
+        mdout.resize(SINGLE);
+        aout.resize(SINGLE);
+    }
+};
+
+// Wraps a per-element expression into a case over SINGLE inputs.
+#define TIMATH_BENCH_SINGLE(runner, name, out, expr)                 \
+    (runner).run(name, SINGLE, [&] {                                 \
+        for (std::size_t i = 0; i < SINGLE; ++i) (out)[i] = (expr);  \
+        doNotOptimize((out)[0]);                                     \
+    })
+
+void benchVectors(Runner& r, Data& d) {
+    TIMATH_BENCH_SINGLE(r, "Vector3::operator+", d.v3out, d.v3a[i] + d.v3b[i]);
+    TIMATH_BENCH_SINGLE(r, "Vector3::dot", d.scalars, d.v3a[i].dot(d.v3b[i]));
+    TIMATH_BENCH_SINGLE(r, "Vector3::cross", d.v3out, d.v3a[i].cross(d.v3b[i]));
+    TIMATH_BENCH_SINGLE(r, "Vector3::length", d.scalars, d.v3a[i].length());
+    TIMATH_BENCH_SINGLE(r, "Vector3::normalized", d.v3out, d.v3a[i].normalized());
+    TIMATH_BENCH_SINGLE(r, "Vector3::rotate", d.v3out, d.v3a[i].rotate(d.t[i] * 360.0f, d.v3b[i]));
+    TIMATH_BENCH_SINGLE(r, "Vector3::lerp", d.v3out, Vector3::lerp(d.v3a[i], d.v3b[i], d.t[i]));
+    TIMATH_BENCH_SINGLE(r, "Vector4::dot", d.scalars, d.v4a[i].dot(d.v4b[i]));
+    TIMATH_BENCH_SINGLE(r, "Vector4::normalized", d.v4out, d.v4a[i].normalized());
+    TIMATH_BENCH_SINGLE(r, "Vector4::homogeneousDivide", d.v3out, d.v4b[i].homogeneousDivide());
+}
+
+void benchQuaternions(Runner& r, Data& d) {
+    TIMATH_BENCH_SINGLE(r, "Quaternion::operator*", d.qout, d.qa[i] * d.qb[i]);
+    TIMATH_BENCH_SINGLE(r, "Quaternion::normalized", d.qout, d.qa[i].normalized());
+    TIMATH_BENCH_SINGLE(r, "Quaternion::inverse", d.qout, d.qa[i].inverse());
+    TIMATH_BENCH_SINGLE(r, "Quaternion::rotateVector", d.v3out, d.qa[i].rotateVector(d.v3a[i]));
+    TIMATH_BENCH_SINGLE(r, "Quaternion::rotateVectorUnit", d.v3out, d.qa[i].rotateVectorUnit(d.v3a[i]));
+    TIMATH_BENCH_SINGLE(r, "Quaternion::fromAxisAngle", d.qout, Quaternion::fromAxisAngle(d.v3a[i], d.t[i] * 360.0f));
+    TIMATH_BENCH_SINGLE(r, "Quaternion::slerp", d.qout, Quaternion::slerp(d.qa[i], d.qb[i], d.t[i]));
+    TIMATH_BENCH_SINGLE(r, "Quaternion::toMatrix4", d.mout, d.qa[i].toMatrix4());
+}
+
+void benchMatrices(Runner& r, Data& d) {
+    TIMATH_BENCH_SINGLE(r, "Matrix4::operator* (dispatch)", d.mout, d.ma[i] * d.mb[i]);
+    TIMATH_BENCH_SINGLE(r, "Matrix4::multiplyScalar", d.mout, Matrix4::multiplyScalar(d.ma[i], d.mb[i]));
+    TIMATH_BENCH_SINGLE(r, "Matrix4::inverse (dispatch)", d.mout, d.ma[i].inverse());
+    TIMATH_BENCH_SINGLE(r, "Matrix4::inverseScalar", d.mout, Matrix4::inverseScalar(d.ma[i]));
+    TIMATH_BENCH_SINGLE(r, "Matrix4 * Vector4 (dispatch)", d.v4out, d.ma[i] * d.v4a[i]);
+    TIMATH_BENCH_SINGLE(r, "Matrix4::transformScalar", d.v4out, Matrix4::transformScalar(d.ma[i], d.v4a[i]));
+#if defined(TIMATH_SSE)
+    TIMATH_BENCH_SINGLE(r, "Matrix4::multiplySIMD", d.mout, Matrix4::multiplySIMD(d.ma[i], d.mb[i]));
+    TIMATH_BENCH_SINGLE(r, "Matrix4::inverseSIMD", d.mout, Matrix4::inverseSIMD(d.ma[i]));
+    TIMATH_BENCH_SINGLE(r, "Matrix4::transformSIMD", d.v4out, Matrix4::transformSIMD(d.ma[i], d.v4a[i]));
+#endif
+    TIMATH_BENCH_SINGLE(r, "Matrix4::transformPoint", d.v3out, d.ma[i].transformPoint(d.v3a[i]));
+    TIMATH_BENCH_SINGLE(r, "Matrix4::toQuaternion", d.qout, d.ma[i].toQuaternion());
+    TIMATH_BENCH_SINGLE(r, "Matrix4::rotationAxis", d.mout, Matrix4::rotationAxis(d.v3a[i], d.t[i] * 360.0f));
+    TIMATH_BENCH_SINGLE(r, "Matrix4::lookAt", d.mout, Matrix4::lookAt(d.v3a[i], d.v3b[i], Vector3::unitY));
+    TIMATH_BENCH_SINGLE(r, "Matrix4::perspective", d.mout, Matrix4::perspective(30.0f + d.t[i] * 60.0f, 1.5f, 0.1f, 100.0f));
+    r.run("Matrix4::decompose", SINGLE, [&] {
+        for (std::size_t i = 0; i < SINGLE; ++i) {
+            auto trs = d.ma[i].decompose();
+            doNotOptimize(trs);
+        }
+    });
+    TIMATH_BENCH_SINGLE(r, "Matrix4d::operator* (dispatch)", d.mdout, d.mda[i] * d.mdb[i]);
+    TIMATH_BENCH_SINGLE(r, "Matrix4d::multiplyScalar", d.mdout, Matrix4d::multiplyScalar(d.mda[i], d.mdb[i]));
+    TIMATH_BENCH_SINGLE(r, "Matrix4d::inverse", d.mdout, d.mda[i].inverse());
+    TIMATH_BENCH_SINGLE(r, "Affine3::operator*", d.aout, d.aa[i] * d.ab[i]);
+    TIMATH_BENCH_SINGLE(r, "Affine3::inverse", d.aout, d.aa[i].inverse());
+    TIMATH_BENCH_SINGLE(r, "Affine3::inverseRigid", d.aout, d.aa[i].inverseRigid());
+}
+
+void benchBatches(Runner& r, Data& d, std::size_t n, const char* suffix) {
+    const Matrix4& m = d.ma[0];
+    const std::string s = suffix;
+    r.run("transformPoints" + s, n, [&] { transformPoints(m, d.v3a.data(), d.v3out.data(), n); });
+    r.run("transformPointsProjective" + s, n, [&] { transformPointsProjective(m, d.v3a.data(), d.v3out.data(), n); });
+    r.run("transformDirections" + s, n, [&] { transformDirections(m, d.v3a.data(), d.v3out.data(), n); });
+    r.run("transformHomogeneous" + s, n, [&] { transformHomogeneous(m, d.v4a.data(), d.v4out.data(), n); });
+    r.run("rotateVectors(q)" + s, n, [&] { rotateVectors(d.qa[0], d.v3a.data(), d.v3out.data(), n); });
+    r.run("rotateVectors(qs)" + s, n, [&] { rotateVectors(d.qa.data(), d.v3a.data(), d.v3out.data(), n); });
+    r.run("scalar loop: Matrix4::transformPoint" + s, n, [&] {
+        for (std::size_t i = 0; i < n; ++i) d.v3out[i] = m.transformPoint(d.v3a[i]);
+        doNotOptimize(d.v3out[0]);
+    });
+}
+
+void benchStreams(Runner& r, Data& d) {
+    const std::size_t n = BATCH;
+    Vector3Stream a(std::vector<Vector3>(d.v3a.begin(), d.v3a.begin() + n));
+    Vector3Stream b(std::vector<Vector3>(d.v3b.begin(), d.v3b.begin() + n));
+    Vector3Stream out(n);
+    std::vector<float> scalars(n);
+    Vector3View aosA = makeView(d.v3a.data(), n), aosB = makeView(d.v3b.data(), n);
+    MutableVector3View aosOut = makeView(d.v3out.data(), n);
+
+    r.run("stream::dot [SoA]", n, [&] { stream::dot(a.view(), b.view(), scalars.data()); });
+    r.run("stream::dot [AoS]", n, [&] { stream::dot(aosA, aosB, scalars.data()); });
+    r.run("stream::cross [SoA]", n, [&] { stream::cross(a.view(), b.view(), out.view()); });
+    r.run("stream::cross [AoS]", n, [&] { stream::cross(aosA, aosB, aosOut); });
+    r.run("stream::normalize [SoA]", n, [&] { stream::normalize(a.view(), out.view()); });
+    r.run("stream::normalize [AoS]", n, [&] { stream::normalize(aosA, aosOut); });
+    r.run("stream::lerp [SoA]", n, [&] { stream::lerp(a.view(), b.view(), 0.3f, out.view()); });
+    r.run("stream::computeBounds [SoA]", n, [&] {
+        Bounds3 bounds = stream::computeBounds(a.view());
+        doNotOptimize(bounds);
+    });
+    r.run("Vector3Stream::assign", n, [&] { out.assign(d.v3a.data(), n); });
+}
+
+void benchBlend(Runner& r, Data& d) {
+    const std::size_t n = BATCH;
+    QuaternionStream a(std::vector<Quaternion>(d.qa.begin(), d.qa.begin() + n));
+    QuaternionStream b(std::vector<Quaternion>(d.qb.begin(), d.qb.begin() + n));
+    QuaternionStream out(n);
+    r.run("blend::slerp [SoA]", n, [&] { blend::slerp(a.view(), b.view(), d.t.data(), out.view()); });
+    r.run("blend::nlerp [SoA]", n, [&] { blend::nlerp(a.view(), b.view(), d.t.data(), out.view()); });
+    r.run("blend::nlerp [AoS]", n, [&] {
+        blend::nlerp(makeView(d.qa.data(), n), makeView(d.qb.data(), n), d.t.data(), makeView(d.qout.data(), n));
+    });
+    QuaternionView inputs[4] = {a.view(), b.view(), a.view(), b.view()};
+    const float weights[4] = {0.4f, 0.3f, 0.2f, 0.1f};
+    r.run("blend::weightedAverage (4 inputs)", n, [&] { blend::weightedAverage(inputs, weights, 4, out.view()); });
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--filter") && hasValue) {
+            options.filter = argv[++i];
+        } else if (!std::strcmp(argv[i], "--json") && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (!std::strcmp(argv[i], "--reps") && hasValue) {
+            options.reps = std::max(1, std::atoi(argv[++i]));
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--filter <substring>] [--reps <n>] [--json <file>]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    Data data(BATCH_PARALLEL);
+    Runner runner(options);
+    benchVectors(runner, data);
+    benchQuaternions(runner, data);
+    benchMatrices(runner, data);
+    benchBatches(runner, data, BATCH, "");
+    benchBatches(runner, data, BATCH_PARALLEL, " [threaded]");
+    benchStreams(runner, data);
+    benchBlend(runner, data);
+
+    if (!options.jsonPath.empty()) {
+        std::ofstream json(options.jsonPath);
+        if (!json) {
+            std::cerr << "cannot write " << options.jsonPath << "\n";
+            return 1;
+        }
+        runner.writeJson(json);
+    }
+    return 0;
+}
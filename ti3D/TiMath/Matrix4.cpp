@@ -0,0 +1,548 @@
+#include "Matrix4.h"
+#include <algorithm>
+#include <iomanip>
+#include "Vector4.h"
+#include "Quaternion.h"
+#include <tuple>
+#include <type_traits>
+#include "TiMathConfig.h"
+#include "TiMathError.h"
+#include "TiMathSIMD.h"
+
+namespace TiMath {
+
+namespace {
+
+// The builders below validate their input and fill `result` only on success. The plain
+// entry points turn a failure into identity plus reportError; the try* ones into nullopt.
+template <typename T>
+inline Matrix4T<T> valueOrIdentity(MathStatus status, const Matrix4T<T>& value) {
+    if (status != MathStatus::Ok) {
+        reportError(status);
+        return Matrix4T<T>::getIdentity();
+    }
+    return value;
+}
+
+template <typename T>
+inline std::optional<Matrix4T<T>> valueIfOk(MathStatus status, const Matrix4T<T>& value) {
+    if (status != MathStatus::Ok) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+} // namespace
+
+template <typename T>
+void Matrix4T<T>::loadIdentity() {
+    std::fill(m.begin(), m.end(), 0.0f);
+    m[0] = m[5] = m[10] = m[15] = 1.0f;
+}
+
+namespace {
+
+template <typename T>
+MathStatus buildRotationAxis(const Vector3T<T>& axis, T angleDegrees, Matrix4T<T>& result) {
+    Vector3T<T> a = axis.normalized();
+    if (a.isZero()) {
+        return MathStatus::ZeroAxis;
+    }
+    T angle = angleDegrees * PI_T<T> / 180.0f;
+    T c = std::cos(angle);
+    T s = std::sin(angle);
+    T t = 1.0f - c;
+
+    result.m[0] = t * a.x * a.x + c;
+    result.m[1] = t * a.x * a.y + s * a.z;
+    result.m[2] = t * a.x * a.z - s * a.y;
+    result.m[3] = 0.0f;
+
+    result.m[4] = t * a.x * a.y - s * a.z;
+    result.m[5] = t * a.y * a.y + c;
+    result.m[6] = t * a.y * a.z + s * a.x;
+    result.m[7] = 0.0f;
+
+    result.m[8] = t * a.x * a.z + s * a.y;
+    result.m[9] = t * a.y * a.z - s * a.x;
+    result.m[10] = t * a.z * a.z + c;
+    result.m[11] = 0.0f;
+
+    result.m[12] = 0.0f;
+    result.m[13] = 0.0f;
+    result.m[14] = 0.0f;
+    result.m[15] = 1.0f;
+    return MathStatus::Ok;
+}
+
+} // namespace
+
+template <typename T>
+Matrix4T<T> Matrix4T<T>::rotationAxis(const Vector3T<T>& axis, T angleDegrees) {
+    Matrix4T<T> result;
+    return valueOrIdentity(buildRotationAxis(axis, angleDegrees, result), result);
+}
+
+template <typename T>
+std::optional<Matrix4T<T>> Matrix4T<T>::tryRotationAxis(const Vector3T<T>& axis, T angleDegrees) {
+    Matrix4T<T> result;
+    return valueIfOk(buildRotationAxis(axis, angleDegrees, result), result);
+}
+
+namespace {
+
+template <typename T>
+MathStatus buildPerspective(T fovYDegrees, T aspect, T zNear, T zFar, Matrix4T<T>& result) {
+    if (std::fabs(aspect) < EPSILON || std::fabs(zNear - zFar) < EPSILON) {
+        return MathStatus::InvalidPerspective;
+    }
+    T f = 1.0f / std::tan(fovYDegrees * PI_T<T> / 360.0f);
+    result.m[0] = f / aspect;
+    result.m[5] = f;
+    result.m[10] = (zFar + zNear) / (zNear - zFar);
+    result.m[11] = -1.0f;
+    result.m[14] = (2.0f * zFar * zNear) / (zNear - zFar);
+    result.m[1] = result.m[2] = result.m[3] = result.m[4] =
+    result.m[6] = result.m[7] = result.m[8] = result.m[9] =
+    result.m[12] = result.m[13] = result.m[15] = 0.0f;
+    return MathStatus::Ok;
+}
+
+} // namespace
+
+template <typename T>
+Matrix4T<T> Matrix4T<T>::perspective(T fovYDegrees, T aspect, T zNear, T zFar) {
+    Matrix4T<T> result;
+    return valueOrIdentity(buildPerspective(fovYDegrees, aspect, zNear, zFar, result), result);
+}
+
+template <typename T>
+std::optional<Matrix4T<T>> Matrix4T<T>::tryPerspective(T fovYDegrees, T aspect, T zNear, T zFar) {
+    Matrix4T<T> result;
+    return valueIfOk(buildPerspective(fovYDegrees, aspect, zNear, zFar, result), result);
+}
+
+namespace {
+
+template <typename T>
+MathStatus buildFrustum(T left, T right, T bottom, T top, T zNear, T zFar, Matrix4T<T>& result) {
+    if (std::fabs(right - left) < EPSILON || std::fabs(top - bottom) < EPSILON || std::fabs(zNear - zFar) < EPSILON) {
+        return MathStatus::InvalidFrustum;
+    }
+    result.m[0] = (2.0f * zNear) / (right - left);
+    result.m[5] = (2.0f * zNear) / (top - bottom);
+    result.m[8] = (right + left) / (right - left);
+    result.m[9] = (top + bottom) / (top - bottom);
+    result.m[10] = -(zFar + zNear) / (zFar - zNear);
+    result.m[11] = -1.0f;
+    result.m[14] = -(2.0f * zFar * zNear) / (zFar - zNear);
+    result.m[1] = result.m[2] = result.m[3] = result.m[4] =
+    result.m[6] = result.m[7] = result.m[12] = result.m[13] = result.m[15] = 0.0f;
+    return MathStatus::Ok;
+}
+
+} // namespace
+
+template <typename T>
+Matrix4T<T> Matrix4T<T>::frustum(T left, T right, T bottom, T top, T zNear, T zFar) {
+    Matrix4T<T> result;
+    return valueOrIdentity(buildFrustum(left, right, bottom, top, zNear, zFar, result), result);
+}
+
+template <typename T>
+std::optional<Matrix4T<T>> Matrix4T<T>::tryFrustum(T left, T right, T bottom, T top, T zNear, T zFar) {
+    Matrix4T<T> result;
+    return valueIfOk(buildFrustum(left, right, bottom, top, zNear, zFar, result), result);
+}
+
+namespace {
+
+template <typename T>
+MathStatus buildLookAt(const Vector3T<T>& eye, const Vector3T<T>& target, const Vector3T<T>& up, Matrix4T<T>& result) {
+    Vector3T<T> dir = (target - eye).normalized();
+    if (dir.isZero()) {
+        return MathStatus::ZeroLookDirection;
+    }
+    Vector3T<T> upNorm = up.normalized();
+    if (upNorm.isZero()) {
+        return MathStatus::ZeroUpVector;
+    }
+    Vector3T<T> right = dir.cross(upNorm).normalized();
+    if (right.isZero()) {
+        return MathStatus::ParallelUpVector;
+    }
+    Vector3T<T> newUp = right.cross(dir).normalized();
+
+    result.m[0] = right.x;  result.m[4] = right.y;  result.m[8] = right.z;
+    result.m[1] = newUp.x;  result.m[5] = newUp.y;  result.m[9] = newUp.z;
+    result.m[2] = -dir.x;   result.m[6] = -dir.y;   result.m[10] = -dir.z;
+    result.m[3] = 0.0f;     result.m[7] = 0.0f;     result.m[11] = 0.0f;    result.m[15] = 1.0f;
+    result.m[12] = -right.dot(eye);
+    result.m[13] = -newUp.dot(eye);
+    result.m[14] = dir.dot(eye);
+    return MathStatus::Ok;
+}
+
+} // namespace
+
+template <typename T>
+Matrix4T<T> Matrix4T<T>::lookAt(const Vector3T<T>& eye, const Vector3T<T>& target, const Vector3T<T>& up) {
+    Matrix4T<T> result;
+    return valueOrIdentity(buildLookAt(eye, target, up, result), result);
+}
+
+template <typename T>
+std::optional<Matrix4T<T>> Matrix4T<T>::tryLookAt(const Vector3T<T>& eye, const Vector3T<T>& target, const Vector3T<T>& up) {
+    Matrix4T<T> result;
+    return valueIfOk(buildLookAt(eye, target, up, result), result);
+}
+
+namespace {
+
+template <typename T>
+MathStatus invertScalar(const Matrix4T<T>& a, Matrix4T<T>& result);
+#if defined(TIMATH_SSE)
+MathStatus invertSIMD(const Matrix4& a, Matrix4& result);
+// The block inverse leans on 4-wide float shuffles; double keeps the cofactor path.
+inline MathStatus invertSIMD(const Matrix4d& a, Matrix4d& result) {
+    return invertScalar(a, result);
+}
+#endif
+
+template <typename T>
+inline MathStatus invert(const Matrix4T<T>& a, Matrix4T<T>& result) {
+#if defined(TIMATH_SSE)
+    return invertSIMD(a, result);
+#else
+    return invertScalar(a, result);
+#endif
+}
+
+} // namespace
+
+template <typename T>
+Matrix4T<T> Matrix4T<T>::inverse() const {
+    Matrix4T<T> result;
+    return valueOrIdentity(invert(*this, result), result);
+}
+
+template <typename T>
+std::optional<Matrix4T<T>> Matrix4T<T>::tryInverse() const {
+    Matrix4T<T> result;
+    return valueIfOk(invert(*this, result), result);
+}
+
+template <typename T>
+Matrix4T<T> Matrix4T<T>::inverseScalar(const Matrix4T<T>& a) {
+    Matrix4T<T> result;
+    return valueOrIdentity(invertScalar(a, result), result);
+}
+
+namespace {
+
+template <typename T>
+MathStatus invertScalar(const Matrix4T<T>& a, Matrix4T<T>& result) {
+    // Cofactor expansion over the twelve 2x2 minors of the upper and lower column pairs.
+    // aCR is column C, row R, i.e. m[C * 4 + R].
+    const std::array<T, 16>& m = a.m;
+    T a00 = m[0],  a01 = m[1],  a02 = m[2],  a03 = m[3];
+    T a10 = m[4],  a11 = m[5],  a12 = m[6],  a13 = m[7];
+    T a20 = m[8],  a21 = m[9],  a22 = m[10], a23 = m[11];
+    T a30 = m[12], a31 = m[13], a32 = m[14], a33 = m[15];
+
+    T b00 = a00 * a11 - a01 * a10;
+    T b01 = a00 * a12 - a02 * a10;
+    T b02 = a00 * a13 - a03 * a10;
+    T b03 = a01 * a12 - a02 * a11;
+    T b04 = a01 * a13 - a03 * a11;
+    T b05 = a02 * a13 - a03 * a12;
+    T b06 = a20 * a31 - a21 * a30;
+    T b07 = a20 * a32 - a22 * a30;
+    T b08 = a20 * a33 - a23 * a30;
+    T b09 = a21 * a32 - a22 * a31;
+    T b10 = a21 * a33 - a23 * a31;
+    T b11 = a22 * a33 - a23 * a32;
+
+    T det = b00 * b11 - b01 * b10 + b02 * b09 + b03 * b08 - b04 * b07 + b05 * b06;
+
+    if (std::fabs(det) < EPSILON) {
+        return MathStatus::SingularMatrix;
+    }
+    T invDet = 1.0f / det;
+
+    result.m[0]  = (a11 * b11 - a12 * b10 + a13 * b09) * invDet;
+    result.m[1]  = (a02 * b10 - a01 * b11 - a03 * b09) * invDet;
+    result.m[2]  = (a31 * b05 - a32 * b04 + a33 * b03) * invDet;
+    result.m[3]  = (a22 * b04 - a21 * b05 - a23 * b03) * invDet;
+
+    result.m[4]  = (a12 * b08 - a10 * b11 - a13 * b07) * invDet;
+    result.m[5]  = (a00 * b11 - a02 * b08 + a03 * b07) * invDet;
+    result.m[6]  = (a32 * b02 - a30 * b05 - a33 * b01) * invDet;
+    result.m[7]  = (a20 * b05 - a22 * b02 + a23 * b01) * invDet;
+
+    result.m[8]  = (a10 * b10 - a11 * b08 + a13 * b06) * invDet;
+    result.m[9]  = (a01 * b08 - a00 * b10 - a03 * b06) * invDet;
+    result.m[10] = (a30 * b04 - a31 * b02 + a33 * b00) * invDet;
+    result.m[11] = (a21 * b02 - a20 * b04 - a23 * b00) * invDet;
+
+    result.m[12] = (a11 * b07 - a10 * b09 - a12 * b06) * invDet;
+    result.m[13] = (a00 * b09 - a01 * b07 + a02 * b06) * invDet;
+    result.m[14] = (a31 * b01 - a30 * b03 - a32 * b00) * invDet;
+    result.m[15] = (a20 * b03 - a21 * b01 + a22 * b00) * invDet;
+    return MathStatus::Ok;
+}
+
+#if defined(TIMATH_SSE)
+
+// 2x2 helpers for the block inverse. A 2x2 matrix is packed as (m00, m01, m10, m11).
+// a * b
+inline __m128 mat2Mul(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, simd::swizzle<0, 3, 0, 3>(b)),
+                      _mm_mul_ps(simd::swizzle<1, 0, 3, 2>(a), simd::swizzle<2, 1, 2, 1>(b)));
+}
+
+// adj(a) * b
+inline __m128 mat2AdjMul(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(simd::swizzle<3, 3, 0, 0>(a), b),
+                      _mm_mul_ps(simd::swizzle<1, 1, 2, 2>(a), simd::swizzle<2, 3, 0, 1>(b)));
+}
+
+// a * adj(b)
+inline __m128 mat2MulAdj(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, simd::swizzle<3, 0, 3, 0>(b)),
+                      _mm_mul_ps(simd::swizzle<1, 0, 3, 2>(a), simd::swizzle<2, 1, 2, 1>(b)));
+}
+
+MathStatus invertSIMD(const Matrix4& a, Matrix4& result) {
+    // Block inverse over 2x2 sub-matrices [A B; C D]. The registers hold columns, so the
+    // algorithm sees the transpose; inv(M^T) = inv(M)^T, and storing its rows as our columns
+    // gives inv(M) back in column-major order.
+    const __m128 c0 = _mm_load_ps(&a.m[0]);
+    const __m128 c1 = _mm_load_ps(&a.m[4]);
+    const __m128 c2 = _mm_load_ps(&a.m[8]);
+    const __m128 c3 = _mm_load_ps(&a.m[12]);
+
+    const __m128 A = _mm_movelh_ps(c0, c1);
+    const __m128 B = _mm_movehl_ps(c1, c0);
+    const __m128 C = _mm_movelh_ps(c2, c3);
+    const __m128 D = _mm_movehl_ps(c3, c2);
+
+    // (|A|, |B|, |C|, |D|)
+    const __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(simd::shuffle<0, 2, 0, 2>(c0, c2), simd::shuffle<1, 3, 1, 3>(c1, c3)),
+        _mm_mul_ps(simd::shuffle<1, 3, 1, 3>(c0, c2), simd::shuffle<0, 2, 0, 2>(c1, c3)));
+    const __m128 detA = simd::splat<0>(detSub);
+    const __m128 detB = simd::splat<1>(detSub);
+    const __m128 detC = simd::splat<2>(detSub);
+    const __m128 detD = simd::splat<3>(detSub);
+
+    const __m128 dc = mat2AdjMul(D, C);
+    const __m128 ab = mat2AdjMul(A, B);
+    __m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), mat2Mul(B, dc));
+    __m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), mat2Mul(C, ab));
+    __m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), mat2MulAdj(D, ab));
+    __m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), mat2MulAdj(A, dc));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 detM = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+    detM = _mm_sub_ps(detM, simd::sumAll(_mm_mul_ps(ab, simd::swizzle<0, 2, 1, 3>(dc))));
+
+    if (std::fabs(_mm_cvtss_f32(detM)) < EPSILON) {
+        return MathStatus::SingularMatrix;
+    }
+
+    const __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    X = _mm_mul_ps(X, rDetM);
+    Y = _mm_mul_ps(Y, rDetM);
+    Z = _mm_mul_ps(Z, rDetM);
+    W = _mm_mul_ps(W, rDetM);
+
+    // The adjugate shuffle and the store shuffle fold into one.
+    _mm_store_ps(&result.m[0], simd::shuffle<3, 1, 3, 1>(X, Y));
+    _mm_store_ps(&result.m[4], simd::shuffle<2, 0, 2, 0>(X, Y));
+    _mm_store_ps(&result.m[8], simd::shuffle<3, 1, 3, 1>(Z, W));
+    _mm_store_ps(&result.m[12], simd::shuffle<2, 0, 2, 0>(Z, W));
+    return MathStatus::Ok;
+}
+#endif // TIMATH_SSE
+
+} // namespace
+
+#if defined(TIMATH_SSE)
+template <typename T>
+Matrix4T<T> Matrix4T<T>::inverseSIMD(const Matrix4T<T>& a) {
+    Matrix4T<T> result;
+    return valueOrIdentity(invertSIMD(a, result), result);
+}
+#endif // TIMATH_SSE
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const Matrix4T<T>& mat) {
+    os << std::fixed << std::setprecision(4);
+    os << "[" << mat.m[0]  << ", " << mat.m[4]  << ", " << mat.m[8]  << ", " << mat.m[12] << "]\n";
+    os << "[" << mat.m[1]  << ", " << mat.m[5]  << ", " << mat.m[9]  << ", " << mat.m[13] << "]\n";
+    os << "[" << mat.m[2]  << ", " << mat.m[6]  << ", " << mat.m[10] << ", " << mat.m[14] << "]\n";
+    os << "[" << mat.m[3]  << ", " << mat.m[7]  << ", " << mat.m[11] << ", " << mat.m[15] << "]";
+    return os;
+}
+
+template <typename T>
+Vector4T<T> operator*(const Matrix4T<T>& m, const Vector4T<T>& v) {
+#if defined(TIMATH_SSE)
+    return Matrix4T<T>::transformSIMD(m, v);
+#else
+    return Matrix4T<T>::transformScalar(m, v);
+#endif
+}
+
+template <typename T>
+Vector4T<T> Matrix4T<T>::transformScalar(const Matrix4T<T>& m, const Vector4T<T>& v) {
+    return Vector4T<T>(
+        m.m[0] * v.x + m.m[4] * v.y + m.m[8] * v.z + m.m[12] * v.w,
+        m.m[1] * v.x + m.m[5] * v.y + m.m[9] * v.z + m.m[13] * v.w,
+        m.m[2] * v.x + m.m[6] * v.y + m.m[10] * v.z + m.m[14] * v.w,
+        m.m[3] * v.x + m.m[7] * v.y + m.m[11] * v.z + m.m[15] * v.w
+    );
+}
+
+#if defined(TIMATH_SSE)
+template <typename T>
+Vector4T<T> Matrix4T<T>::transformSIMD(const Matrix4T<T>& m, const Vector4T<T>& v) {
+    using Col = simd::Column<T>;
+    Col r = Col::load(&m.m[0]) * Col::set1(v.x) + Col::load(&m.m[4]) * Col::set1(v.y) +
+            Col::load(&m.m[8]) * Col::set1(v.z) + Col::load(&m.m[12]) * Col::set1(v.w);
+    alignas(4 * sizeof(T)) T out[4];
+    r.store(out);
+    return Vector4T<T>(out[0], out[1], out[2], out[3]);
+}
+#endif // TIMATH_SSE
+
+template <typename T>
+QuaternionT<T> Matrix4T<T>::toQuaternion() const {
+    T trace = m[0] + m[5] + m[10];
+    if (trace > 0.0f) {
+        T s = 0.5f / std::sqrt(trace + 1.0f);
+        return QuaternionT<T>(
+            (m[6] - m[9]) * s,
+            (m[8] - m[2]) * s,
+            (m[1] - m[4]) * s,
+            0.25f / s
+        );
+    } else if (m[0] > m[5] && m[0] > m[10]) {
+        T s = 0.5f / std::sqrt(1.0f + m[0] - m[5] - m[10]);
+        return QuaternionT<T>(
+            0.25f / s,
+            (m[4] + m[1]) * s,
+            (m[8] + m[2]) * s,
+            (m[6] - m[9]) * s
+        );
+    } else if (m[5] > m[10]) {
+        T s = 0.5f / std::sqrt(1.0f + m[5] - m[0] - m[10]);
+        return QuaternionT<T>(
+            (m[4] + m[1]) * s,
+            0.25f / s,
+            (m[9] + m[6]) * s,
+            (m[8] - m[2]) * s
+        );
+    } else {
+        T s = 0.5f / std::sqrt(1.0f + m[10] - m[0] - m[5]);
+        return QuaternionT<T>(
+            (m[8] + m[2]) * s,
+            (m[9] + m[6]) * s,
+            0.25f / s,
+            (m[1] - m[4]) * s
+        );
+    }
+}
+
+namespace {
+
+// Fills translation even on failure so decompose() can keep returning it with default rotation/scale.
+template <typename T>
+MathStatus decomposeInto(const Matrix4T<T>& mat, Vector3T<T>& translation, QuaternionT<T>& rotation, Vector3T<T>& scaling) {
+    const std::array<T, 16>& m = mat.m;
+
+    // Extract translation from the last column
+    translation = Vector3T<T>(m[12], m[13], m[14]);
+
+    // Extract the 3x3 submatrix (columns 0, 1, 2)
+    Vector3T<T> col0(m[0], m[1], m[2]);
+    Vector3T<T> col1(m[4], m[5], m[6]);
+    Vector3T<T> col2(m[8], m[9], m[10]);
+
+    // Compute scaling factors (length of each column)
+    T scaleX = col0.length();
+    T scaleY = col1.length();
+    T scaleZ = col2.length();
+
+    // Check for near-zero scaling factors
+    if (scaleX < EPSILON || scaleY < EPSILON || scaleZ < EPSILON) {
+        return MathStatus::DegenerateScale;
+    }
+
+    // Check for negative scaling by computing the determinant
+    Matrix4T<T> rotationMatrix = mat;
+    T det = m[0] * (m[5] * m[10] - m[9] * m[6]) -
+                m[4] * (m[1] * m[10] - m[9] * m[2]) +
+                m[8] * (m[1] * m[6] - m[5] * m[2]);
+    bool negativeScale = det < 0.0f;
+
+    // Normalize columns to isolate rotation matrix
+    rotationMatrix.m[0] /= scaleX;
+    rotationMatrix.m[1] /= scaleX;
+    rotationMatrix.m[2] /= scaleX;
+    rotationMatrix.m[4] /= scaleY;
+    rotationMatrix.m[5] /= scaleY;
+    rotationMatrix.m[6] /= scaleY;
+    rotationMatrix.m[8] /= scaleZ;
+    rotationMatrix.m[9] /= scaleZ;
+    rotationMatrix.m[10] /= scaleZ;
+
+    // Adjust for negative scaling
+    if (negativeScale) {
+        scaleX = -scaleX;
+        rotationMatrix.m[0] = -rotationMatrix.m[0];
+        rotationMatrix.m[1] = -rotationMatrix.m[1];
+        rotationMatrix.m[2] = -rotationMatrix.m[2];
+    }
+
+    // Convert rotation matrix to quaternion
+    rotation = rotationMatrix.toQuaternion();
+
+    // Return scaling factors
+    scaling = Vector3T<T>(scaleX, scaleY, scaleZ);
+    return MathStatus::Ok;
+}
+
+} // namespace
+
+template <typename T>
+std::tuple<Vector3T<T>, QuaternionT<T>, Vector3T<T>> Matrix4T<T>::decompose() const {
+    Vector3T<T> translation, scaling;
+    QuaternionT<T> rotation;
+    MathStatus status = decomposeInto(*this, translation, rotation, scaling);
+    if (status != MathStatus::Ok) {
+        reportError(status);
+        return {translation, QuaternionT<T>::identity, Vector3T<T>(1.0f, 1.0f, 1.0f)};
+    }
+    return {translation, rotation, scaling};
+}
+
+template <typename T>
+std::optional<std::tuple<Vector3T<T>, QuaternionT<T>, Vector3T<T>>> Matrix4T<T>::tryDecompose() const {
+    Vector3T<T> translation, scaling;
+    QuaternionT<T> rotation;
+    if (decomposeInto(*this, translation, rotation, scaling) != MathStatus::Ok) {
+        return std::nullopt;
+    }
+    return std::make_tuple(translation, rotation, scaling);
+}
+
+template class Matrix4T<float>;
+template class Matrix4T<double>;
+template std::ostream& operator<<(std::ostream&, const Matrix4T<float>&);
+template std::ostream& operator<<(std::ostream&, const Matrix4T<double>&);
+template Vector4T<float> operator*(const Matrix4T<float>&, const Vector4T<float>&);
+template Vector4T<double> operator*(const Matrix4T<double>&, const Vector4T<double>&);
+
+} // namespace TiMath
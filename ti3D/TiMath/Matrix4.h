@@ -0,0 +1,405 @@
+#ifndef MATRIX4_H
+#define MATRIX4_H
+
+#include <array>
+#include <cmath>
+#include <optional>
+#include <ostream>
+#include <tuple>
+#include <type_traits>
+#include "TiMathConfig.h"
+#include "TiMathConstexpr.h"
+#include "TiMathError.h"
+#include "TiMathFwd.h"
+#include "TiMathSIMD.h"
+#include "Vector3.h"
+
+namespace TiMath {
+
+/**
+ * @class Matrix4T
+ * @brief A 4x4 matrix class for 3D transformations (column-major order), templated on the
+ *        scalar type; Matrix4 is the float instantiation and Matrix4d the double one.
+ */
+template <typename T>
+class Matrix4T {
+public:
+    using value_type = T;
+
+    alignas(4 * sizeof(T)) std::array<T, 16> m; // Column-major order, columns aligned for SIMD loads
+
+    // Default constructor: initializes to identity matrix
+    constexpr Matrix4T() : m{1.0f, 0.0f, 0.0f, 0.0f,
+                            0.0f, 1.0f, 0.0f, 0.0f,
+                            0.0f, 0.0f, 1.0f, 0.0f,
+                            0.0f, 0.0f, 0.0f, 1.0f} {}
+
+    /** @brief Converts from another scalar type, e.g. Matrix4d to Matrix4. */
+    template <typename U>
+    explicit constexpr Matrix4T(const Matrix4T<U>& other) : m{} {
+        for (int i = 0; i < 16; ++i) {
+            m[i] = static_cast<T>(other.m[i]);
+        }
+    }
+
+    /**
+     * @brief Loads the identity matrix.
+     */
+    void loadIdentity();
+
+    /**
+     * @brief Returns the identity matrix.
+     * @return A 4x4 identity matrix.
+     */
+    [[nodiscard]] static constexpr Matrix4T getIdentity() {
+        return Matrix4T();
+    }
+
+    // Whether operator* runs multiplySIMD at runtime. Only where it beats the scalar loop,
+    // which the compiler inlines and vectorizes: with AVX, for float and double alike. The
+    // SSE2 kernels (one __m128, or a pair of __m128d for double) merely tie with it.
+#if defined(TIMATH_AVX)
+    static constexpr bool SIMD_MULTIPLY = true;
+#else
+    static constexpr bool SIMD_MULTIPLY = false;
+#endif
+
+    /**
+     * @brief Multiplies this matrix by another. Usable in constant expressions; at runtime
+     *        it dispatches to the SIMD kernel where SIMD_MULTIPLY is set.
+     * @param other The matrix to multiply with.
+     * @return The resulting matrix.
+     */
+    [[nodiscard]] constexpr Matrix4T operator*(const Matrix4T& other) const {
+#if defined(TIMATH_SSE)
+        if (SIMD_MULTIPLY && !TIMATH_IS_CONSTANT_EVALUATED()) {
+            return multiplySIMD(*this, other);
+        }
+#endif
+        return multiplyScalar(*this, other);
+    }
+
+    /**
+     * @brief Creates a translation matrix.
+     * @param v The translation vector.
+     * @return A 4x4 translation matrix.
+     */
+    [[nodiscard]] static constexpr Matrix4T translation(const Vector3T<T>& v) {
+        Matrix4T result;
+        result.m[12] = v.x;
+        result.m[13] = v.y;
+        result.m[14] = v.z;
+        return result;
+    }
+
+    /**
+     * @brief Creates a rotation matrix from an axis and angle.
+     * @param axis The rotation axis (must be non-zero).
+     * @param angleDegrees The rotation angle in degrees.
+     * @return A 4x4 rotation matrix.
+     */
+    [[nodiscard]] static Matrix4T rotationAxis(const Vector3T<T>& axis, T angleDegrees);
+
+    /** @brief Like rotationAxis, but returns std::nullopt for a zero-length axis without reporting it. */
+    [[nodiscard]] static std::optional<Matrix4T> tryRotationAxis(const Vector3T<T>& axis, T angleDegrees);
+
+    /**
+     * @brief Creates a rotation about the X axis; constexpr, so fixed angles fold at compile time.
+     * @param angleDegrees The rotation angle in degrees.
+     * @return A 4x4 rotation matrix.
+     */
+    [[nodiscard]] static constexpr Matrix4T rotationX(T angleDegrees) {
+        T c = cx::cosDegrees(angleDegrees);
+        T s = cx::sinDegrees(angleDegrees);
+        Matrix4T result;
+        result.m[5] = c;  result.m[9] = -s;
+        result.m[6] = s;  result.m[10] = c;
+        return result;
+    }
+
+    /**
+     * @brief Creates a rotation about the Y axis; constexpr, so fixed angles fold at compile time.
+     * @param angleDegrees The rotation angle in degrees.
+     * @return A 4x4 rotation matrix.
+     */
+    [[nodiscard]] static constexpr Matrix4T rotationY(T angleDegrees) {
+        T c = cx::cosDegrees(angleDegrees);
+        T s = cx::sinDegrees(angleDegrees);
+        Matrix4T result;
+        result.m[0] = c;  result.m[8] = s;
+        result.m[2] = -s; result.m[10] = c;
+        return result;
+    }
+
+    /**
+     * @brief Creates a rotation about the Z axis; constexpr, so fixed angles fold at compile time.
+     * @param angleDegrees The rotation angle in degrees.
+     * @return A 4x4 rotation matrix.
+     */
+    [[nodiscard]] static constexpr Matrix4T rotationZ(T angleDegrees) {
+        T c = cx::cosDegrees(angleDegrees);
+        T s = cx::sinDegrees(angleDegrees);
+        Matrix4T result;
+        result.m[0] = c;  result.m[4] = -s;
+        result.m[1] = s;  result.m[5] = c;
+        return result;
+    }
+
+    /**
+     * @brief Creates a scaling matrix.
+     * @param s The scaling factors for x, y, z.
+     * @return A 4x4 scaling matrix.
+     */
+    [[nodiscard]] static constexpr Matrix4T scaling(const Vector3T<T>& s) {
+        Matrix4T result;
+        result.m[0] = s.x;
+        result.m[5] = s.y;
+        result.m[10] = s.z;
+        return result;
+    }
+
+    /**
+     * @brief Creates a perspective projection matrix.
+     * @param fovYDegrees Vertical field of view in degrees.
+     * @param aspect Aspect ratio (width/height).
+     * @param zNear Near clipping plane.
+     * @param zFar Far clipping plane.
+     * @return A 4x4 perspective projection matrix.
+     */
+    [[nodiscard]] static Matrix4T perspective(T fovYDegrees, T aspect, T zNear, T zFar);
+
+    /** @brief Like perspective, but returns std::nullopt for invalid parameters without reporting them. */
+    [[nodiscard]] static std::optional<Matrix4T> tryPerspective(T fovYDegrees, T aspect, T zNear, T zFar);
+
+    /**
+     * @brief Creates an orthographic projection matrix.
+     * @param left Left plane coordinate.
+     * @param right Right plane coordinate.
+     * @param bottom Bottom plane coordinate.
+     * @param top Top plane coordinate.
+     * @param near Near clipping plane.
+     * @param far Far clipping plane.
+     * @return A 4x4 orthographic projection matrix.
+     */
+    [[nodiscard]] static constexpr Matrix4T orthographic(T left, T right, T bottom, T top, T near, T far) {
+        Matrix4T result;
+        result.m[0] = 2.0f / (right - left);
+        result.m[5] = 2.0f / (top - bottom);
+        result.m[10] = -2.0f / (far - near);
+        result.m[12] = -(right + left) / (right - left);
+        result.m[13] = -(top + bottom) / (top - bottom);
+        result.m[14] = -(far + near) / (far - near);
+        return result;
+    }
+
+    /**
+     * @brief Creates a frustum projection matrix.
+     * @param left Left plane coordinate.
+     * @param right Right plane coordinate.
+     * @param bottom Bottom plane coordinate.
+     * @param top Top plane coordinate.
+     * @param zNear Near clipping plane.
+     * @param zFar Far clipping plane.
+     * @return A 4x4 frustum projection matrix.
+     */
+    [[nodiscard]] static Matrix4T frustum(T left, T right, T bottom, T top, T zNear, T zFar);
+
+    /** @brief Like frustum, but returns std::nullopt for invalid parameters without reporting them. */
+    [[nodiscard]] static std::optional<Matrix4T> tryFrustum(T left, T right, T bottom, T top, T zNear, T zFar);
+
+    /**
+     * @brief Creates a viewport transformation matrix.
+     * @param x Leftmost pixel of the viewport.
+     * @param y Bottommost pixel of the viewport.
+     * @param width Width of the viewport in pixels.
+     * @param height Height of the viewport in pixels.
+     * @param zNear Near depth value (typically 0.0).
+     * @param zFar Far depth value (typically 1.0).
+     * @return A 4x4 viewport transformation matrix.
+     */
+    [[nodiscard]] static constexpr Matrix4T viewport(T x, T y, T width, T height, T zNear, T zFar) {
+        std::optional<Matrix4T> result = tryViewport(x, y, width, height, zNear, zFar);
+        if (!result) {
+            reportError(MathStatus::InvalidViewport);
+            return getIdentity();
+        }
+        return *result;
+    }
+
+    /** @brief Like viewport, but returns std::nullopt for a zero-sized viewport without reporting it. */
+    [[nodiscard]] static constexpr std::optional<Matrix4T> tryViewport(T x, T y, T width, T height, T zNear, T zFar) {
+        if (cx::abs(width) < EPSILON_T<T> || cx::abs(height) < EPSILON_T<T>) {
+            return std::nullopt;
+        }
+        Matrix4T result;
+        result.m[0] = width / 2.0f;
+        result.m[5] = height / 2.0f;
+        result.m[10] = (zFar - zNear) / 2.0f;
+        result.m[12] = x + width / 2.0f;
+        result.m[13] = y + height / 2.0f;
+        result.m[14] = (zFar + zNear) / 2.0f;
+        return result;
+    }
+
+    /**
+     * @brief Creates a look-at view matrix.
+     * @param eye The camera position.
+     * @param target The target point to look at.
+     * @param up The up vector (must be non-zero).
+     * @return A 4x4 view matrix.
+     */
+    [[nodiscard]] static Matrix4T lookAt(const Vector3T<T>& eye, const Vector3T<T>& target, const Vector3T<T>& up);
+
+    /** @brief Like lookAt, but returns std::nullopt for degenerate directions without reporting them. */
+    [[nodiscard]] static std::optional<Matrix4T> tryLookAt(const Vector3T<T>& eye, const Vector3T<T>& target, const Vector3T<T>& up);
+
+    /**
+     * @brief Transforms a point (w = 1) by the affine part of the matrix; the bottom row is ignored.
+     * @param p The point.
+     * @return The transformed point.
+     */
+    [[nodiscard]] constexpr Vector3T<T> transformPoint(const Vector3T<T>& p) const {
+        return Vector3T<T>(m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12],
+                       m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13],
+                       m[2] * p.x + m[6] * p.y + m[10] * p.z + m[14]);
+    }
+
+    /**
+     * @brief Transforms a direction (w = 0) by the upper 3x3 of the matrix; translation is ignored.
+     * @param d The direction.
+     * @return The transformed direction.
+     */
+    [[nodiscard]] constexpr Vector3T<T> transformDirection(const Vector3T<T>& d) const {
+        return Vector3T<T>(m[0] * d.x + m[4] * d.y + m[8] * d.z,
+                       m[1] * d.x + m[5] * d.y + m[9] * d.z,
+                       m[2] * d.x + m[6] * d.y + m[10] * d.z);
+    }
+
+    /**
+     * @brief Computes the inverse of the matrix.
+     * @return The inverse matrix, or identity if it is singular (reported per TIMATH_ERROR_POLICY).
+     */
+    [[nodiscard]] Matrix4T inverse() const;
+
+    /**
+     * @brief Computes the inverse of the matrix without reporting failures.
+     * @return The inverse matrix, or std::nullopt if it is singular.
+     */
+    [[nodiscard]] std::optional<Matrix4T> tryInverse() const;
+
+    // Kernel entry points. inverse() and Matrix4 * Vector4 dispatch to the SIMD variants when
+    // TIMATH_SSE is defined, operator* where SIMD_MULTIPLY is set; the scalar versions stay
+    // the reference path.
+    /** @brief Scalar reference for a * b. */
+    [[nodiscard]] static constexpr Matrix4T multiplyScalar(const Matrix4T& a, const Matrix4T& b) {
+        Matrix4T result;
+        for (int row = 0; row < 4; ++row) {
+            for (int col = 0; col < 4; ++col) {
+                result.m[col * 4 + row] =
+                    a.m[0 * 4 + row] * b.m[col * 4 + 0] +
+                    a.m[1 * 4 + row] * b.m[col * 4 + 1] +
+                    a.m[2 * 4 + row] * b.m[col * 4 + 2] +
+                    a.m[3 * 4 + row] * b.m[col * 4 + 3];
+            }
+        }
+        return result;
+    }
+    /** @brief Scalar reference for a.inverse(). */
+    [[nodiscard]] static Matrix4T inverseScalar(const Matrix4T& a);
+    /** @brief Scalar reference for m * v. */
+    [[nodiscard]] static Vector4T<T> transformScalar(const Matrix4T& m, const Vector4T<T>& v);
+#if defined(TIMATH_SSE)
+    /** @brief SIMD version of a * b: 4-wide float (two columns at a time with AVX), 2- or 4-wide double. */
+    [[nodiscard]] static Matrix4T multiplySIMD(const Matrix4T& a, const Matrix4T& b);
+    /** @brief SSE block-wise (2x2 adjugate) version of a.inverse(); double runs the scalar cofactor path. */
+    [[nodiscard]] static Matrix4T inverseSIMD(const Matrix4T& a);
+    /** @brief SIMD version of m * v. */
+    [[nodiscard]] static Vector4T<T> transformSIMD(const Matrix4T& m, const Vector4T<T>& v);
+#endif
+
+    /**
+     * @brief Converts the matrix to a quaternion representing its rotation component.
+     * @return The rotation as a quaternion.
+     */
+    [[nodiscard]] QuaternionT<T> toQuaternion() const;
+
+    /**
+     * @brief Decomposes the matrix into translation, rotation (as a quaternion), and scaling components.
+     * @return A tuple containing the translation (Vector3T<T>), rotation (QuaternionT<T>), and scaling (Vector3T<T>).
+     */
+    [[nodiscard]] std::tuple<Vector3T<T>, QuaternionT<T>, Vector3T<T>> decompose() const;
+
+    /**
+     * @brief Like decompose, but returns std::nullopt for a near-zero scale without reporting it.
+     * @return The translation, rotation and scaling, or std::nullopt.
+     */
+    [[nodiscard]] std::optional<std::tuple<Vector3T<T>, QuaternionT<T>, Vector3T<T>>> tryDecompose() const;
+
+    /**
+     * @brief Returns the matrix as an array for graphics APIs.
+     * @return A pointer to the column-major array.
+     */
+    [[nodiscard]] const T* toArray() const {
+        return m.data();
+    }
+
+    /**
+     * @brief Returns a pointer to the matrix data for OpenGL compatibility.
+     * @return A pointer to the column-major array.
+     */
+    [[nodiscard]] const T* data() const {
+        return m.data();
+    }
+
+};
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const Matrix4T<T>& mat);
+
+#if defined(TIMATH_SSE)
+// Inline so that operator* can fold it into the caller; called out of line it lost to the
+// scalar loop, which the compiler inlines and vectorizes itself.
+template <typename T>
+inline Matrix4T<T> Matrix4T<T>::multiplySIMD(const Matrix4T<T>& a, const Matrix4T<T>& b) {
+    Matrix4T<T> result;
+#if defined(TIMATH_AVX)
+    if constexpr (std::is_same_v<T, float>) {
+        // Two result columns per iteration: each column of a is duplicated into both 128-bit lanes,
+        // and the in-lane shuffles broadcast b's coefficients for the matching column.
+        const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a.m[0]));
+        const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a.m[4]));
+        const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a.m[8]));
+        const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a.m[12]));
+        for (int col = 0; col < 4; col += 2) {
+            __m256 bc = _mm256_loadu_ps(&b.m[col * 4]);
+            __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(bc, bc, 0x00));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_shuffle_ps(bc, bc, 0x55)));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_shuffle_ps(bc, bc, 0xAA)));
+            r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_shuffle_ps(bc, bc, 0xFF)));
+            _mm256_storeu_ps(&result.m[col * 4], r);
+        }
+        return result;
+    }
+#endif
+    // One result column per iteration: a linear combination of a's columns weighted by b's.
+    using Col = simd::Column<T>;
+    const Col a0 = Col::load(&a.m[0]);
+    const Col a1 = Col::load(&a.m[4]);
+    const Col a2 = Col::load(&a.m[8]);
+    const Col a3 = Col::load(&a.m[12]);
+    for (int col = 0; col < 4; ++col) {
+        const T* bc = &b.m[col * 4];
+        Col r = a0 * Col::set1(bc[0]) + a1 * Col::set1(bc[1]) + a2 * Col::set1(bc[2]) + a3 * Col::set1(bc[3]);
+        r.store(&result.m[col * 4]);
+    }
+    return result;
+}
+#endif // TIMATH_SSE
+
+/** @brief Transforms a homogeneous vector, m * v; SIMD when TIMATH_SSE is defined. */
+template <typename T>
+[[nodiscard]] Vector4T<T> operator*(const Matrix4T<T>& m, const Vector4T<T>& v);
+
+} // namespace TiMath
+
+#endif // MATRIX4_H
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef TIMATH_PARALLEL_H
+#define TIMATH_PARALLEL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace TiMath {
+
+/**
+ * @brief Splits [0, count) into contiguous chunks and runs fn(begin, end) on each, one chunk per thread.
+ * @param count Number of elements.
+ * @param minChunk Smallest chunk worth a thread; below 2 * minChunk the call runs inline.
+ * @param fn Callable taking (std::size_t begin, std::size_t end).
+ *
+ * Chunk boundaries are rounded to multiples of 16 so SIMD loops only see a tail in the last chunk.
+ */
+template <typename Fn>
+void parallelFor(std::size_t count, std::size_t minChunk, Fn&& fn) {
+    unsigned int hw = std::thread::hardware_concurrency();
+    std::size_t workers = std::min<std::size_t>(hw ? hw : 1, count / std::max<std::size_t>(minChunk, 1));
+    if (workers <= 1) {
+        fn(std::size_t(0), count);
+        return;
+    }
+
+    std::size_t chunk = (count + workers - 1) / workers;
+    chunk = (chunk + 15) & ~std::size_t(15);
+
+    std::vector<std::thread> threads;
+    threads.reserve(workers - 1);
+    for (std::size_t begin = chunk; begin < count; begin += chunk) {
+        std::size_t end = std::min(count, begin + chunk);
+        threads.emplace_back([&fn, begin, end]() { fn(begin, end); });
+    }
+    fn(std::size_t(0), std::min(chunk, count));
+    for (std::thread& t : threads) {
+        t.join();
+    }
+}
+
+} // namespace TiMath
+
+#endif // TIMATH_PARALLEL_H
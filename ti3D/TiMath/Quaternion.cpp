@@ -0,0 +1,17 @@
+#include "Quaternion.h"
+#include <cmath>
+
+namespace TiMath {
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const QuaternionT<T>& q) {
+    os << "(" << q.x << ", " << q.y << ", " << q.z << ", " << q.w << ")";
+    return os;
+}
+
+template class QuaternionT<float>;
+template class QuaternionT<double>;
+template std::ostream& operator<<(std::ostream&, const QuaternionT<float>&);
+template std::ostream& operator<<(std::ostream&, const QuaternionT<double>&);
+
+} // namespace TiMath
@@ -0,0 +1,323 @@
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#define _USE_MATH_DEFINES
+#include <cmath>
+#include <algorithm> // For std::clamp
+#include <stdexcept>
+#include <ostream>
+#include "TiMathConfig.h"
+#include "Vector3.h"
+#include "Matrix4.h"
+
+namespace TiMath {
+
+template <typename T>
+class QuaternionT {
+public:
+    using value_type = T;
+
+    T x, y, z, w; // Imaginary (x, y, z), real (w)
+
+    // Static constants (declarations only)
+    static const QuaternionT identity;
+
+    constexpr QuaternionT(T x = 0.0f, T y = 0.0f, T z = 0.0f, T w = 1.0f) : x(x), y(y), z(z), w(w) {}
+
+    /** @brief Converts from another scalar type, e.g. Quaterniond to Quaternion. */
+    template <typename U>
+    explicit constexpr QuaternionT(const QuaternionT<U>& other)
+        : x(static_cast<T>(other.x)), y(static_cast<T>(other.y)), z(static_cast<T>(other.z)), w(static_cast<T>(other.w)) {}
+
+    // Arithmetic operators
+    /** @brief Adds two quaternions component-wise. */
+    [[nodiscard]] inline QuaternionT operator+(const QuaternionT& other) const {
+        return QuaternionT(x + other.x, y + other.y, z + other.z, w + other.w);
+    }
+
+    /** @brief Subtracts two quaternions component-wise. */
+    [[nodiscard]] inline QuaternionT operator-(const QuaternionT& other) const {
+        return QuaternionT(x - other.x, y - other.y, z - other.z, w - other.w);
+    }
+
+    /** @brief Negates all components of the quaternion. */
+    [[nodiscard]] inline QuaternionT operator-() const {
+        return QuaternionT(-x, -y, -z, -w);
+    }
+
+    /** @brief Scales the quaternion by a scalar. */
+    [[nodiscard]] inline QuaternionT operator*(T scalar) const {
+        return QuaternionT(x * scalar, y * scalar, z * scalar, w * scalar);
+    }
+
+    /** @brief Multiplies two quaternions (Hamilton product). */
+    [[nodiscard]] inline QuaternionT operator*(const QuaternionT& other) const {
+        return QuaternionT(
+            w * other.x + x * other.w + y * other.z - z * other.y,
+            w * other.y - x * other.z + y * other.w + z * other.x,
+            w * other.z + x * other.y - y * other.x + z * other.w,
+            w * other.w - x * other.x - y * other.y - z * other.z
+        );
+    }
+
+    /** @brief Divides the quaternion by a scalar, returns identity if scalar is near zero. */
+    [[nodiscard]] inline QuaternionT operator/(T scalar) const {
+        if (std::fabs(scalar) < TiMath::EPSILON) {
+            return QuaternionT(0.0f, 0.0f, 0.0f, 1.0f); // Safe default: identity
+        }
+        return QuaternionT(x / scalar, y / scalar, z / scalar, w / scalar);
+    }
+
+    /** @brief Adds another quaternion to this one. */
+    inline QuaternionT& operator+=(const QuaternionT& other) {
+        x += other.x; y += other.y; z += other.z; w += other.w;
+        return *this;
+    }
+
+    /** @brief Subtracts another quaternion from this one. */
+    inline QuaternionT& operator-=(const QuaternionT& other) {
+        x -= other.x; y -= other.y; z -= other.z; w -= other.w;
+        return *this;
+    }
+
+    /** @brief Scales this quaternion by a scalar. */
+    inline QuaternionT& operator*=(T scalar) {
+        x *= scalar; y *= scalar; z *= scalar; w *= scalar;
+        return *this;
+    }
+
+    /** @brief Multiplies this quaternion by another (Hamilton product). */
+    inline QuaternionT& operator*=(const QuaternionT& other) {
+        *this = *this * other;
+        return *this;
+    }
+
+    /** @brief Divides this quaternion by a scalar, sets to identity if scalar is near zero. */
+    inline QuaternionT& operator/=(T scalar) {
+        if (std::fabs(scalar) < TiMath::EPSILON) {
+            x = y = z = 0.0f; w = 1.0f; // Safe default: identity
+            return *this;
+        }
+        x /= scalar; y /= scalar; z /= scalar; w /= scalar;
+        return *this;
+    }
+
+    // Quaternion operations
+    /** @brief Computes the dot product with another quaternion. */
+    [[nodiscard]] constexpr T dot(const QuaternionT& other) const {
+        return x * other.x + y * other.y + z * other.z + w * other.w;
+    }
+
+    /** @brief Returns the length (magnitude) of the quaternion. */
+    [[nodiscard]] inline T length() const {
+        return std::sqrt(lengthSquared());
+    }
+
+    /** @brief Returns the squared length of the quaternion. */
+    [[nodiscard]] constexpr T lengthSquared() const {
+        return x * x + y * y + z * z + w * w;
+    }
+
+    /** @brief Returns a normalized copy of the quaternion, or identity if length is near zero. */
+    [[nodiscard]] inline QuaternionT normalized() const {
+        T len = length();
+        return len < TiMath::EPSILON ? QuaternionT(0.0f, 0.0f, 0.0f, 1.0f) : QuaternionT(x / len, y / len, z / len, w / len);
+    }
+
+    /** @brief Returns a normalized copy, assuming non-zero length. */
+    [[nodiscard]] inline QuaternionT normalizedUnsafe() const {
+        T len = length();
+        return QuaternionT(x / len, y / len, z / len, w / len); // Assumes len != 0
+    }
+
+    /** @brief Returns the conjugate of the quaternion. */
+    [[nodiscard]] inline QuaternionT conjugate() const {
+        return QuaternionT(-x, -y, -z, w);
+    }
+
+    /** @brief Returns the inverse of the quaternion, or identity if length is near zero. */
+    [[nodiscard]] inline QuaternionT inverse() const {
+        T lenSq = lengthSquared();
+        if (lenSq < TiMath::EPSILON) {
+            return QuaternionT(0.0f, 0.0f, 0.0f, 1.0f); // Safe default: identity
+        }
+        return conjugate() / lenSq;
+    }
+
+    /**
+     * @brief Rotates a vector by this quaternion (q v q^-1), returns v unchanged if length is near zero.
+     *        Uses v + 2/|q|^2 * (w (u x v) + u x (u x v)) instead of two Hamilton products.
+     */
+    [[nodiscard]] inline Vector3T<T> rotateVector(const Vector3T<T>& v) const {
+        T lenSq = lengthSquared();
+        if (lenSq < TiMath::EPSILON) {
+            return v; // Safe default: no rotation
+        }
+        Vector3T<T> u(x, y, z);
+        Vector3T<T> t = u.cross(v) * (2.0f / lenSq);
+        return v + t * w + u.cross(t);
+    }
+
+    /** @brief Rotates a vector by this quaternion, assuming it is unit length: v + w t + u x t, t = 2 (u x v). */
+    [[nodiscard]] inline Vector3T<T> rotateVectorUnit(const Vector3T<T>& v) const {
+        Vector3T<T> u(x, y, z);
+        Vector3T<T> t = u.cross(v) * 2.0f;
+        return v + t * w + u.cross(t);
+    }
+
+    /** @brief Creates a quaternion from an axis and angle (degrees). */
+    [[nodiscard]] static inline QuaternionT fromAxisAngle(const Vector3T<T>& axis, T angleDegrees) {
+        Vector3T<T> unitAxis = axis.normalized();
+        if (unitAxis.isZero()) {
+            return QuaternionT(0.0f, 0.0f, 0.0f, 1.0f); // Safe default: identity
+        }
+        T angleRad = angleDegrees * PI_T<T> / 180.0f;
+        T halfAngle = angleRad * 0.5f;
+        T sinHalf = std::sin(halfAngle);
+        return QuaternionT(
+            unitAxis.x * sinHalf,
+            unitAxis.y * sinHalf,
+            unitAxis.z * sinHalf,
+            std::cos(halfAngle)
+        );
+    }
+
+    /** @brief Extracts the rotation axis and angle (degrees), returns zero axis and zero angle if invalid. */
+    [[nodiscard]] inline std::pair<Vector3T<T>, T> toAxisAngle() const {
+        T len = std::sqrt(x * x + y * y + z * z);
+        if (len < TiMath::EPSILON || std::fabs(w) > 1.0f - TiMath::EPSILON) {
+            return {Vector3T<T>(0.0f, 0.0f, 0.0f), 0.0f}; // Safe default
+        }
+        T angleRad = 2.0f * std::acos(std::clamp(w, T(-1), T(1)));
+        return {Vector3T<T>(x / len, y / len, z / len), angleRad * 180.0f / PI_T<T>};
+    }
+
+    /** @brief Spherically interpolates between two quaternions. */
+    [[nodiscard]] static inline QuaternionT slerp(const QuaternionT& q1, const QuaternionT& q2, T t) {
+        QuaternionT q1Norm = q1.normalized();
+        QuaternionT q2Norm = q2.normalized();
+        T dot = q1Norm.dot(q2Norm);
+        if (dot < 0.0f) { // Shortest path
+            q2Norm = -q2Norm;
+            dot = -dot;
+        }
+        if (dot > 1.0f - TiMath::EPSILON) { // Linear interpolation for near-identical quaternions
+            return lerp(q1Norm, q2Norm, t).normalized();
+        }
+        T theta = std::acos(std::clamp(dot, T(-1), T(1)));
+        T sinTheta = std::sin(theta);
+        if (std::fabs(sinTheta) < TiMath::EPSILON) {
+            return q1Norm; // Safe default
+        }
+        T coeff1 = std::sin((1.0f - t) * theta) / sinTheta;
+        T coeff2 = std::sin(t * theta) / sinTheta;
+        return (q1Norm * coeff1 + q2Norm * coeff2).normalized();
+    }
+
+    /** @brief Checks if the quaternion is near zero within epsilon (identity-like). */
+    [[nodiscard]] inline bool isZero(T epsilon = EPSILON_T<T>) const {
+        return std::fabs(x) < epsilon && std::fabs(y) < epsilon &&
+               std::fabs(z) < epsilon && std::fabs(w - 1.0f) < epsilon;
+    }
+
+    /** @brief Checks if all components are finite. */
+    [[nodiscard]] inline bool isFinite() const {
+        return std::isfinite(x) && std::isfinite(y) && std::isfinite(z) && std::isfinite(w);
+    }
+
+    /** @brief Compares quaternions for approximate equality within epsilon. */
+    [[nodiscard]] inline bool operator==(const QuaternionT& other) const {
+        return std::fabs(x - other.x) < TiMath::EPSILON &&
+               std::fabs(y - other.y) < TiMath::EPSILON &&
+               std::fabs(z - other.z) < TiMath::EPSILON &&
+               std::fabs(w - other.w) < TiMath::EPSILON;
+    }
+
+    /** @brief Compares quaternions for inequality. */
+    [[nodiscard]] inline bool operator!=(const QuaternionT& other) const {
+        return !(*this == other);
+    }
+
+    /** @brief Linearly interpolates between two quaternions (non-normalized). */
+    [[nodiscard]] static inline QuaternionT lerp(const QuaternionT& q1, const QuaternionT& q2, T t) {
+        return QuaternionT(
+            q1.x + t * (q2.x - q1.x),
+            q1.y + t * (q2.y - q1.y),
+            q1.z + t * (q2.z - q1.z),
+            q1.w + t * (q2.w - q1.w)
+        );
+    }
+
+    /** @brief Returns a quaternion with component-wise minimums. */
+    [[nodiscard]] static inline QuaternionT min(const QuaternionT& a, const QuaternionT& b) {
+        return QuaternionT(
+            std::min(a.x, b.x),
+            std::min(a.y, b.y),
+            std::min(a.z, b.z),
+            std::min(a.w, b.w)
+        );
+    }
+
+    /** @brief Returns a quaternion with component-wise maximums. */
+    [[nodiscard]] static inline QuaternionT max(const QuaternionT& a, const QuaternionT& b) {
+        return QuaternionT(
+            std::max(a.x, b.x),
+            std::max(a.y, b.y),
+            std::max(a.z, b.z),
+            std::max(a.w, b.w)
+        );
+    }
+
+    /** @brief Clamps each component within a range. */
+    [[nodiscard]] inline QuaternionT clamp(T minVal, T maxVal) const {
+        return QuaternionT(
+            std::clamp(x, minVal, maxVal),
+            std::clamp(y, minVal, maxVal),
+            std::clamp(z, minVal, maxVal),
+            std::clamp(w, minVal, maxVal)
+        );
+    }
+    [[nodiscard]] inline Matrix4T<T> toMatrix4() const {
+        Matrix4T<T> result;
+        T xx = x * x, yy = y * y, zz = z * z;
+        T xy = x * y, xz = x * z, yz = y * z;
+        T wx = w * x, wy = w * y, wz = w * z;
+
+        result.m[0] = 1.0f - 2.0f * (yy + zz);
+        result.m[1] = 2.0f * (xy + wz);
+        result.m[2] = 2.0f * (xz - wy);
+        result.m[3] = 0.0f;
+
+        result.m[4] = 2.0f * (xy - wz);
+        result.m[5] = 1.0f - 2.0f * (xx + zz);
+        result.m[6] = 2.0f * (yz + wx);
+        result.m[7] = 0.0f;
+
+        result.m[8] = 2.0f * (xz + wy);
+        result.m[9] = 2.0f * (yz - wx);
+        result.m[10] = 1.0f - 2.0f * (xx + yy);
+        result.m[11] = 0.0f;
+
+        result.m[12] = 0.0f;
+        result.m[13] = 0.0f;
+        result.m[14] = 0.0f;
+        result.m[15] = 1.0f;
+        return result;
+    }
+
+};
+
+// Static constant definitions
+template <typename T> inline constexpr QuaternionT<T> QuaternionT<T>::identity{0, 0, 0, 1};
+
+template <typename T>
+[[nodiscard]] inline QuaternionT<T> operator*(typename QuaternionT<T>::value_type scalar, const QuaternionT<T>& q) {
+    return q * scalar;
+}
+
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const QuaternionT<T>& q);
+
+} // namespace TiMath
+
+#endif // QUATERNION_H
\ No newline at end of file
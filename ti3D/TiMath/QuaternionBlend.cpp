@@ -0,0 +1,256 @@
+#include "QuaternionBlend.h"
+#include <algorithm>
+#include <cmath>
+#include "BatchTransform.h"
+#include "Parallel.h"
+#include "TiMathSIMD.h"
+
+namespace TiMath {
+
+static_assert(sizeof(Quaternion) == 4 * sizeof(float), "AoS views treat Quaternion arrays as packed floats");
+
+namespace {
+
+// Interpolation factors: either one per element (stride 1) or a single shared value (stride 0).
+struct Factors {
+    const float* t;
+    std::size_t stride;
+
+    [[nodiscard]] float operator[](std::size_t i) const { return t[i * stride]; }
+};
+
+inline void put(MutableQuaternionView v, std::size_t i, const Quaternion& q) {
+    v.x[i * v.stride] = q.x;
+    v.y[i * v.stride] = q.y;
+    v.z[i * v.stride] = q.z;
+    v.w[i * v.stride] = q.w;
+}
+
+// Cubic remap of t that makes nlerp track slerp's constant angular velocity. d = |a . b|;
+// the coefficients are a least-squares fit of the angle error over d in [0, 1].
+inline float correctedT(float t, float d) {
+    float ca = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+    float cb = 0.848013f + d * (-1.06021f + d * 0.215638f);
+    float k = ca * (t - 0.5f) * (t - 0.5f) + cb;
+    return t + t * (t - 0.5f) * (t - 1.0f) * k;
+}
+
+Quaternion nlerpOne(const Quaternion& a, Quaternion b, float t) {
+    float d = a.dot(b);
+    if (d < 0.0f) {
+        b = -b;
+        d = -d;
+    }
+    return Quaternion::lerp(a, b, correctedT(t, d)).normalized();
+}
+
+#if defined(TIMATH_SSE)
+// Four lanes starting at element i, from either layout.
+inline void load4(QuaternionView v, std::size_t i, __m128& x, __m128& y, __m128& z, __m128& w) {
+    if (v.stride == 1) {
+        x = _mm_loadu_ps(v.x + i);
+        y = _mm_loadu_ps(v.y + i);
+        z = _mm_loadu_ps(v.z + i);
+        w = _mm_loadu_ps(v.w + i);
+    } else {
+        x = _mm_loadu_ps(v.x + i * 4);
+        y = _mm_loadu_ps(v.x + i * 4 + 4);
+        z = _mm_loadu_ps(v.x + i * 4 + 8);
+        w = _mm_loadu_ps(v.x + i * 4 + 12);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+    }
+}
+
+inline void store4(MutableQuaternionView v, std::size_t i, __m128 x, __m128 y, __m128 z, __m128 w) {
+    if (v.stride == 1) {
+        _mm_storeu_ps(v.x + i, x);
+        _mm_storeu_ps(v.y + i, y);
+        _mm_storeu_ps(v.z + i, z);
+        _mm_storeu_ps(v.w + i, w);
+    } else {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        _mm_storeu_ps(v.x + i * 4, x);
+        _mm_storeu_ps(v.x + i * 4 + 4, y);
+        _mm_storeu_ps(v.x + i * 4 + 8, z);
+        _mm_storeu_ps(v.x + i * 4 + 12, w);
+    }
+}
+
+inline __m128 load4(Factors t, std::size_t i) {
+    return t.stride ? _mm_loadu_ps(t.t + i) : _mm_set1_ps(*t.t);
+}
+
+inline __m128 dot4(__m128 ax, __m128 ay, __m128 az, __m128 aw, __m128 bx, __m128 by, __m128 bz, __m128 bw) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+                      _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+}
+
+inline __m128 madd(__m128 a, __m128 b, __m128 c) {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+
+inline __m128 correctedT4(__m128 t, __m128 d) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 ca = madd(d, madd(d, madd(d, _mm_set1_ps(-1.43519f), _mm_set1_ps(3.55645f)), _mm_set1_ps(-3.2452f)),
+                     _mm_set1_ps(1.0904f));
+    __m128 cb = madd(d, madd(d, _mm_set1_ps(0.215638f), _mm_set1_ps(-1.06021f)), _mm_set1_ps(0.848013f));
+    __m128 th = _mm_sub_ps(t, half);
+    __m128 k = madd(_mm_mul_ps(ca, th), th, cb);
+    return madd(_mm_mul_ps(_mm_mul_ps(t, th), _mm_sub_ps(t, one)), k, t);
+}
+#endif
+
+void slerpRange(QuaternionView a, QuaternionView b, Factors t, MutableQuaternionView out,
+                std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        put(out, i, Quaternion::slerp(a[i], b[i], t[i]));
+    }
+}
+
+void nlerpRange(QuaternionView a, QuaternionView b, Factors t, MutableQuaternionView out,
+                std::size_t begin, std::size_t end) {
+    std::size_t i = begin;
+#if defined(TIMATH_SSE)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= end; i += 4) {
+        __m128 ax, ay, az, aw, bx, by, bz, bw;
+        load4(a, i, ax, ay, az, aw);
+        load4(b, i, bx, by, bz, bw);
+        // Flip b into a's hemisphere by xoring in the sign of the dot product.
+        __m128 d = dot4(ax, ay, az, aw, bx, by, bz, bw);
+        __m128 sign = _mm_and_ps(d, signMask);
+        bx = _mm_xor_ps(bx, sign);
+        by = _mm_xor_ps(by, sign);
+        bz = _mm_xor_ps(bz, sign);
+        bw = _mm_xor_ps(bw, sign);
+        __m128 s = correctedT4(load4(t, i), _mm_andnot_ps(signMask, d));
+        __m128 x = madd(s, _mm_sub_ps(bx, ax), ax);
+        __m128 y = madd(s, _mm_sub_ps(by, ay), ay);
+        __m128 z = madd(s, _mm_sub_ps(bz, az), az);
+        __m128 w = madd(s, _mm_sub_ps(bw, aw), aw);
+        // Same-hemisphere unit inputs keep |lerp| >= sqrt(0.5), so no zero-length guard is needed.
+        __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(dot4(x, y, z, w, x, y, z, w)));
+        store4(out, i, _mm_mul_ps(x, inv), _mm_mul_ps(y, inv), _mm_mul_ps(z, inv), _mm_mul_ps(w, inv));
+    }
+#endif
+    for (; i < end; ++i) {
+        put(out, i, nlerpOne(a[i], b[i], t[i]));
+    }
+}
+
+void weightedAverageRange(const QuaternionView* inputs, const float* weights, std::size_t count,
+                          MutableQuaternionView out, std::size_t begin, std::size_t end) {
+    std::size_t i = begin;
+#if defined(TIMATH_SSE)
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 eps = _mm_set1_ps(EPSILON);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= end; i += 4) {
+        __m128 rx, ry, rz, rw;
+        load4(inputs[0], i, rx, ry, rz, rw);
+        __m128 sx = _mm_setzero_ps(), sy = _mm_setzero_ps(), sz = _mm_setzero_ps(), sw = _mm_setzero_ps();
+        for (std::size_t k = 0; k < count; ++k) {
+            __m128 x, y, z, w;
+            load4(inputs[k], i, x, y, z, w);
+            // Weight carries the hemisphere flip relative to the first input.
+            __m128 sign = _mm_and_ps(dot4(rx, ry, rz, rw, x, y, z, w), signMask);
+            __m128 wk = _mm_xor_ps(_mm_set1_ps(weights[k]), sign);
+            sx = madd(wk, x, sx);
+            sy = madd(wk, y, sy);
+            sz = madd(wk, z, sz);
+            sw = madd(wk, w, sw);
+        }
+        // Same policy as Quaternion::normalized: near-zero sums become identity.
+        __m128 len = _mm_sqrt_ps(dot4(sx, sy, sz, sw, sx, sy, sz, sw));
+        __m128 valid = _mm_cmpge_ps(len, eps);
+        __m128 inv = _mm_and_ps(_mm_div_ps(one, len), valid);
+        store4(out, i, _mm_mul_ps(sx, inv), _mm_mul_ps(sy, inv), _mm_mul_ps(sz, inv),
+               _mm_or_ps(_mm_mul_ps(sw, inv), _mm_andnot_ps(valid, one)));
+    }
+#endif
+    for (; i < end; ++i) {
+        Quaternion sum(0.0f, 0.0f, 0.0f, 0.0f);
+        Quaternion reference = inputs[0][i];
+        for (std::size_t k = 0; k < count; ++k) {
+            Quaternion q = inputs[k][i];
+            sum += q * (reference.dot(q) < 0.0f ? -weights[k] : weights[k]);
+        }
+        put(out, i, sum.normalized());
+    }
+}
+
+} // namespace
+
+void QuaternionStream::assign(const Quaternion* src, std::size_t n) {
+    resize(n);
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    for (; i + 4 <= n; i += 4) {
+        __m128 x, y, z, w;
+        load4(makeView(src + i, 4), 0, x, y, z, w);
+        _mm_store_ps(&x_[i], x);
+        _mm_store_ps(&y_[i], y);
+        _mm_store_ps(&z_[i], z);
+        _mm_store_ps(&w_[i], w);
+    }
+#endif
+    for (; i < n; ++i) {
+        set(i, src[i]);
+    }
+}
+
+void QuaternionStream::copyTo(Quaternion* dst) const {
+    const std::size_t n = size();
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    for (; i + 4 <= n; i += 4) {
+        store4(makeView(dst + i, 4), 0, _mm_load_ps(&x_[i]), _mm_load_ps(&y_[i]), _mm_load_ps(&z_[i]),
+               _mm_load_ps(&w_[i]));
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = (*this)[i];
+    }
+}
+
+namespace blend {
+
+void slerp(QuaternionView a, QuaternionView b, float t, MutableQuaternionView out) {
+    parallelFor(a.size, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        slerpRange(a, b, Factors{&t, 0}, out, begin, end);
+    });
+}
+
+void slerp(QuaternionView a, QuaternionView b, const float* t, MutableQuaternionView out) {
+    parallelFor(a.size, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        slerpRange(a, b, Factors{t, 1}, out, begin, end);
+    });
+}
+
+void nlerp(QuaternionView a, QuaternionView b, float t, MutableQuaternionView out) {
+    parallelFor(a.size, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        nlerpRange(a, b, Factors{&t, 0}, out, begin, end);
+    });
+}
+
+void nlerp(QuaternionView a, QuaternionView b, const float* t, MutableQuaternionView out) {
+    parallelFor(a.size, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        nlerpRange(a, b, Factors{t, 1}, out, begin, end);
+    });
+}
+
+void weightedAverage(const QuaternionView* inputs, const float* weights, std::size_t count, MutableQuaternionView out) {
+    if (count == 0) {
+        for (std::size_t i = 0; i < out.size; ++i) {
+            put(out, i, Quaternion::identity);
+        }
+        return;
+    }
+    parallelFor(out.size, PARALLEL_BATCH_THRESHOLD, [&](std::size_t begin, std::size_t end) {
+        weightedAverageRange(inputs, weights, count, out, begin, end);
+    });
+}
+
+} // namespace blend
+} // namespace TiMath
@@ -0,0 +1,155 @@
+#ifndef QUATERNION_BLEND_H
+#define QUATERNION_BLEND_H
+
+#include <cstddef>
+#include <vector>
+#include "TiMathConfig.h"
+#include "AlignedAllocator.h"
+#include "Quaternion.h"
+
+namespace TiMath {
+
+/**
+ * @brief Non-owning view of n quaternions stored as four strided float arrays.
+ *
+ * stride == 1 is structure-of-arrays (a QuaternionStream); stride == 4 is a packed
+ * Quaternion array viewed in place. The blend kernels accept either layout.
+ */
+template <typename T>
+struct QuaternionViewT {
+    T* x = nullptr;
+    T* y = nullptr;
+    T* z = nullptr;
+    T* w = nullptr;
+    std::size_t size = 0;
+    std::size_t stride = 1;
+
+    /** @brief Reads element i as a Quaternion. */
+    [[nodiscard]] Quaternion operator[](std::size_t i) const {
+        return Quaternion(x[i * stride], y[i * stride], z[i * stride], w[i * stride]);
+    }
+
+    /** @brief Returns true for structure-of-arrays layout. */
+    [[nodiscard]] bool isSoA() const { return stride == 1; }
+
+    /** @brief Converts a mutable view into a read-only one. */
+    operator QuaternionViewT<const T>() const { return {x, y, z, w, size, stride}; }
+};
+
+using QuaternionView = QuaternionViewT<const float>;
+using MutableQuaternionView = QuaternionViewT<float>;
+
+/** @brief Zero-copy read-only view over a packed Quaternion array. */
+[[nodiscard]] inline QuaternionView makeView(const Quaternion* data, std::size_t n) {
+    return {&data->x, &data->y, &data->z, &data->w, n, 4};
+}
+
+/** @brief Zero-copy mutable view over a packed Quaternion array. */
+[[nodiscard]] inline MutableQuaternionView makeView(Quaternion* data, std::size_t n) {
+    return {&data->x, &data->y, &data->z, &data->w, n, 4};
+}
+
+/**
+ * @class QuaternionStream
+ * @brief Structure-of-arrays storage for many quaternions: separate 32-byte aligned x, y, z, w arrays.
+ */
+class QuaternionStream {
+public:
+    using Buffer = std::vector<float, AlignedAllocator<float, 32>>;
+
+    QuaternionStream() = default;
+    explicit QuaternionStream(std::size_t n) : x_(n), y_(n), z_(n), w_(n, 1.0f) {}
+
+    /** @brief Copies (transposes) a packed Quaternion array into SoA layout. */
+    explicit QuaternionStream(const std::vector<Quaternion>& q) { assign(q.data(), q.size()); }
+
+    [[nodiscard]] std::size_t size() const { return x_.size(); }
+    [[nodiscard]] bool empty() const { return x_.empty(); }
+
+    /** @brief Resizes the stream; new elements are identity. */
+    void resize(std::size_t n) {
+        x_.resize(n);
+        y_.resize(n);
+        z_.resize(n);
+        w_.resize(n, 1.0f);
+    }
+
+    void clear() { resize(0); }
+
+    [[nodiscard]] float* x() { return x_.data(); }
+    [[nodiscard]] float* y() { return y_.data(); }
+    [[nodiscard]] float* z() { return z_.data(); }
+    [[nodiscard]] float* w() { return w_.data(); }
+    [[nodiscard]] const float* x() const { return x_.data(); }
+    [[nodiscard]] const float* y() const { return y_.data(); }
+    [[nodiscard]] const float* z() const { return z_.data(); }
+    [[nodiscard]] const float* w() const { return w_.data(); }
+
+    /** @brief Reads element i as a Quaternion. */
+    [[nodiscard]] Quaternion operator[](std::size_t i) const { return Quaternion(x_[i], y_[i], z_[i], w_[i]); }
+
+    /** @brief Writes element i. */
+    void set(std::size_t i, const Quaternion& q) {
+        x_[i] = q.x;
+        y_[i] = q.y;
+        z_[i] = q.z;
+        w_[i] = q.w;
+    }
+
+    [[nodiscard]] QuaternionView view() const { return {x_.data(), y_.data(), z_.data(), w_.data(), size(), 1}; }
+    [[nodiscard]] MutableQuaternionView view() { return {x_.data(), y_.data(), z_.data(), w_.data(), size(), 1}; }
+
+    /** @brief Replaces the contents with a transposed copy of n packed quaternions. */
+    void assign(const Quaternion* src, std::size_t n);
+
+    /** @brief Writes the contents back to a packed Quaternion array of at least size() elements. */
+    void copyTo(Quaternion* dst) const;
+
+    /** @brief Returns the contents as a packed std::vector<Quaternion>. */
+    [[nodiscard]] std::vector<Quaternion> toVector() const {
+        std::vector<Quaternion> out(size());
+        copyTo(out.data());
+        return out;
+    }
+
+private:
+    Buffer x_, y_, z_, w_;
+};
+
+namespace blend {
+
+// Batched rotation blending, e.g. for thousands of joints per frame. Inputs and outputs must
+// have matching sizes; the output may be the same view as an input. The t overloads taking a
+// pointer read one factor per element. Batches of at least twice PARALLEL_BATCH_THRESHOLD
+// (BatchTransform.h) are split across threads.
+
+/**
+ * @brief Exact spherical interpolation, equivalent to Quaternion::slerp(a[i], b[i], t) per element.
+ *        Pays one acos and three sin per element; use nlerp when 0.05 degrees is close enough.
+ */
+void slerp(QuaternionView a, QuaternionView b, float t, MutableQuaternionView out);
+void slerp(QuaternionView a, QuaternionView b, const float* t, MutableQuaternionView out);
+
+/**
+ * @brief Corrected nlerp: normalized lerp along the shortest path, with t remapped by a cubic
+ *        fitted to the slerp angle. No transcendentals, so it vectorizes fully; the result stays
+ *        within 0.05 degrees of slerp (plain nlerp drifts by up to 8 degrees). a and b must be unit length.
+ */
+void nlerp(QuaternionView a, QuaternionView b, float t, MutableQuaternionView out);
+void nlerp(QuaternionView a, QuaternionView b, const float* t, MutableQuaternionView out);
+
+/**
+ * @brief N-way weighted blend: out[i] = normalize(sum_k weights[k] * inputs[k][i]), with each
+ *        input flipped into the hemisphere of inputs[0][i] first. Elements whose weighted sum is
+ *        near zero (including count == 0) become identity.
+ * @param inputs count views of equal size.
+ * @param weights One weight per input, applied to all of its elements.
+ * @param count Number of inputs.
+ * @param out Destination.
+ */
+void weightedAverage(const QuaternionView* inputs, const float* weights, std::size_t count, MutableQuaternionView out);
+
+} // namespace blend
+} // namespace TiMath
+
+#endif // QUATERNION_BLEND_H
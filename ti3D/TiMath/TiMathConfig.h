@@ -4,9 +4,43 @@
 namespace TiMath {
 constexpr float EPSILON = 1e-6f;
 constexpr float PI = 3.14159265358979323846f;
+// Scalar-typed copies for the templated types (e.g. Vector3T<double>).
+template <typename T> inline constexpr T EPSILON_T = static_cast<T>(EPSILON);
+template <typename T> inline constexpr T PI_T = static_cast<T>(3.14159265358979323846);
 #define TIMATH_COLUMN_MAJOR
 // #define TIMATH_ROW_MAJOR
 #define USE_SSE
 } // namespace TiMath
 
-#endif // TIMATH_CONFIG_H
\ No newline at end of file
+// SIMD backend selection: USE_SSE turns on the SSE kernels when the target supports SSE2,
+// and the AVX variants are picked up when the compiler is invoked with AVX enabled.
+// Comment out USE_SSE to force the scalar reference path everywhere.
+#if defined(USE_SSE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define TIMATH_SSE
+#if defined(__AVX__)
+#define TIMATH_AVX
+#endif
+#endif
+
+// Lets constexpr functions keep their SIMD / libm fast paths at runtime and fall back to
+// portable code only during constant evaluation (std::is_constant_evaluated in C++20).
+#if defined(__cpp_lib_is_constant_evaluated)
+#define TIMATH_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define TIMATH_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define TIMATH_IS_CONSTANT_EVALUATED() false
+#endif
+
+// Error policy for degenerate inputs (singular matrices, zero axes, invalid projections).
+// The affected functions always return their documented fallback; on top of that SILENT does
+// nothing, COUNTED bumps a lock-free per-status counter (see TiMathError.h) and LOGGED also
+// writes a warning to std::cerr. Override with -DTIMATH_ERROR_POLICY=... when building.
+#define TIMATH_ERROR_POLICY_SILENT 0
+#define TIMATH_ERROR_POLICY_COUNTED 1
+#define TIMATH_ERROR_POLICY_LOGGED 2
+#ifndef TIMATH_ERROR_POLICY
+#define TIMATH_ERROR_POLICY TIMATH_ERROR_POLICY_COUNTED
+#endif
+
+#endif // TIMATH_CONFIG_H
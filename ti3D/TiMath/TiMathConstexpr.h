@@ -0,0 +1,81 @@
+#ifndef TIMATH_CONSTEXPR_H
+#define TIMATH_CONSTEXPR_H
+
+#include "TiMathConfig.h"
+
+// constexpr replacements for the <cmath> functions the factories need, so fixed transforms
+// can be folded at compile time. The same code runs at runtime, so a factory returns the
+// same matrix whether or not it was folded.
+namespace TiMath::cx {
+
+/** @brief constexpr std::fabs. */
+template <typename T>
+[[nodiscard]] constexpr T abs(T x) {
+    return x < T(0) ? -x : x;
+}
+
+namespace detail {
+
+constexpr double PI_D = 3.14159265358979323846;
+
+// Taylor series of sin on [-90, 90] degrees; 11 terms are well past float precision there.
+constexpr double sinFolded(double degrees) {
+    double x = degrees * (PI_D / 180.0);
+    double x2 = x * x;
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 12; ++n) {
+        term *= -x2 / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+// Whole part of v, toward zero; beyond 2^52 every double is whole (and may not fit a long long).
+constexpr double truncate(double v) {
+    return abs(v) < 4503599627370496.0 ? static_cast<double>(static_cast<long long>(v)) : v;
+}
+
+// Reduces to [-180, 180] and folds onto [-90, 90] in degrees, so multiples of 90 stay exact.
+// Past 2^52 degrees one pass leaves the rounding error of degrees / 360, which the next pass
+// reduces; NaN and infinities come out as NaN.
+constexpr double sinDegrees(double degrees) {
+    while (abs(degrees) > 180.0) {
+        degrees -= 360.0 * truncate(degrees / 360.0);
+        if (degrees > 180.0) degrees -= 360.0;
+        if (degrees < -180.0) degrees += 360.0;
+    }
+    if (degrees > 90.0) degrees = 180.0 - degrees;
+    if (degrees < -90.0) degrees = -180.0 - degrees;
+    return sinFolded(degrees);
+}
+
+} // namespace detail
+
+/** @brief constexpr sine of an angle in degrees. */
+template <typename T>
+[[nodiscard]] constexpr T sinDegrees(T degrees) {
+    return static_cast<T>(detail::sinDegrees(static_cast<double>(degrees)));
+}
+
+/** @brief constexpr cosine of an angle in degrees. */
+template <typename T>
+[[nodiscard]] constexpr T cosDegrees(T degrees) {
+    return static_cast<T>(detail::sinDegrees(static_cast<double>(degrees) + 90.0));
+}
+
+/** @brief constexpr sine of an angle in radians. */
+template <typename T>
+[[nodiscard]] constexpr T sin(T radians) {
+    return static_cast<T>(detail::sinDegrees(static_cast<double>(radians) * (180.0 / detail::PI_D)));
+}
+
+/** @brief constexpr cosine of an angle in radians. */
+template <typename T>
+[[nodiscard]] constexpr T cos(T radians) {
+    return static_cast<T>(detail::sinDegrees(static_cast<double>(radians) * (180.0 / detail::PI_D) + 90.0));
+}
+
+} // namespace TiMath::cx
+
+#endif // TIMATH_CONSTEXPR_H
@@ -0,0 +1,54 @@
+#include "TiMathError.h"
+#include <iostream>
+
+namespace TiMath {
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "error counters must not take a lock");
+
+namespace detail {
+
+std::atomic<std::uint32_t> errorCounters[static_cast<int>(MathStatus::Count)] = {};
+
+void logError(MathStatus status) {
+    // No std::endl: flushing on every degenerate input is what made the old warnings so slow.
+    std::cerr << "Warning: " << toString(status) << ", returning default value\n";
+}
+
+} // namespace detail
+
+const char* toString(MathStatus status) {
+    switch (status) {
+        case MathStatus::Ok:                 return "Ok";
+        case MathStatus::SingularMatrix:     return "Matrix is singular";
+        case MathStatus::ZeroAxis:           return "Zero-length axis in rotation";
+        case MathStatus::InvalidPerspective: return "Invalid perspective parameters";
+        case MathStatus::InvalidFrustum:     return "Invalid frustum parameters";
+        case MathStatus::InvalidViewport:    return "Invalid viewport dimensions";
+        case MathStatus::ZeroLookDirection:  return "Zero-length direction in lookAt";
+        case MathStatus::ZeroUpVector:       return "Zero-length up vector in lookAt";
+        case MathStatus::ParallelUpVector:   return "Invalid up vector in lookAt";
+        case MathStatus::DegenerateScale:    return "Near-zero scaling factor in decompose";
+        case MathStatus::Count:              break;
+    }
+    return "Unknown error";
+}
+
+std::uint32_t errorCount(MathStatus status) {
+    return detail::errorCounters[static_cast<int>(status)].load(std::memory_order_relaxed);
+}
+
+std::uint32_t totalErrorCount() {
+    std::uint32_t total = 0;
+    for (const auto& counter : detail::errorCounters) {
+        total += counter.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void resetErrorCounts() {
+    for (auto& counter : detail::errorCounters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+} // namespace TiMath
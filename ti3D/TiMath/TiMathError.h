@@ -0,0 +1,69 @@
+#ifndef TIMATH_ERROR_H
+#define TIMATH_ERROR_H
+
+#include <atomic>
+#include <cstdint>
+#include "TiMathConfig.h"
+
+namespace TiMath {
+
+/**
+ * @brief Why a TiMath operation could not produce a real result.
+ *        The try* functions return std::nullopt for these; the plain ones fall back to a
+ *        default value and report the status through TIMATH_ERROR_POLICY.
+ */
+enum class MathStatus : std::uint8_t {
+    Ok = 0,
+    SingularMatrix,
+    ZeroAxis,
+    InvalidPerspective,
+    InvalidFrustum,
+    InvalidViewport,
+    ZeroLookDirection,
+    ZeroUpVector,
+    ParallelUpVector,
+    DegenerateScale,
+    Count
+};
+
+/** @brief Returns a short human-readable description of a status. */
+[[nodiscard]] const char* toString(MathStatus status);
+
+namespace detail {
+extern std::atomic<std::uint32_t> errorCounters[static_cast<int>(MathStatus::Count)];
+void logError(MathStatus status);
+} // namespace detail
+
+/**
+ * @brief Records a degenerate input according to TIMATH_ERROR_POLICY.
+ *        In the counted policy this is a single relaxed atomic increment, so it is safe to
+ *        hit from batch kernels and worker threads.
+ * @param status The failure being reported.
+ */
+inline void reportError(MathStatus status) {
+#if TIMATH_ERROR_POLICY >= TIMATH_ERROR_POLICY_COUNTED
+    detail::errorCounters[static_cast<int>(status)].fetch_add(1, std::memory_order_relaxed);
+#endif
+#if TIMATH_ERROR_POLICY >= TIMATH_ERROR_POLICY_LOGGED
+    detail::logError(status);
+#endif
+    (void)status;
+}
+
+/**
+ * @brief Returns how often a status has been reported since the last reset.
+ *        Always zero under TIMATH_ERROR_POLICY_SILENT.
+ * @param status The status to query.
+ * @return The count (wraps at 2^32).
+ */
+[[nodiscard]] std::uint32_t errorCount(MathStatus status);
+
+/** @brief Returns the sum of all error counters. */
+[[nodiscard]] std::uint32_t totalErrorCount();
+
+/** @brief Resets all error counters to zero, e.g. once per frame after reading them. */
+void resetErrorCounts();
+
+} // namespace TiMath
+
+#endif // TIMATH_ERROR_H
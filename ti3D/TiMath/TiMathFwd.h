@@ -0,0 +1,26 @@
+#ifndef TIMATH_FWD_H
+#define TIMATH_FWD_H
+
+namespace TiMath {
+
+// The vector, quaternion and matrix types are templated on the scalar. The unsuffixed
+// names are the float instantiations the renderer uses; the "d" names are double, for
+// precision-sensitive work such as RBF binding.
+template <typename T> class Vector3T;
+template <typename T> class Vector4T;
+template <typename T> class QuaternionT;
+template <typename T> class Matrix4T;
+
+using Vector3 = Vector3T<float>;
+using Vector4 = Vector4T<float>;
+using Quaternion = QuaternionT<float>;
+using Matrix4 = Matrix4T<float>;
+
+using Vector3d = Vector3T<double>;
+using Vector4d = Vector4T<double>;
+using Quaterniond = QuaternionT<double>;
+using Matrix4d = Matrix4T<double>;
+
+} // namespace TiMath
+
+#endif // TIMATH_FWD_H
@@ -0,0 +1,112 @@
+#ifndef TIMATH_SIMD_H
+#define TIMATH_SIMD_H
+
+#include "TiMathConfig.h"
+
+#if defined(TIMATH_AVX)
+#include <immintrin.h>
+#elif defined(TIMATH_SSE)
+#include <emmintrin.h>
+#endif
+
+#if defined(TIMATH_SSE)
+
+// _MM_SHUFFLE takes lanes high-to-low; this takes them in reading order.
+#define TIMATH_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+
+namespace TiMath {
+namespace simd {
+
+/** @brief Permutes the lanes of a single register. */
+template <int X, int Y, int Z, int W>
+inline __m128 swizzle(__m128 v) {
+    return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), TIMATH_SHUFFLE_MASK(X, Y, Z, W)));
+}
+
+/** @brief Takes lanes X, Y from a and Z, W from b. */
+template <int X, int Y, int Z, int W>
+inline __m128 shuffle(__m128 a, __m128 b) {
+    return _mm_shuffle_ps(a, b, TIMATH_SHUFFLE_MASK(X, Y, Z, W));
+}
+
+/** @brief Broadcasts lane I to all four lanes. */
+template <int I>
+inline __m128 splat(__m128 v) {
+    return swizzle<I, I, I, I>(v);
+}
+
+/** @brief Horizontal sum broadcast to all lanes (SSE2 only, no hadd). */
+inline __m128 sumAll(__m128 v) {
+    __m128 t = _mm_add_ps(v, swizzle<1, 0, 3, 2>(v));
+    return _mm_add_ps(t, swizzle<2, 3, 0, 1>(t));
+}
+
+/**
+ * @brief Loads four packed 3-component vectors (12 floats) and transposes them to x, y, z registers.
+ * @param src Points at x0 y0 z0 x1 y1 z1 x2 y2 z2 x3 y3 z3; no alignment required.
+ */
+inline void loadTransposed3x4(const float* src, __m128& x, __m128& y, __m128& z) {
+    const __m128 a = _mm_loadu_ps(src);     // x0 y0 z0 x1
+    const __m128 b = _mm_loadu_ps(src + 4); // y1 z1 x2 y2
+    const __m128 c = _mm_loadu_ps(src + 8); // z2 x3 y3 z3
+    x = shuffle<0, 3, 0, 2>(a, shuffle<2, 2, 1, 1>(b, c));
+    y = shuffle<0, 2, 0, 2>(shuffle<1, 1, 0, 0>(a, b), shuffle<3, 3, 2, 2>(b, c));
+    z = shuffle<0, 2, 0, 2>(shuffle<2, 2, 1, 1>(a, b), shuffle<0, 0, 3, 3>(c, c));
+}
+
+/** @brief Inverse of loadTransposed3x4: interleaves x, y, z registers back into 12 packed floats. */
+inline void storeTransposed3x4(float* dst, __m128 x, __m128 y, __m128 z) {
+    _mm_storeu_ps(dst,     shuffle<0, 2, 0, 2>(shuffle<0, 0, 0, 0>(x, y), shuffle<0, 0, 1, 1>(z, x)));
+    _mm_storeu_ps(dst + 4, shuffle<0, 2, 0, 2>(shuffle<1, 1, 1, 1>(y, z), shuffle<2, 2, 2, 2>(x, y)));
+    _mm_storeu_ps(dst + 8, shuffle<0, 2, 0, 2>(shuffle<2, 2, 3, 3>(z, x), shuffle<3, 3, 3, 3>(y, z)));
+}
+
+/**
+ * @brief One 4-component matrix column in registers, so Matrix4T<float> and Matrix4T<double>
+ *        share the same kernels. float uses one __m128; double uses one __m256d with AVX and
+ *        a pair of __m128d with SSE2. Loads and stores expect 4 * sizeof(T) alignment only.
+ */
+template <typename T>
+struct Column;
+
+template <>
+struct Column<float> {
+    __m128 v;
+
+    static Column load(const float* p) { return {_mm_load_ps(p)}; }
+    static Column set1(float s) { return {_mm_set1_ps(s)}; }
+    void store(float* p) const { _mm_store_ps(p, v); }
+    Column operator+(Column o) const { return {_mm_add_ps(v, o.v)}; }
+    Column operator*(Column o) const { return {_mm_mul_ps(v, o.v)}; }
+};
+
+#if defined(TIMATH_AVX)
+template <>
+struct Column<double> {
+    __m256d v;
+
+    static Column load(const double* p) { return {_mm256_load_pd(p)}; }
+    static Column set1(double s) { return {_mm256_set1_pd(s)}; }
+    void store(double* p) const { _mm256_store_pd(p, v); }
+    Column operator+(Column o) const { return {_mm256_add_pd(v, o.v)}; }
+    Column operator*(Column o) const { return {_mm256_mul_pd(v, o.v)}; }
+};
+#else
+template <>
+struct Column<double> {
+    __m128d lo, hi;
+
+    static Column load(const double* p) { return {_mm_load_pd(p), _mm_load_pd(p + 2)}; }
+    static Column set1(double s) { return {_mm_set1_pd(s), _mm_set1_pd(s)}; }
+    void store(double* p) const { _mm_store_pd(p, lo); _mm_store_pd(p + 2, hi); }
+    Column operator+(Column o) const { return {_mm_add_pd(lo, o.lo), _mm_add_pd(hi, o.hi)}; }
+    Column operator*(Column o) const { return {_mm_mul_pd(lo, o.lo), _mm_mul_pd(hi, o.hi)}; }
+};
+#endif
+
+} // namespace simd
+} // namespace TiMath
+
+#endif // TIMATH_SSE
+
+#endif // TIMATH_SIMD_H
@@ -3,9 +3,15 @@
 
 namespace TiMath {
 
-std::ostream& operator<<(std::ostream& os, const Vector3& v) {
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const Vector3T<T>& v) {
     os << "(" << v.x << ", " << v.y << ", " << v.z << ")";
     return os;
 }
 
-} // namespace TiMath
\ No newline at end of file
+template class Vector3T<float>;
+template class Vector3T<double>;
+template std::ostream& operator<<(std::ostream&, const Vector3T<float>&);
+template std::ostream& operator<<(std::ostream&, const Vector3T<double>&);
+
+} // namespace TiMath
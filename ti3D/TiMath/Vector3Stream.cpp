@@ -0,0 +1,360 @@
+#include "Vector3Stream.h"
+#include <algorithm>
+#include <cmath>
+#include "TiMathSIMD.h"
+
+namespace TiMath {
+
+static_assert(sizeof(Vector3) == 3 * sizeof(float), "AoS views treat Vector3 arrays as packed floats");
+
+namespace {
+
+inline void put(MutableVector3View v, std::size_t i, const Vector3& p) {
+    v.x[i * v.stride] = p.x;
+    v.y[i * v.stride] = p.y;
+    v.z[i * v.stride] = p.z;
+}
+
+#if defined(TIMATH_SSE)
+// One coordinate of four consecutive elements. Packed AoS data is transposed in blocks of four.
+struct Lanes4 {
+    static constexpr std::size_t width = 4;
+    __m128 v;
+
+    static Lanes4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+    static Lanes4 set1(float s) { return {_mm_set1_ps(s)}; }
+    static Lanes4 min(Lanes4 a, Lanes4 b) { return {_mm_min_ps(a.v, b.v)}; }
+    static Lanes4 max(Lanes4 a, Lanes4 b) { return {_mm_max_ps(a.v, b.v)}; }
+    static Lanes4 sqrt(Lanes4 a) { return {_mm_sqrt_ps(a.v)}; }
+    static void loadPacked(const float* src, Lanes4& x, Lanes4& y, Lanes4& z) { simd::loadTransposed3x4(src, x.v, y.v, z.v); }
+    static void storePacked(float* dst, Lanes4 x, Lanes4 y, Lanes4 z) { simd::storeTransposed3x4(dst, x.v, y.v, z.v); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    Lanes4 operator+(Lanes4 o) const { return {_mm_add_ps(v, o.v)}; }
+    Lanes4 operator-(Lanes4 o) const { return {_mm_sub_ps(v, o.v)}; }
+    Lanes4 operator*(Lanes4 o) const { return {_mm_mul_ps(v, o.v)}; }
+    Lanes4 operator/(Lanes4 o) const { return {_mm_div_ps(v, o.v)}; }
+    Lanes4 operator&(Lanes4 o) const { return {_mm_and_ps(v, o.v)}; }
+    // All bits set where v >= o, clear elsewhere
+    Lanes4 operator>=(Lanes4 o) const { return {_mm_cmpge_ps(v, o.v)}; }
+};
+
+#if defined(TIMATH_AVX)
+// Eight elements per register; packed data goes through two four-element transposes.
+struct Lanes8 {
+    static constexpr std::size_t width = 8;
+    __m256 v;
+
+    static Lanes8 load(const float* p) { return {_mm256_loadu_ps(p)}; }
+    static Lanes8 set1(float s) { return {_mm256_set1_ps(s)}; }
+    static Lanes8 min(Lanes8 a, Lanes8 b) { return {_mm256_min_ps(a.v, b.v)}; }
+    static Lanes8 max(Lanes8 a, Lanes8 b) { return {_mm256_max_ps(a.v, b.v)}; }
+    static Lanes8 sqrt(Lanes8 a) { return {_mm256_sqrt_ps(a.v)}; }
+    static Lanes8 join(Lanes4 lo, Lanes4 hi) { return {_mm256_insertf128_ps(_mm256_castps128_ps256(lo.v), hi.v, 1)}; }
+    static void loadPacked(const float* src, Lanes8& x, Lanes8& y, Lanes8& z) {
+        Lanes4 x0, y0, z0, x1, y1, z1;
+        Lanes4::loadPacked(src, x0, y0, z0);
+        Lanes4::loadPacked(src + 12, x1, y1, z1);
+        x = join(x0, x1);
+        y = join(y0, y1);
+        z = join(z0, z1);
+    }
+    static void storePacked(float* dst, Lanes8 x, Lanes8 y, Lanes8 z) {
+        Lanes4::storePacked(dst, x.lo(), y.lo(), z.lo());
+        Lanes4::storePacked(dst + 12, x.hi(), y.hi(), z.hi());
+    }
+    Lanes4 lo() const { return {_mm256_castps256_ps128(v)}; }
+    Lanes4 hi() const { return {_mm256_extractf128_ps(v, 1)}; }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+    Lanes8 operator+(Lanes8 o) const { return {_mm256_add_ps(v, o.v)}; }
+    Lanes8 operator-(Lanes8 o) const { return {_mm256_sub_ps(v, o.v)}; }
+    Lanes8 operator*(Lanes8 o) const { return {_mm256_mul_ps(v, o.v)}; }
+    Lanes8 operator/(Lanes8 o) const { return {_mm256_div_ps(v, o.v)}; }
+    Lanes8 operator&(Lanes8 o) const { return {_mm256_and_ps(v, o.v)}; }
+    // All bits set where v >= o, clear elsewhere
+    Lanes8 operator>=(Lanes8 o) const { return {_mm256_cmp_ps(v, o.v, _CMP_GE_OQ)}; }
+};
+#endif
+
+// Calls body with the lane type to run in; body returns how many elements it covered. With
+// AVX that is eight lanes when every view is SoA. Packed AoS views stay on four, where
+// splitting eight-wide registers for the 3x4 transposes costs more than the wider
+// arithmetic saves (TiMathBench: stream::cross [AoS] 1.55 ns at four lanes, 1.8-2.0 at eight).
+template <typename Body>
+inline std::size_t forLanes(bool soa, Body&& body) {
+#if defined(TIMATH_AVX)
+    if (soa) {
+        return body(Lanes8());
+    }
+#endif
+    (void)soa;
+    return body(Lanes4());
+}
+
+// L::width elements starting at element i, from either layout.
+template <typename L>
+inline void load(Vector3View v, std::size_t i, L& x, L& y, L& z) {
+    if (v.stride == 1) {
+        x = L::load(v.x + i);
+        y = L::load(v.y + i);
+        z = L::load(v.z + i);
+    } else {
+        L::loadPacked(v.x + i * 3, x, y, z);
+    }
+}
+
+template <typename L>
+inline void store(MutableVector3View v, std::size_t i, L x, L y, L z) {
+    if (v.stride == 1) {
+        x.store(v.x + i);
+        y.store(v.y + i);
+        z.store(v.z + i);
+    } else {
+        L::storePacked(v.x + i * 3, x, y, z);
+    }
+}
+
+template <typename L>
+inline L dot3(L ax, L ay, L az, L bx, L by, L bz) {
+    return ax * bx + ay * by + az * bz;
+}
+#endif
+
+} // namespace
+
+void Vector3Stream::assign(const Vector3* src, std::size_t n) {
+    resize(n);
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    for (; i + Lanes4::width <= n; i += Lanes4::width) {
+        Lanes4 x, y, z;
+        Lanes4::loadPacked(&src[i].x, x, y, z);
+        x.store(&x_[i]);
+        y.store(&y_[i]);
+        z.store(&z_[i]);
+    }
+#endif
+    for (; i < n; ++i) {
+        set(i, src[i]);
+    }
+}
+
+void Vector3Stream::copyTo(Vector3* dst) const {
+    const std::size_t n = size();
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    for (; i + Lanes4::width <= n; i += Lanes4::width) {
+        Lanes4::storePacked(&dst[i].x, Lanes4::load(&x_[i]), Lanes4::load(&y_[i]), Lanes4::load(&z_[i]));
+    }
+#endif
+    for (; i < n; ++i) {
+        dst[i] = (*this)[i];
+    }
+}
+
+namespace stream {
+
+void dot(Vector3View a, Vector3View b, float* out) {
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    i = forLanes(a.isSoA() && b.isSoA(), [&](auto lanes) {
+        using L = decltype(lanes);
+        std::size_t j = 0;
+        for (; j + L::width <= a.size; j += L::width) {
+            L ax, ay, az, bx, by, bz;
+            load(a, j, ax, ay, az);
+            load(b, j, bx, by, bz);
+            dot3(ax, ay, az, bx, by, bz).store(out + j);
+        }
+        return j;
+    });
+#endif
+    for (; i < a.size; ++i) {
+        out[i] = a[i].dot(b[i]);
+    }
+}
+
+void cross(Vector3View a, Vector3View b, MutableVector3View out) {
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    i = forLanes(a.isSoA() && b.isSoA() && out.isSoA(), [&](auto lanes) {
+        using L = decltype(lanes);
+        std::size_t j = 0;
+        for (; j + L::width <= a.size; j += L::width) {
+            L ax, ay, az, bx, by, bz;
+            load(a, j, ax, ay, az);
+            load(b, j, bx, by, bz);
+            store(out, j, ay * bz - az * by, az * bx - ax * bz, ax * by - ay * bx);
+        }
+        return j;
+    });
+#endif
+    for (; i < a.size; ++i) {
+        put(out, i, a[i].cross(b[i]));
+    }
+}
+
+void lengthSquared(Vector3View a, float* out) {
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    i = forLanes(a.isSoA(), [&](auto lanes) {
+        using L = decltype(lanes);
+        std::size_t j = 0;
+        for (; j + L::width <= a.size; j += L::width) {
+            L x, y, z;
+            load(a, j, x, y, z);
+            dot3(x, y, z, x, y, z).store(out + j);
+        }
+        return j;
+    });
+#endif
+    for (; i < a.size; ++i) {
+        out[i] = a[i].lengthSquared();
+    }
+}
+
+void length(Vector3View a, float* out) {
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    i = forLanes(a.isSoA(), [&](auto lanes) {
+        using L = decltype(lanes);
+        std::size_t j = 0;
+        for (; j + L::width <= a.size; j += L::width) {
+            L x, y, z;
+            load(a, j, x, y, z);
+            L::sqrt(dot3(x, y, z, x, y, z)).store(out + j);
+        }
+        return j;
+    });
+#endif
+    for (; i < a.size; ++i) {
+        out[i] = a[i].length();
+    }
+}
+
+void normalize(Vector3View a, MutableVector3View out) {
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    i = forLanes(a.isSoA() && out.isSoA(), [&](auto lanes) {
+        using L = decltype(lanes);
+        const L one = L::set1(1.0f);
+        const L eps = L::set1(EPSILON);
+        std::size_t j = 0;
+        for (; j + L::width <= a.size; j += L::width) {
+            L x, y, z;
+            load(a, j, x, y, z);
+            L len = L::sqrt(dot3(x, y, z, x, y, z));
+            // Same policy as Vector3::normalized: near-zero vectors become zero.
+            L inv = (one / len) & (len >= eps);
+            store(out, j, x * inv, y * inv, z * inv);
+        }
+        return j;
+    });
+#endif
+    for (; i < a.size; ++i) {
+        put(out, i, a[i].normalized());
+    }
+}
+
+void lerp(Vector3View a, Vector3View b, float t, MutableVector3View out) {
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    i = forLanes(a.isSoA() && b.isSoA() && out.isSoA(), [&](auto lanes) {
+        using L = decltype(lanes);
+        const L vt = L::set1(t);
+        std::size_t j = 0;
+        for (; j + L::width <= a.size; j += L::width) {
+            L ax, ay, az, bx, by, bz;
+            load(a, j, ax, ay, az);
+            load(b, j, bx, by, bz);
+            store(out, j, ax + vt * (bx - ax), ay + vt * (by - ay), az + vt * (bz - az));
+        }
+        return j;
+    });
+#endif
+    for (; i < a.size; ++i) {
+        put(out, i, Vector3::lerp(a[i], b[i], t));
+    }
+}
+
+void min(Vector3View a, Vector3View b, MutableVector3View out) {
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    i = forLanes(a.isSoA() && b.isSoA() && out.isSoA(), [&](auto lanes) {
+        using L = decltype(lanes);
+        std::size_t j = 0;
+        for (; j + L::width <= a.size; j += L::width) {
+            L ax, ay, az, bx, by, bz;
+            load(a, j, ax, ay, az);
+            load(b, j, bx, by, bz);
+            store(out, j, L::min(ax, bx), L::min(ay, by), L::min(az, bz));
+        }
+        return j;
+    });
+#endif
+    for (; i < a.size; ++i) {
+        put(out, i, Vector3::min(a[i], b[i]));
+    }
+}
+
+void max(Vector3View a, Vector3View b, MutableVector3View out) {
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    i = forLanes(a.isSoA() && b.isSoA() && out.isSoA(), [&](auto lanes) {
+        using L = decltype(lanes);
+        std::size_t j = 0;
+        for (; j + L::width <= a.size; j += L::width) {
+            L ax, ay, az, bx, by, bz;
+            load(a, j, ax, ay, az);
+            load(b, j, bx, by, bz);
+            store(out, j, L::max(ax, bx), L::max(ay, by), L::max(az, bz));
+        }
+        return j;
+    });
+#endif
+    for (; i < a.size; ++i) {
+        put(out, i, Vector3::max(a[i], b[i]));
+    }
+}
+
+Bounds3 computeBounds(Vector3View a) {
+    if (a.size == 0) {
+        return {Vector3::zero, Vector3::zero};
+    }
+    Bounds3 bounds{a[0], a[0]};
+    std::size_t i = 0;
+#if defined(TIMATH_SSE)
+    i = forLanes(a.isSoA(), [&](auto lanes) {
+        using L = decltype(lanes);
+        if (a.size < L::width) {
+            return std::size_t(0);
+        }
+        L minX, minY, minZ;
+        load(a, 0, minX, minY, minZ);
+        L maxX = minX, maxY = minY, maxZ = minZ;
+        std::size_t j = L::width;
+        for (; j + L::width <= a.size; j += L::width) {
+            L x, y, z;
+            load(a, j, x, y, z);
+            minX = L::min(minX, x); maxX = L::max(maxX, x);
+            minY = L::min(minY, y); maxY = L::max(maxY, y);
+            minZ = L::min(minZ, z); maxZ = L::max(maxZ, z);
+        }
+        float lo[3][L::width], hi[3][L::width];
+        minX.store(lo[0]); minY.store(lo[1]); minZ.store(lo[2]);
+        maxX.store(hi[0]); maxY.store(hi[1]); maxZ.store(hi[2]);
+        for (std::size_t lane = 0; lane < L::width; ++lane) {
+            bounds.min = Vector3::min(bounds.min, Vector3(lo[0][lane], lo[1][lane], lo[2][lane]));
+            bounds.max = Vector3::max(bounds.max, Vector3(hi[0][lane], hi[1][lane], hi[2][lane]));
+        }
+        return j;
+    });
+#endif
+    for (; i < a.size; ++i) {
+        bounds.min = Vector3::min(bounds.min, a[i]);
+        bounds.max = Vector3::max(bounds.max, a[i]);
+    }
+    return bounds;
+}
+
+} // namespace stream
+} // namespace TiMath
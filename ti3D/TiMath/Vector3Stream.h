@@ -0,0 +1,167 @@
+#ifndef VECTOR3_STREAM_H
+#define VECTOR3_STREAM_H
+
+#include <cstddef>
+#include <vector>
+#include "TiMathConfig.h"
+#include "AlignedAllocator.h"
+#include "Vector3.h"
+
+namespace TiMath {
+
+/**
+ * @brief Non-owning view of n 3D vectors stored as three strided float arrays.
+ *
+ * stride == 1 is structure-of-arrays (a Vector3Stream); stride == 3 is a packed
+ * Vector3 array (e.g. std::vector<Vector3>) viewed in place, with y == x + 1 and z == x + 2.
+ * The stream kernels accept either layout, so existing AoS buffers can be fed to them without a copy.
+ */
+template <typename T>
+struct Vector3ViewT {
+    T* x = nullptr;
+    T* y = nullptr;
+    T* z = nullptr;
+    std::size_t size = 0;
+    std::size_t stride = 1;
+
+    /** @brief Reads element i as a Vector3. */
+    [[nodiscard]] Vector3 operator[](std::size_t i) const {
+        return Vector3(x[i * stride], y[i * stride], z[i * stride]);
+    }
+
+    /** @brief Returns true for structure-of-arrays layout. */
+    [[nodiscard]] bool isSoA() const { return stride == 1; }
+
+    /** @brief Converts a mutable view into a read-only one. */
+    operator Vector3ViewT<const T>() const { return {x, y, z, size, stride}; }
+};
+
+using Vector3View = Vector3ViewT<const float>;
+using MutableVector3View = Vector3ViewT<float>;
+
+/** @brief Zero-copy read-only view over a packed Vector3 array. */
+[[nodiscard]] inline Vector3View makeView(const Vector3* data, std::size_t n) {
+    return {&data->x, &data->y, &data->z, n, 3};
+}
+
+/** @brief Zero-copy mutable view over a packed Vector3 array. */
+[[nodiscard]] inline MutableVector3View makeView(Vector3* data, std::size_t n) {
+    return {&data->x, &data->y, &data->z, n, 3};
+}
+
+/** @brief Zero-copy read-only view over a std::vector<Vector3>. */
+[[nodiscard]] inline Vector3View makeView(const std::vector<Vector3>& v) {
+    return makeView(v.data(), v.size());
+}
+
+/** @brief Zero-copy mutable view over a std::vector<Vector3>. */
+[[nodiscard]] inline MutableVector3View makeView(std::vector<Vector3>& v) {
+    return makeView(v.data(), v.size());
+}
+
+/**
+ * @class Vector3Stream
+ * @brief Structure-of-arrays storage for many 3D vectors: separate 32-byte aligned x, y, z arrays.
+ */
+class Vector3Stream {
+public:
+    using Buffer = std::vector<float, AlignedAllocator<float, 32>>;
+
+    Vector3Stream() = default;
+    explicit Vector3Stream(std::size_t n) : x_(n), y_(n), z_(n) {}
+
+    /** @brief Copies (transposes) a packed Vector3 array into SoA layout. */
+    explicit Vector3Stream(const std::vector<Vector3>& v) { assign(v.data(), v.size()); }
+
+    [[nodiscard]] std::size_t size() const { return x_.size(); }
+    [[nodiscard]] bool empty() const { return x_.empty(); }
+
+    void resize(std::size_t n) {
+        x_.resize(n);
+        y_.resize(n);
+        z_.resize(n);
+    }
+
+    void clear() { resize(0); }
+
+    [[nodiscard]] float* x() { return x_.data(); }
+    [[nodiscard]] float* y() { return y_.data(); }
+    [[nodiscard]] float* z() { return z_.data(); }
+    [[nodiscard]] const float* x() const { return x_.data(); }
+    [[nodiscard]] const float* y() const { return y_.data(); }
+    [[nodiscard]] const float* z() const { return z_.data(); }
+
+    /** @brief Reads element i as a Vector3. */
+    [[nodiscard]] Vector3 operator[](std::size_t i) const { return Vector3(x_[i], y_[i], z_[i]); }
+
+    /** @brief Writes element i. */
+    void set(std::size_t i, const Vector3& v) {
+        x_[i] = v.x;
+        y_[i] = v.y;
+        z_[i] = v.z;
+    }
+
+    [[nodiscard]] Vector3View view() const { return {x_.data(), y_.data(), z_.data(), size(), 1}; }
+    [[nodiscard]] MutableVector3View view() { return {x_.data(), y_.data(), z_.data(), size(), 1}; }
+
+    /** @brief Replaces the contents with a transposed copy of n packed vectors. */
+    void assign(const Vector3* src, std::size_t n);
+
+    /** @brief Writes the contents back to a packed Vector3 array of at least size() elements. */
+    void copyTo(Vector3* dst) const;
+
+    /** @brief Returns the contents as a packed std::vector<Vector3>. */
+    [[nodiscard]] std::vector<Vector3> toVector() const {
+        std::vector<Vector3> out(size());
+        copyTo(out.data());
+        return out;
+    }
+
+private:
+    Buffer x_, y_, z_;
+};
+
+/** @brief Axis-aligned bounds produced by the stream bounds reduction. */
+struct Bounds3 {
+    Vector3 min;
+    Vector3 max;
+};
+
+namespace stream {
+
+// Bulk kernels. Inputs and outputs must have matching sizes; an output may be the same
+// view as an input. All kernels are vectorized when TIMATH_SSE is defined, four elements
+// per iteration or eight with TIMATH_AVX, for both SoA (stride 1) and packed AoS (stride 3)
+// views.
+
+/** @brief out[i] = a[i] . b[i] */
+void dot(Vector3View a, Vector3View b, float* out);
+
+/** @brief out[i] = a[i] x b[i] */
+void cross(Vector3View a, Vector3View b, MutableVector3View out);
+
+/** @brief out[i] = |a[i]|^2 */
+void lengthSquared(Vector3View a, float* out);
+
+/** @brief out[i] = |a[i]| */
+void length(Vector3View a, float* out);
+
+/** @brief out[i] = a[i].normalized(); vectors shorter than EPSILON become zero. */
+void normalize(Vector3View a, MutableVector3View out);
+
+/** @brief out[i] = a[i] + t * (b[i] - a[i]) */
+void lerp(Vector3View a, Vector3View b, float t, MutableVector3View out);
+
+/** @brief out[i] = component-wise min(a[i], b[i]) */
+void min(Vector3View a, Vector3View b, MutableVector3View out);
+
+/** @brief out[i] = component-wise max(a[i], b[i]) */
+void max(Vector3View a, Vector3View b, MutableVector3View out);
+
+/** @brief Reduces a set of points to their axis-aligned bounding box; empty input gives a zero box. */
+[[nodiscard]] Bounds3 computeBounds(Vector3View a);
+
+} // namespace stream
+} // namespace TiMath
+
+#endif // VECTOR3_STREAM_H
@@ -3,9 +3,15 @@
 
 namespace TiMath {
 
-std::ostream& operator<<(std::ostream& os, const Vector4& v) {
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const Vector4T<T>& v) {
     os << "(" << v.x << ", " << v.y << ", " << v.z << ", " << v.w << ")";
     return os;
 }
 
-} // namespace TiMath
\ No newline at end of file
+template class Vector4T<float>;
+template class Vector4T<double>;
+template std::ostream& operator<<(std::ostream&, const Vector4T<float>&);
+template std::ostream& operator<<(std::ostream&, const Vector4T<double>&);
+
+} // namespace TiMath
@@ -13,69 +13,77 @@
 
 namespace TiMath {
 
-class Vector4 {
+template <typename T>
+class Vector4T {
 public:
-    float x, y, z, w;
+    using value_type = T;
+
+    T x, y, z, w;
 
     // Static constant declarations
-    static const Vector4 zero;
-    static const Vector4 unitX;
-    static const Vector4 unitY;
-    static const Vector4 unitZ;
-    static const Vector4 unitW;
+    static const Vector4T zero;
+    static const Vector4T unitX;
+    static const Vector4T unitY;
+    static const Vector4T unitZ;
+    static const Vector4T unitW;
+
+    constexpr Vector4T(T x = 0.0f, T y = 0.0f, T z = 0.0f, T w = 0.0f) : x(x), y(y), z(z), w(w) {}
+    constexpr Vector4T(const Vector3T<T>& v, T w = 1.0f) : x(v.x), y(v.y), z(v.z), w(w) {}
 
-    constexpr Vector4(float x = 0.0f, float y = 0.0f, float z = 0.0f, float w = 0.0f) : x(x), y(y), z(z), w(w) {}
-    constexpr Vector4(const Vector3& v, float w = 1.0f) : x(v.x), y(v.y), z(v.z), w(w) {}
+    /** @brief Converts from another scalar type, e.g. Vector4d to Vector4. */
+    template <typename U>
+    explicit constexpr Vector4T(const Vector4T<U>& other)
+        : x(static_cast<T>(other.x)), y(static_cast<T>(other.y)), z(static_cast<T>(other.z)), w(static_cast<T>(other.w)) {}
 
     // Arithmetic operators
     /** @brief Adds two vectors component-wise. */
-    [[nodiscard]] inline Vector4 operator+(const Vector4& other) const {
-        return Vector4(x + other.x, y + other.y, z + other.z, w + other.w);
+    [[nodiscard]] inline Vector4T operator+(const Vector4T& other) const {
+        return Vector4T(x + other.x, y + other.y, z + other.z, w + other.w);
     }
 
     /** @brief Subtracts two vectors component-wise. */
-    [[nodiscard]] inline Vector4 operator-(const Vector4& other) const {
-        return Vector4(x - other.x, y - other.y, z - other.z, w - other.w);
+    [[nodiscard]] inline Vector4T operator-(const Vector4T& other) const {
+        return Vector4T(x - other.x, y - other.y, z - other.z, w - other.w);
     }
 
     /** @brief Negates all components of the vector. */
-    [[nodiscard]] inline Vector4 operator-() const {
-        return Vector4(-x, -y, -z, -w);
+    [[nodiscard]] inline Vector4T operator-() const {
+        return Vector4T(-x, -y, -z, -w);
     }
 
     /** @brief Scales the vector by a scalar. */
-    [[nodiscard]] inline Vector4 operator*(float scalar) const {
-        return Vector4(x * scalar, y * scalar, z * scalar, w * scalar);
+    [[nodiscard]] inline Vector4T operator*(T scalar) const {
+        return Vector4T(x * scalar, y * scalar, z * scalar, w * scalar);
     }
 
     /** @brief Divides the vector by a scalar, returns zero vector if scalar is near zero. */
-    [[nodiscard]] inline Vector4 operator/(float scalar) const {
+    [[nodiscard]] inline Vector4T operator/(T scalar) const {
         if (std::fabs(scalar) < TiMath::EPSILON) {
-            return Vector4{0.0f, 0.0f, 0.0f, 0.0f}; // Safe default
+            return Vector4T{0.0f, 0.0f, 0.0f, 0.0f}; // Safe default
         }
-        return Vector4(x / scalar, y / scalar, z / scalar, w / scalar);
+        return Vector4T(x / scalar, y / scalar, z / scalar, w / scalar);
     }
 
     /** @brief Adds another vector to this one. */
-    inline Vector4& operator+=(const Vector4& other) {
+    inline Vector4T& operator+=(const Vector4T& other) {
         x += other.x; y += other.y; z += other.z; w += other.w;
         return *this;
     }
 
     /** @brief Subtracts another vector from this one. */
-    inline Vector4& operator-=(const Vector4& other) {
+    inline Vector4T& operator-=(const Vector4T& other) {
         x -= other.x; y -= other.y; z -= other.z; w -= other.w;
         return *this;
     }
 
     /** @brief Scales this vector by a scalar. */
-    inline Vector4& operator*=(float scalar) {
+    inline Vector4T& operator*=(T scalar) {
         x *= scalar; y *= scalar; z *= scalar; w *= scalar;
         return *this;
     }
 
     /** @brief Divides this vector by a scalar, sets to zero if scalar is near zero. */
-    inline Vector4& operator/=(float scalar) {
+    inline Vector4T& operator/=(T scalar) {
         if (std::fabs(scalar) < TiMath::EPSILON) {
             x = y = z = w = 0.0f; // Safe default
             return *this;
@@ -86,47 +94,47 @@ public:
 
     // Vector operations
     /** @brief Computes the dot product with another vector. */
-    [[nodiscard]] constexpr float dot(const Vector4& other) const {
+    [[nodiscard]] constexpr T dot(const Vector4T& other) const {
         return x * other.x + y * other.y + z * other.z + w * other.w;
     }
 
     /** @brief Returns the length (magnitude) of the vector. */
-    [[nodiscard]] inline float length() const {
+    [[nodiscard]] inline T length() const {
         return std::sqrt(lengthSquared());
     }
 
     /** @brief Returns the squared length of the vector. */
-    [[nodiscard]] constexpr float lengthSquared() const {
+    [[nodiscard]] constexpr T lengthSquared() const {
         return x * x + y * y + z * z + w * w;
     }
 
     /** @brief Returns a normalized copy of the vector, or zero if length is near zero. */
-    [[nodiscard]] inline Vector4 normalized() const {
-        float len = length();
-        return len < TiMath::EPSILON ? Vector4{0.0f, 0.0f, 0.0f, 0.0f} : Vector4{x / len, y / len, z / len, w / len};
+    [[nodiscard]] inline Vector4T normalized() const {
+        T len = length();
+        return len < TiMath::EPSILON ? Vector4T{0.0f, 0.0f, 0.0f, 0.0f} : Vector4T{x / len, y / len, z / len, w / len};
     }
 
     /** @brief Returns a normalized copy, assuming non-zero length. */
-    [[nodiscard]] inline Vector4 normalizedUnsafe() const {
-        float len = length();
-        return Vector4{x / len, y / len, z / len, w / len}; // Assumes len != 0
+    [[nodiscard]] inline Vector4T normalizedUnsafe() const {
+        T len = length();
+        return Vector4T{x / len, y / len, z / len, w / len}; // Assumes len != 0
     }
 
     /** @brief Converts homogeneous coordinates to 3D by dividing (x, y, z) by w, returns zero if w is near zero. */
-    [[nodiscard]] inline Vector3 homogeneousDivide() const {
+    [[nodiscard]] inline Vector3T<T> homogeneousDivide() const {
         if (std::fabs(w) < TiMath::EPSILON) {
-            return Vector3{0.0f, 0.0f, 0.0f}; // Safe default
+            return Vector3T<T>{0.0f, 0.0f, 0.0f}; // Safe default
         }
-        return Vector3(x / w, y / w, z / w);
+        return Vector3T<T>(x / w, y / w, z / w);
     }
 
     /** @brief Extracts the 3D component (x, y, z) as a Vector3. */
-    [[nodiscard]] inline Vector3 toVector3() const {
-        return Vector3(x, y, z);
+    [[nodiscard]] inline Vector3T<T> toVector3() const {
+        return Vector3T<T>(x, y, z);
     }
 
     /** @brief Checks if the vector is near zero within epsilon. */
-    [[nodiscard]] inline bool isZero(float epsilon = TiMath::EPSILON) const {
+    [[nodiscard]] inline bool isZero(T epsilon = EPSILON_T<T>) const {
         return std::fabs(x) < epsilon && std::fabs(y) < epsilon &&
                std::fabs(z) < epsilon && std::fabs(w) < epsilon;
     }
@@ -137,7 +145,7 @@ public:
     }
 
     /** @brief Compares vectors for approximate equality within epsilon. */
-    [[nodiscard]] inline bool operator==(const Vector4& other) const {
+    [[nodiscard]] inline bool operator==(const Vector4T& other) const {
         return std::fabs(x - other.x) < TiMath::EPSILON &&
                std::fabs(y - other.y) < TiMath::EPSILON &&
                std::fabs(z - other.z) < TiMath::EPSILON &&
@@ -145,13 +153,13 @@ public:
     }
 
     /** @brief Compares vectors for inequality. */
-    [[nodiscard]] inline bool operator!=(const Vector4& other) const {
+    [[nodiscard]] inline bool operator!=(const Vector4T& other) const {
         return !(*this == other);
     }
 
     /** @brief Linearly interpolates between two vectors. */
-    [[nodiscard]] static inline Vector4 lerp(const Vector4& v1, const Vector4& v2, float t) {
-        return Vector4(
+    [[nodiscard]] static inline Vector4T lerp(const Vector4T& v1, const Vector4T& v2, T t) {
+        return Vector4T(
             v1.x + t * (v2.x - v1.x),
             v1.y + t * (v2.y - v1.y),
             v1.z + t * (v2.z - v1.z),
@@ -160,8 +168,8 @@ public:
     }
 
     /** @brief Returns a vector with component-wise minimums. */
-    [[nodiscard]] static inline Vector4 min(const Vector4& a, const Vector4& b) {
-        return Vector4(
+    [[nodiscard]] static inline Vector4T min(const Vector4T& a, const Vector4T& b) {
+        return Vector4T(
             std::min(a.x, b.x),
             std::min(a.y, b.y),
             std::min(a.z, b.z),
@@ -170,8 +178,8 @@ public:
     }
 
     /** @brief Returns a vector with component-wise maximums. */
-    [[nodiscard]] static inline Vector4 max(const Vector4& a, const Vector4& b) {
-        return Vector4(
+    [[nodiscard]] static inline Vector4T max(const Vector4T& a, const Vector4T& b) {
+        return Vector4T(
             std::max(a.x, b.x),
             std::max(a.y, b.y),
             std::max(a.z, b.z),
@@ -180,8 +188,8 @@ public:
     }
 
     /** @brief Clamps each component within a range. */
-    [[nodiscard]] inline Vector4 clamp(float minVal, float maxVal) const {
-        return Vector4(
+    [[nodiscard]] inline Vector4T clamp(T minVal, T maxVal) const {
+        return Vector4T(
             std::clamp(x, minVal, maxVal),
             std::clamp(y, minVal, maxVal),
             std::clamp(z, minVal, maxVal),
@@ -189,20 +197,23 @@ public:
         );
     }
 
-    friend std::ostream& operator<<(std::ostream& os, const Vector4& v);
 };
 
 // Static constant definitions
-inline constexpr Vector4 Vector4::zero{0.0f, 0.0f, 0.0f, 0.0f};
-inline constexpr Vector4 Vector4::unitX{1.0f, 0.0f, 0.0f, 0.0f};
-inline constexpr Vector4 Vector4::unitY{0.0f, 1.0f, 0.0f, 0.0f};
-inline constexpr Vector4 Vector4::unitZ{0.0f, 0.0f, 1.0f, 0.0f};
-inline constexpr Vector4 Vector4::unitW{0.0f, 0.0f, 0.0f, 1.0f};
-
-[[nodiscard]] inline Vector4 operator*(float scalar, const Vector4& v) {
+template <typename T> inline constexpr Vector4T<T> Vector4T<T>::zero{0, 0, 0, 0};
+template <typename T> inline constexpr Vector4T<T> Vector4T<T>::unitX{1, 0, 0, 0};
+template <typename T> inline constexpr Vector4T<T> Vector4T<T>::unitY{0, 1, 0, 0};
+template <typename T> inline constexpr Vector4T<T> Vector4T<T>::unitZ{0, 0, 1, 0};
+template <typename T> inline constexpr Vector4T<T> Vector4T<T>::unitW{0, 0, 0, 1};
+
+template <typename T>
+[[nodiscard]] inline Vector4T<T> operator*(typename Vector4T<T>::value_type scalar, const Vector4T<T>& v) {
     return v * scalar;
 }
 
+template <typename T>
+std::ostream& operator<<(std::ostream& os, const Vector4T<T>& v);
+
 } // namespace TiMath
 
 #endif // VECTOR4_H
\ No newline at end of file
@@ -1,8 +1,547 @@
 #include "Vector3.h"
+#include "Vector4.h"
 #include "Matrix4.h"
 #include "Quaternion.h"
+#include "QuaternionBlend.h"
+#include "BatchTransform.h"
+#include "Vector3Stream.h"
+#include "Affine3.h"
+#include "TiMathError.h"
+#include "TiMathConstexpr.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <vector>
+
+using namespace TiMath;
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (!ok) {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+bool nearlyEqual(const Matrix4& a, const Matrix4& b, float tol) {
+    for (int i = 0; i < 16; ++i) {
+        float scale = std::max(1.0f, std::max(std::fabs(a.m[i]), std::fabs(b.m[i])));
+        if (std::fabs(a.m[i] - b.m[i]) > tol * scale) return false;
+    }
+    return true;
+}
+
+// Norm-wise comparison: a component that cancels to near zero is judged against the
+// magnitude of the whole vector, so FMA contraction differences do not trip it.
+bool nearlyEqual(const Vector4& a, const Vector4& b, float tol) {
+    float scale = std::max({1.0f, std::fabs(a.x), std::fabs(a.y), std::fabs(a.z), std::fabs(a.w)});
+    return std::fabs(a.x - b.x) <= tol * scale && std::fabs(a.y - b.y) <= tol * scale &&
+           std::fabs(a.z - b.z) <= tol * scale && std::fabs(a.w - b.w) <= tol * scale;
+}
+
+// Random TRS matrix: well conditioned, like the transforms the renderer feeds us.
+Matrix4 randomTransform(std::mt19937& rng) {
+    std::uniform_real_distribution<float> pos(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+    std::uniform_real_distribution<float> scale(0.25f, 4.0f);
+    Vector3 axis(pos(rng), pos(rng), pos(rng));
+    if (axis.isZero()) axis = Vector3::unitY;
+    return Matrix4::translation(Vector3(pos(rng), pos(rng), pos(rng))) *
+           Matrix4::rotationAxis(axis, angle(rng)) *
+           Matrix4::scaling(Vector3(scale(rng), scale(rng), scale(rng)));
+}
+
+// Fully populated matrix, including a non-trivial bottom row.
+Matrix4 randomGeneral(std::mt19937& rng) {
+    std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+    Matrix4 r;
+    for (float& f : r.m) f = value(rng);
+    r.m[0] += 4.0f; r.m[5] += 4.0f; r.m[10] += 4.0f; r.m[15] += 4.0f; // keep it invertible
+    return r;
+}
+
+void testMatrixKernels() {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+    for (int i = 0; i < 1000; ++i) {
+        Matrix4 a = (i & 1) ? randomGeneral(rng) : randomTransform(rng);
+        Matrix4 b = (i & 2) ? randomGeneral(rng) : randomTransform(rng);
+        Vector4 v(value(rng), value(rng), value(rng), (i & 4) ? 1.0f : value(rng));
+
+        check(nearlyEqual(Matrix4::multiplyScalar(a, Matrix4::inverseScalar(a)), Matrix4::getIdentity(), 1e-4f),
+              "inverse: a * inv(a) == I (scalar)");
+#if defined(TIMATH_SSE)
+        check(nearlyEqual(Matrix4::multiplyScalar(a, b), Matrix4::multiplySIMD(a, b), 1e-5f), "multiply: SIMD matches scalar");
+        check(nearlyEqual(Matrix4::inverseScalar(a), Matrix4::inverseSIMD(a), 1e-4f), "inverse: SIMD matches scalar");
+        check(nearlyEqual(Matrix4::transformScalar(a, v), Matrix4::transformSIMD(a, v), 1e-5f), "transform: SIMD matches scalar");
+#else
+        check(nearlyEqual(a * b, Matrix4::multiplyScalar(a, b), 0.0f), "multiply: dispatches to scalar");
+        check(nearlyEqual(a * v, Matrix4::transformScalar(a, v), 0.0f), "transform: dispatches to scalar");
+#endif
+    }
+#if defined(TIMATH_AVX)
+    std::cout << "Matrix4 AVX kernels checked against scalar reference\n";
+#elif defined(TIMATH_SSE)
+    std::cout << "Matrix4 SSE kernels checked against scalar reference\n";
+#else
+    std::cout << "USE_SSE disabled or unsupported, scalar path only\n";
+#endif
+}
+
+void testBatchTransforms() {
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> value(-50.0f, 50.0f);
+    Matrix4 world = randomTransform(rng);
+    Matrix4 viewProj = Matrix4::perspective(60.0f, 1.5f, 0.1f, 100.0f) * randomTransform(rng);
+
+    // Odd size above PARALLEL_BATCH_THRESHOLD so both the chunking and the scalar tail run.
+    const std::size_t n = PARALLEL_BATCH_THRESHOLD * 3 + 7;
+    std::vector<Vector3> points(n);
+    std::vector<Vector4> hpoints(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        points[i] = Vector3(value(rng), value(rng), value(rng));
+        hpoints[i] = Vector4(points[i], value(rng));
+    }
+
+    std::vector<Vector3> out(n);
+    transformPoints(world, points.data(), out.data(), n);
+    bool ok = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        ok = ok && nearlyEqual(Vector4(out[i], 1.0f), world * Vector4(points[i], 1.0f), 1e-5f);
+    }
+    check(ok, "transformPoints matches Matrix4 * Vector4(p, 1)");
+
+    transformDirections(world, points.data(), out.data(), n);
+    ok = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        ok = ok && nearlyEqual(Vector4(out[i], 0.0f), world * Vector4(points[i], 0.0f), 1e-5f);
+    }
+    check(ok, "transformDirections matches Matrix4 * Vector4(d, 0)");
+
+    transformPointsProjective(viewProj, points.data(), out.data(), n);
+    ok = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        Vector4 clip = viewProj * Vector4(points[i], 1.0f);
+        if (std::fabs(clip.w) < 1e-2f) continue; // ill-conditioned: w itself is mostly rounding error
+        ok = ok && nearlyEqual(Vector4(out[i], 0.0f), Vector4(clip.homogeneousDivide(), 0.0f), 1e-4f);
+    }
+    check(ok, "transformPointsProjective matches homogeneousDivide");
+
+    std::vector<Vector4> hout(n);
+    transformHomogeneous(viewProj, hpoints.data(), hout.data(), n);
+    ok = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        ok = ok && nearlyEqual(hout[i], viewProj * hpoints[i], 1e-5f);
+    }
+    check(ok, "transformHomogeneous matches Matrix4 * Vector4");
+
+    std::vector<Vector3> inPlace = points;
+    transformPoints(world, inPlace.data(), inPlace.data(), n);
+    transformPoints(world, points.data(), out.data(), n);
+    ok = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        ok = ok && inPlace[i] == out[i];
+    }
+    check(ok, "transformPoints in place");
+    std::cout << "Batched transforms checked over " << n << " points\n";
+}
+
+bool nearlyEqual(const Vector3& a, const Vector3& b, float tol) {
+    return nearlyEqual(Vector4(a, 0.0f), Vector4(b, 0.0f), tol);
+}
+
+void testVector3Stream() {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> value(-20.0f, 20.0f);
+    const std::size_t n = 1003;
+    std::vector<Vector3> a(n), b(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        a[i] = Vector3(value(rng), value(rng), value(rng));
+        b[i] = Vector3(value(rng), value(rng), value(rng));
+    }
+    a[5] = Vector3::zero; // exercises the near-zero normalize policy inside a SIMD block
+
+    Vector3Stream sa(a), sb(b);
+    check(sa.size() == n && reinterpret_cast<std::uintptr_t>(sa.x()) % 32 == 0, "Vector3Stream storage is 32-byte aligned");
+    std::vector<Vector3> roundTrip = sa.toVector();
+    bool ok = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        ok = ok && roundTrip[i].x == a[i].x && roundTrip[i].y == a[i].y && roundTrip[i].z == a[i].z;
+    }
+    check(ok, "Vector3Stream round-trips through std::vector<Vector3>");
+
+    // Every kernel runs on the SoA stream and on a zero-copy view of the AoS vector.
+    const Vector3View views[2][2] = {{sa.view(), sb.view()}, {makeView(a), makeView(b)}};
+    for (const auto& in : views) {
+        std::vector<float> scalars(n);
+        Vector3Stream out(n);
+        std::vector<Vector3> aosOut(n);
+        const MutableVector3View outs[2] = {out.view(), makeView(aosOut)};
+
+        stream::dot(in[0], in[1], scalars.data());
+        ok = true;
+        for (std::size_t i = 0; i < n; ++i) ok = ok && std::fabs(scalars[i] - a[i].dot(b[i])) <= 1e-4f * std::max(1.0f, std::fabs(scalars[i]));
+        check(ok, "stream::dot");
+
+        stream::length(in[0], scalars.data());
+        ok = true;
+        for (std::size_t i = 0; i < n; ++i) ok = ok && std::fabs(scalars[i] - a[i].length()) <= 1e-5f * std::max(1.0f, scalars[i]);
+        check(ok, "stream::length");
+
+        stream::lengthSquared(in[0], scalars.data());
+        ok = true;
+        for (std::size_t i = 0; i < n; ++i) ok = ok && std::fabs(scalars[i] - a[i].lengthSquared()) <= 1e-5f * std::max(1.0f, scalars[i]);
+        check(ok, "stream::lengthSquared");
+
+        for (const MutableVector3View& o : outs) {
+            stream::cross(in[0], in[1], o);
+            ok = true;
+            for (std::size_t i = 0; i < n; ++i) ok = ok && nearlyEqual(o[i], a[i].cross(b[i]), 1e-5f);
+            check(ok, "stream::cross");
+
+            stream::normalize(in[0], o);
+            ok = true;
+            for (std::size_t i = 0; i < n; ++i) ok = ok && nearlyEqual(o[i], a[i].normalized(), 1e-6f);
+            check(ok, "stream::normalize");
+
+            stream::lerp(in[0], in[1], 0.3f, o);
+            ok = true;
+            for (std::size_t i = 0; i < n; ++i) ok = ok && nearlyEqual(o[i], Vector3::lerp(a[i], b[i], 0.3f), 1e-6f);
+            check(ok, "stream::lerp");
+
+            stream::min(in[0], in[1], o);
+            ok = true;
+            for (std::size_t i = 0; i < n; ++i) ok = ok && o[i] == Vector3::min(a[i], b[i]);
+            check(ok, "stream::min");
+
+            stream::max(in[0], in[1], o);
+            ok = true;
+            for (std::size_t i = 0; i < n; ++i) ok = ok && o[i] == Vector3::max(a[i], b[i]);
+            check(ok, "stream::max");
+        }
+
+        Bounds3 bounds = stream::computeBounds(in[0]);
+        Vector3 lo = a[0], hi = a[0];
+        for (const Vector3& p : a) {
+            lo = Vector3::min(lo, p);
+            hi = Vector3::max(hi, p);
+        }
+        check(bounds.min == lo && bounds.max == hi, "stream::computeBounds");
+    }
+    std::cout << "Vector3Stream kernels checked over SoA and AoS views\n";
+}
+
+void testQuaternionRotation() {
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> value(-3.0f, 3.0f);
+    const std::size_t n = 2 * PARALLEL_BATCH_THRESHOLD + 13; // Large enough to be split across threads
+    std::vector<Quaternion> qs(n);
+    std::vector<Vector3> vs(n), expected(n), out(n);
+    bool ok = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        qs[i] = Quaternion(value(rng), value(rng), value(rng), value(rng)); // deliberately not unit
+        vs[i] = Vector3(value(rng), value(rng), value(rng));
+        Quaternion r = qs[i] * Quaternion(vs[i].x, vs[i].y, vs[i].z, 0.0f) * qs[i].inverse();
+        expected[i] = Vector3(r.x, r.y, r.z);
+        ok = ok && nearlyEqual(qs[i].rotateVector(vs[i]), expected[i], 1e-4f);
+        ok = ok && nearlyEqual(qs[i].normalized().rotateVectorUnit(vs[i]), expected[i], 1e-4f);
+    }
+    check(ok, "rotateVector matches q v q^-1");
+    qs[3] = Quaternion(0.0f, 0.0f, 0.0f, 0.0f);
+    expected[3] = vs[3];
+
+    rotateVectors(qs.data(), vs.data(), out.data(), n);
+    ok = true;
+    for (std::size_t i = 0; i < n; ++i) ok = ok && nearlyEqual(out[i], expected[i], 1e-4f);
+    check(ok, "rotateVectors(qs) matches per-element rotateVector");
+
+    rotateVectors(qs[1], vs.data(), out.data(), n);
+    ok = true;
+    for (std::size_t i = 0; i < n; ++i) ok = ok && nearlyEqual(out[i], qs[1].rotateVector(vs[i]), 1e-4f);
+    check(ok, "rotateVectors(q) matches per-element rotateVector");
+    std::cout << "Quaternion rotation checked over " << n << " vectors\n";
+}
+
+// Angle in degrees between the rotations two quaternions represent, measured in double via
+// atan2 so that tiny angles are not lost to acos near 1.
+double rotationAngleDegrees(const Quaternion& a, const Quaternion& b) {
+    Quaterniond r = Quaterniond(a).normalized().conjugate() * Quaterniond(b).normalized();
+    return 2.0 * std::atan2(std::sqrt(r.x * r.x + r.y * r.y + r.z * r.z), std::fabs(r.w)) * 180.0 / PI_T<double>;
+}
+
+void testQuaternionBlend() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const std::size_t n = 4099;
+    std::vector<Quaternion> a(n), b(n), out(n);
+    std::vector<float> t(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        a[i] = Quaternion(value(rng), value(rng), value(rng), value(rng)).normalized();
+        b[i] = Quaternion(value(rng), value(rng), value(rng), value(rng)).normalized();
+        t[i] = unit(rng);
+    }
+    QuaternionStream sa(a), sb(b), sout(n);
+
+    blend::slerp(sa.view(), sb.view(), t.data(), sout.view());
+    bool exact = true;
+    for (std::size_t i = 0; i < n; ++i) exact = exact && sout[i] == Quaternion::slerp(a[i], b[i], t[i]);
+    check(exact, "blend::slerp matches Quaternion::slerp");
+
+    double maxError = 0.0;
+    blend::nlerp(sa.view(), sb.view(), t.data(), sout.view());
+    blend::nlerp(makeView(a.data(), n), makeView(b.data(), n), t.data(), makeView(out.data(), n));
+    bool layouts = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        maxError = std::max(maxError, rotationAngleDegrees(sout[i], Quaternion::slerp(a[i], b[i], t[i])));
+        layouts = layouts && sout[i] == out[i];
+    }
+    check(maxError < 0.05, "blend::nlerp stays within 0.05 degrees of slerp");
+    check(layouts, "blend::nlerp gives the same result for SoA and AoS views");
+
+    QuaternionView inputs[3] = {sa.view(), sb.view(), sa.view()};
+    float weights[3] = {0.25f, 0.5f, 0.25f};
+    blend::weightedAverage(inputs, weights, 3, sout.view());
+    bool average = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        // Equal halves of a and b are the slerp midpoint.
+        average = average && rotationAngleDegrees(sout[i], Quaternion::slerp(a[i], b[i], 0.5f)) < 1e-2f;
+    }
+    check(average, "blend::weightedAverage of two halves is the slerp midpoint");
+    float zero[3] = {0.0f, 0.0f, 0.0f};
+    blend::weightedAverage(inputs, zero, 3, sout.view());
+    check(sout[0] == Quaternion::identity && sout[n - 1] == Quaternion::identity, "blend::weightedAverage: zero weights give identity");
+
+    // Rough speed comparison; the benchmark suite has the careful numbers.
+    auto time = [&](auto&& fn) {
+        auto start = std::chrono::steady_clock::now();
+        for (int rep = 0; rep < 20; ++rep) fn();
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (20.0 * n);
+    };
+    double slerpNs = time([&] { blend::slerp(sa.view(), sb.view(), t.data(), sout.view()); });
+    double nlerpNs = time([&] { blend::nlerp(sa.view(), sb.view(), t.data(), sout.view()); });
+    std::cout << "Quaternion blend checked: nlerp max error " << maxError << " deg, slerp " << slerpNs
+              << " ns/op, nlerp " << nlerpNs << " ns/op\n";
+}
+
+void testAffine3() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+    bool roundTrip = true, compose = true, inverse = true, rigid = true, points = true, normals = true;
+    for (int i = 0; i < 1000; ++i) {
+        Matrix4 a = randomTransform(rng);
+        Matrix4 b = randomTransform(rng);
+        Affine3 fa(a), fb(b);
+        Vector3 p(value(rng), value(rng), value(rng));
+        Vector3 n = Vector3(value(rng), value(rng), value(rng)).normalized();
+        if (n.isZero()) n = Vector3::unitZ;
+
+        roundTrip = roundTrip && nearlyEqual(fa.toMatrix4(), a, 0.0f);
+        compose = compose && nearlyEqual((fa * fb).toMatrix4(), a * b, 1e-5f);
+        inverse = inverse && nearlyEqual(fa.inverse().toMatrix4(), Matrix4::inverseScalar(a), 1e-4f);
+        points = points && nearlyEqual(fa.transformPoint(p), a.transformPoint(p), 1e-4f) &&
+                 nearlyEqual(fa.transformDirection(p), a.transformDirection(p), 1e-4f);
+        // A transformed normal stays perpendicular to transformed tangents.
+        Vector3 tangent = n.cross(Vector3(value(rng), value(rng), value(rng)));
+        Vector3 tn = fa.transformNormal(n);
+        normals = normals && std::fabs(tn.dot(fa.transformDirection(tangent).normalized())) < 1e-3f &&
+                  std::fabs(tn.length() - 1.0f) < 1e-4f;
+
+        Vector3 eye(value(rng), value(rng), value(rng));
+        Vector3 target(value(rng), value(rng), value(rng));
+        if ((eye - target).isZero()) continue;
+        Affine3 view = Affine3::lookAt(eye, target, Vector3::unitY);
+        Affine3 spin = Affine3::rotation(Quaternion::fromAxisAngle(Vector3::unitX, angle(rng)));
+        rigid = rigid && nearlyEqual(view.inverseRigid().getTranslation(), eye, 1e-3f) &&
+                nearlyEqual(spin.inverseRigid().toMatrix4(), spin.inverse().toMatrix4(), 1e-5f);
+    }
+    check(roundTrip, "Affine3 <-> Matrix4 round trip");
+    check(compose, "Affine3 compose matches Matrix4 multiply");
+    check(inverse, "Affine3::inverse matches Matrix4 inverse");
+    check(rigid, "Affine3::inverseRigid recovers the eye and matches inverse");
+    check(points, "Affine3 point/direction transforms match Matrix4");
+    check(normals, "Affine3::transformNormal stays perpendicular to surfaces");
+
+    Affine3 mirror = Affine3::scaling(Vector3(-1.0f, 2.0f, 1.0f));
+    check(nearlyEqual(mirror.transformNormal(Vector3::unitX), Vector3(-1.0f, 0.0f, 0.0f), 1e-6f),
+          "Affine3::transformNormal follows mirrored geometry");
+    std::cout << "Affine3 checked against Matrix4\n";
+}
+
+void testErrorPolicy() {
+    resetErrorCounts();
+    Matrix4 singular = Matrix4::scaling(Vector3(1.0f, 0.0f, 1.0f));
+    Vector3 origin = Vector3::zero;
+
+    check(!singular.tryInverse(), "tryInverse rejects a singular matrix");
+    check(!Affine3(singular).tryInverse(), "Affine3::tryInverse rejects a singular transform");
+    check(!Matrix4::tryLookAt(origin, origin, Vector3::unitY), "tryLookAt rejects eye == target");
+    check(!Matrix4::tryLookAt(origin, Vector3::unitZ, Vector3::zero), "tryLookAt rejects a zero up vector");
+    check(!Matrix4::tryLookAt(origin, Vector3::unitY, Vector3::unitY), "tryLookAt rejects a parallel up vector");
+    check(!Matrix4::tryPerspective(60.0f, 0.0f, 0.1f, 100.0f), "tryPerspective rejects a zero aspect");
+    check(!Matrix4::tryFrustum(-1.0f, -1.0f, -1.0f, 1.0f, 0.1f, 100.0f), "tryFrustum rejects a zero width");
+    check(!Matrix4::tryViewport(0.0f, 0.0f, 0.0f, 600.0f, 0.0f, 1.0f), "tryViewport rejects a zero width");
+    check(!Matrix4::tryRotationAxis(Vector3::zero, 45.0f), "tryRotationAxis rejects a zero axis");
+    check(!singular.tryDecompose(), "tryDecompose rejects a zero scale");
+    check(totalErrorCount() == 0, "try* variants do not report");
+
+    Matrix4 good = Matrix4::translation(Vector3(1.0f, 2.0f, 3.0f)) * Matrix4::rotationAxis(Vector3::unitY, 30.0f);
+    std::optional<Matrix4> inv = good.tryInverse();
+    check(inv && nearlyEqual(*inv, good.inverse(), 0.0f), "tryInverse matches inverse on valid input");
+    std::optional<Matrix4> view = Matrix4::tryLookAt(Vector3(1.0f, 2.0f, 3.0f), origin, Vector3::unitY);
+    check(view && nearlyEqual(*view, Matrix4::lookAt(Vector3(1.0f, 2.0f, 3.0f), origin, Vector3::unitY), 0.0f),
+          "tryLookAt matches lookAt on valid input");
+
+    check(nearlyEqual(singular.inverse(), Matrix4::getIdentity(), 0.0f), "inverse falls back to identity");
+    check(nearlyEqual(Matrix4::lookAt(origin, origin, Vector3::unitY), Matrix4::getIdentity(), 0.0f),
+          "lookAt falls back to identity");
+    auto [t, r, sc] = singular.decompose();
+    check(r == Quaternion::identity && sc == Vector3(1.0f, 1.0f, 1.0f), "decompose falls back to defaults");
+#if TIMATH_ERROR_POLICY >= TIMATH_ERROR_POLICY_COUNTED
+    check(errorCount(MathStatus::SingularMatrix) == 1, "singular inverse is counted");
+    check(errorCount(MathStatus::ZeroLookDirection) == 1, "degenerate lookAt is counted");
+    check(errorCount(MathStatus::DegenerateScale) == 1, "degenerate decompose is counted");
+    check(totalErrorCount() == 3, "only failures are counted");
+#else
+    check(totalErrorCount() == 0, "silent policy does not count");
+#endif
+    resetErrorCounts();
+    check(totalErrorCount() == 0, "resetErrorCounts clears the counters");
+    std::cout << "Error policy checked (TIMATH_ERROR_POLICY=" << TIMATH_ERROR_POLICY << ")\n";
+}
+
+// Compile-time evaluated sin/cos samples every 7.5 degrees over [-720, 720].
+constexpr int TRIG_SAMPLES = 193;
+constexpr float trigAngle(int i) { return -720.0f + 7.5f * static_cast<float>(i); }
+constexpr std::array<std::array<float, 2>, TRIG_SAMPLES> makeTrigTable() {
+    std::array<std::array<float, 2>, TRIG_SAMPLES> table{};
+    for (int i = 0; i < TRIG_SAMPLES; ++i) {
+        table[i] = {cx::sinDegrees(trigAngle(i)), cx::cosDegrees(trigAngle(i))};
+    }
+    return table;
+}
+constexpr auto TRIG_TABLE = makeTrigTable();
+
+constexpr Matrix4 CONST_TRS = Matrix4::translation(Vector3(1.0f, 2.0f, 3.0f)) *
+                              Matrix4::rotationZ(90.0f) *
+                              Matrix4::scaling(Vector3(2.0f, 2.0f, 2.0f));
+static_assert(CONST_TRS.transformPoint(Vector3(1.0f, 0.0f, 0.0f)).x == 1.0f &&
+              CONST_TRS.transformPoint(Vector3(1.0f, 0.0f, 0.0f)).y == 4.0f,
+              "constexpr translation * rotation * scaling");
+static_assert(cx::cosDegrees(90.0f) == 0.0f && cx::sinDegrees(-270.0f) == 1.0f, "quarter turns are exact");
+static_assert(Matrix4::viewport(0.0f, 0.0f, 800.0f, 600.0f, 0.0f, 1.0f).m[12] == 400.0f, "constexpr viewport");
+static_assert(!Matrix4::tryViewport(0.0f, 0.0f, 0.0f, 600.0f, 0.0f, 1.0f), "constexpr tryViewport rejects");
+static_assert(Matrix4::orthographic(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f).m[10] == -1.0f, "constexpr orthographic");
+static_assert(Affine3(Matrix4::translation(Vector3(0.0f, 5.0f, 0.0f))).getTranslation().y == 5.0f, "constexpr Affine3");
+
+void testConstexprFactories() {
+    bool trig = true;
+    for (int i = 0; i < TRIG_SAMPLES; ++i) {
+        float radians = trigAngle(i) * PI / 180.0f;
+        trig = trig && std::fabs(TRIG_TABLE[i][0] - std::sin(radians)) < 1e-6f &&
+               std::fabs(TRIG_TABLE[i][1] - std::cos(radians)) < 1e-6f;
+    }
+    check(trig, "cx::sinDegrees/cosDegrees match <cmath> at compile time");
+
+    // Same code at runtime, so an unfolded factory builds the same matrix as a folded one.
+    bool same = true;
+    for (volatile int i = 0; i < TRIG_SAMPLES; ++i) {
+        same = same && cx::sinDegrees(trigAngle(i)) == TRIG_TABLE[i][0] &&
+               cx::cosDegrees(trigAngle(i)) == TRIG_TABLE[i][1];
+    }
+    check(same, "cx::sinDegrees/cosDegrees give the compile-time values at runtime");
+
+    std::mt19937 rng(77);
+    std::uniform_real_distribution<float> angle(-360.0f, 360.0f);
+    bool axes = true;
+    for (int i = 0; i < 100; ++i) {
+        float a = angle(rng);
+        axes = axes && nearlyEqual(Matrix4::rotationX(a), Matrix4::rotationAxis(Vector3::unitX, a), 1e-6f) &&
+               nearlyEqual(Matrix4::rotationY(a), Matrix4::rotationAxis(Vector3::unitY, a), 1e-6f) &&
+               nearlyEqual(Matrix4::rotationZ(a), Matrix4::rotationAxis(Vector3::unitZ, a), 1e-6f);
+    }
+    check(axes, "rotationX/Y/Z match rotationAxis");
+
+    // The camera's fixed view modes rely on these being the rotation part of lookAt.
+    constexpr Matrix4 top = Matrix4::rotationX(90.0f);
+    constexpr Matrix4 bottom = Matrix4::rotationX(-90.0f);
+    constexpr Matrix4 left = Matrix4::rotationY(90.0f);
+    constexpr Matrix4 right = Matrix4::rotationY(-90.0f);
+    auto view = [](const Matrix4& rotation, const Vector3& eye) { return rotation * Matrix4::translation(-eye); };
+    Vector3 o(0.5f, -1.0f, 2.0f);
+    float d = 7.0f;
+    check(nearlyEqual(view(top, o + Vector3::unitY * d), Matrix4::lookAt(o + Vector3::unitY * d, o, -Vector3::unitZ), 1e-6f),
+          "top view rotation");
+    check(nearlyEqual(view(bottom, o - Vector3::unitY * d), Matrix4::lookAt(o - Vector3::unitY * d, o, Vector3::unitZ), 1e-6f),
+          "bottom view rotation");
+    check(nearlyEqual(view(left, o - Vector3::unitX * d), Matrix4::lookAt(o - Vector3::unitX * d, o, Vector3::unitY), 1e-6f),
+          "left view rotation");
+    check(nearlyEqual(view(right, o + Vector3::unitX * d), Matrix4::lookAt(o + Vector3::unitX * d, o, Vector3::unitY), 1e-6f),
+          "right view rotation");
+    std::cout << "constexpr factories checked\n";
+}
+
+void testDoublePrecision() {
+    std::mt19937 rng(2024);
+    std::uniform_real_distribution<double> value(-100.0, 100.0);
+    bool kernels = true, roundTrip = true;
+    for (int i = 0; i < 200; ++i) {
+        // Build in double from the float test transforms, as RBF binding would.
+        Matrix4d a(randomTransform(rng));
+        Matrix4d b(randomGeneral(rng));
+        Vector4d v(value(rng), value(rng), value(rng), 1.0);
+
+        Matrix4d ab = Matrix4d::multiplyScalar(a, b);
+        Matrix4d identity = Matrix4d::multiplyScalar(a, a.inverse());
+        Vector4d av = Matrix4d::transformScalar(a, v);
+        for (int k = 0; k < 16; ++k) {
+            double expected = (k % 5 == 0) ? 1.0 : 0.0;
+            roundTrip = roundTrip && std::fabs(identity.m[k] - expected) < 1e-10;
+            kernels = kernels && std::fabs((a * b).m[k] - ab.m[k]) <= 1e-12 * std::max(1.0, std::fabs(ab.m[k]));
+        }
+        Vector4d simd = a * v;
+        kernels = kernels && std::fabs(simd.x - av.x) < 1e-9 && std::fabs(simd.y - av.y) < 1e-9 &&
+                  std::fabs(simd.z - av.z) < 1e-9 && std::fabs(simd.w - av.w) < 1e-9;
+
+        // Narrowing the bound result hands the renderer a float matrix without reassembly.
+        roundTrip = roundTrip && nearlyEqual(Matrix4(a * b), Matrix4::multiplyScalar(Matrix4(a), Matrix4(b)), 1e-5f);
+    }
+    check(kernels, "Matrix4d: dispatched kernels match scalar reference");
+    check(roundTrip, "Matrix4d: inverse to 1e-10 and narrows to Matrix4");
+
+    Quaterniond q = Quaterniond::fromAxisAngle(Vector3d(1.0, 2.0, 3.0), 37.0);
+    Vector3d p(0.25, -4.0, 9.5);
+    check((q.toMatrix4().transformPoint(p) - q.rotateVector(p)).length() < 1e-12, "Quaterniond matches its matrix");
+    std::cout << "double instantiations checked\n";
+}
+
+} // namespace
 
 int main() {
-    
+    testMatrixKernels();
+    testBatchTransforms();
+    testVector3Stream();
+    testQuaternionRotation();
+    testQuaternionBlend();
+    testAffine3();
+    testErrorPolicy();
+    testConstexprFactories();
+    testDoublePrecision();
+
+    if (failures) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All TiMath checks passed\n";
     return 0;
-}
\ No newline at end of file
+}
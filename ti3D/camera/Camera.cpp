@@ -7,6 +7,27 @@
 
 namespace Ti3D
 {
+namespace
+{
+// Rotation part of lookAt for each fixed ViewMode (eye offset and up vector as below),
+// folded at compile time. Only the translation depends on target and distance.
+constexpr TiMath::Affine3 TOP_VIEW(TiMath::Matrix4::rotationX(90.0f));
+constexpr TiMath::Affine3 BOTTOM_VIEW(TiMath::Matrix4::rotationX(-90.0f));
+constexpr TiMath::Affine3 LEFT_VIEW(TiMath::Matrix4::rotationY(90.0f));
+constexpr TiMath::Affine3 RIGHT_VIEW(TiMath::Matrix4::rotationY(-90.0f));
+
+// Places a fixed view rotation at the given eye: translation = -R * eye.
+TiMath::Affine3 fixedView(const TiMath::Affine3& rotation, const TiMath::Vector3& eye)
+{
+    TiMath::Affine3 view = rotation;
+    TiMath::Vector3 t = rotation.transformDirection(eye);
+    view.m[9] = -t.x;
+    view.m[10] = -t.y;
+    view.m[11] = -t.z;
+    return view;
+}
+} // namespace
+
 Camera::Camera()
     : target(0.0f, 0.0f, 0.0f),
       distance(10.0f),
@@ -38,37 +59,33 @@ void Camera::processMouseInput(GLFWwindow* window, double xpos, double ypos,
 
 TiMath::Matrix4 Camera::getViewMatrix() const
 {
-    TiMath::Vector3 position;
-    TiMath::Vector3 up(0.0f, 1.0f, 0.0f);
+    return getViewTransform().toMatrix4();
+}
+
+TiMath::Affine3 Camera::getViewTransform() const
+{
     switch (viewMode)
     {
-        case ViewMode::Top:
-            position = target + TiMath::Vector3(0.0f, distance, 0.0f);
-            up = TiMath::Vector3(0.0f, 0.0f, -1.0f);
-            break;
-        case ViewMode::Left:
-            position = target + TiMath::Vector3(-distance, 0.0f, 0.0f);
-            break;
-        case ViewMode::Right:
-            position = target + TiMath::Vector3(distance, 0.0f, 0.0f);
-            break;
-        case ViewMode::Bottom:
-            position = target + TiMath::Vector3(0.0f, -distance, 0.0f);
-            up = TiMath::Vector3(0.0f, 0.0f, 1.0f);
-            break;
+        case ViewMode::Top: // up = -Z
+            return fixedView(TOP_VIEW, target + TiMath::Vector3(0.0f, distance, 0.0f));
+        case ViewMode::Left: // up = +Y
+            return fixedView(LEFT_VIEW, target + TiMath::Vector3(-distance, 0.0f, 0.0f));
+        case ViewMode::Right: // up = +Y
+            return fixedView(RIGHT_VIEW, target + TiMath::Vector3(distance, 0.0f, 0.0f));
+        case ViewMode::Bottom: // up = +Z
+            return fixedView(BOTTOM_VIEW, target + TiMath::Vector3(0.0f, -distance, 0.0f));
         case ViewMode::Far:
-            position =
-                target +
-                TiMath::Vector3(
-                    distance * std::cos(pitchDegrees * TiMath::PI / 180.0f) *
-                        std::sin(yawDegrees * TiMath::PI / 180.0f),
-                    distance * std::sin(pitchDegrees * TiMath::PI / 180.0f),
-                    distance * std::cos(pitchDegrees * TiMath::PI / 180.0f) *
-                        std::cos(yawDegrees * TiMath::PI / 180.0f));
-            up = TiMath::Vector3(0.0f, 1.0f, 0.0f);
             break;
     }
-    return TiMath::Matrix4::lookAt(position, target, up);
+    TiMath::Vector3 position =
+        target +
+        TiMath::Vector3(
+            distance * std::cos(pitchDegrees * TiMath::PI / 180.0f) *
+                std::sin(yawDegrees * TiMath::PI / 180.0f),
+            distance * std::sin(pitchDegrees * TiMath::PI / 180.0f),
+            distance * std::cos(pitchDegrees * TiMath::PI / 180.0f) *
+                std::cos(yawDegrees * TiMath::PI / 180.0f));
+    return TiMath::Affine3::lookAt(position, target, TiMath::Vector3(0.0f, 1.0f, 0.0f));
 }
 
 TiMath::Matrix4 Camera::getProjectionMatrix() const
@@ -161,7 +178,7 @@ void Camera::updateArcball(const TiMath::Vector3& point, double mouseX,
 
     // Rotate camera position around the point
     TiMath::Vector3 camOffset = arcballStartCamPos - point;
-    TiMath::Vector3 newOffset = q.rotateVector(camOffset);
+    TiMath::Vector3 newOffset = q.rotateVectorUnit(camOffset); // fromAxisAngle is unit length
     TiMath::Vector3 newCamPos = point + newOffset;
 
     // Update camera position and target
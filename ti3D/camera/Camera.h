@@ -3,6 +3,7 @@
 
 #include "../TiMath/Vector3.h"
 #include "../TiMath/Matrix4.h"
+#include "../TiMath/Affine3.h"
 #include "../TiMath/Quaternion.h" // Add this include for Quaternion
 #include <GLFW/glfw3.h>
 
@@ -57,6 +58,12 @@ public:
      */
     [[nodiscard]] TiMath::Matrix4 getViewMatrix() const;
 
+    /**
+     * @brief Returns the view transform as a 3x4 affine (a view has no projective row).
+     * @return The rigid world-to-camera transform.
+     */
+    [[nodiscard]] TiMath::Affine3 getViewTransform() const;
+
     /**
      * @brief Returns the projection matrix (orthographic or perspective).
      * @return A 4x4 projection matrix.
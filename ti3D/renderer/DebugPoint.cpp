@@ -107,15 +107,14 @@ void DebugPoint::initialize() {
     glDeleteShader(fragmentShader);
 }
 
-void DebugPoint::render(const TiMath::Matrix4& viewMatrix, const TiMath::Matrix4& projectionMatrix) const {
+void DebugPoint::render(const TiMath::Affine3& view, const TiMath::Matrix4& projectionMatrix) const {
     if (!visible) return;
 
     glUseProgram(shaderProgram);
 
     // Compute model matrix to orient the circle toward the camera
-    TiMath::Vector3 cameraPos;
-    TiMath::Matrix4 viewInv = viewMatrix.inverse();
-    cameraPos = TiMath::Vector3(viewInv.m[12], viewInv.m[13], viewInv.m[14]);
+    // The view is rigid, so its inverse is just the transposed rotation
+    TiMath::Vector3 cameraPos = view.inverseRigid().getTranslation();
 
     TiMath::Vector3 dir = (cameraPos - position).normalized();
     if (dir.isZero()) dir = TiMath::Vector3(0.0f, 0.0f, 1.0f); // Fallback
@@ -125,19 +124,18 @@ void DebugPoint::render(const TiMath::Matrix4& viewMatrix, const TiMath::Matrix4
     up = right.cross(dir).normalized();
 
     // Create model matrix
-    TiMath::Matrix4 model;
-    model.m[0] = right.x * size; model.m[4] = right.y * size; model.m[8] = right.z * size;
-    model.m[1] = up.x * size;    model.m[5] = up.y * size;    model.m[9] = up.z * size;
-    model.m[2] = -dir.x * size;  model.m[6] = -dir.y * size;  model.m[10] = -dir.z * size;
-    model.m[12] = position.x;    model.m[13] = position.y;    model.m[14] = position.z;
-    model.m[15] = 1.0f;
+    TiMath::Affine3 model;
+    model.m[0] = right.x * size; model.m[3] = right.y * size; model.m[6] = right.z * size;
+    model.m[1] = up.x * size;    model.m[4] = up.y * size;    model.m[7] = up.z * size;
+    model.m[2] = -dir.x * size;  model.m[5] = -dir.y * size;  model.m[8] = -dir.z * size;
+    model.m[9] = position.x;     model.m[10] = position.y;    model.m[11] = position.z;
 
     // Set uniforms
     GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
     GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
     GLint projLoc = glGetUniformLocation(shaderProgram, "projection");
-    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, model.data());
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, viewMatrix.data());
+    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, model.toMatrix4().data());
+    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, view.toMatrix4().data());
     glUniformMatrix4fv(projLoc, 1, GL_FALSE, projectionMatrix.data());
 
     glBindVertexArray(vao);
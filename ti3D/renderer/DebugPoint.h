@@ -3,6 +3,7 @@
 
 #include "../TiMath/Vector3.h"
 #include "../TiMath/Matrix4.h"
+#include "../TiMath/Affine3.h"
 #include <GLFW/glfw3.h>
 
 namespace Ti3D {
@@ -20,7 +21,7 @@ public:
     void initialize();
 
     // Render the point as a circle facing the camera
-    void render(const TiMath::Matrix4& viewMatrix, const TiMath::Matrix4& projectionMatrix) const;
+    void render(const TiMath::Affine3& view, const TiMath::Matrix4& projectionMatrix) const;
 
     // Set position
     void setPosition(const TiMath::Vector3& pos) { position = pos; }
@@ -264,7 +264,7 @@ void Renderer::drawGrid(const Camera& camera, const StateManager& stateManager)
 }
 
 void Renderer::drawTargetCamAim(const Camera& camera) const {
-    targetCamAim.render(camera.getViewMatrix(), camera.getProjectionMatrix());
+    targetCamAim.render(camera.getViewTransform(), camera.getProjectionMatrix());
 }
 
 void Renderer::setRenderFlags(bool axes, bool grid) {